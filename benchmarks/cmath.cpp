@@ -0,0 +1,144 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using albert::Tensor;
+using albert::cmath_policy;
+using albert::benchmarks::clobber;
+using albert::benchmarks::do_not_optimize;
+using albert::benchmarks::run;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+constexpr static long n = 1'000'000;
+constexpr static int samples = 2'000;
+
+using Stiffnessf = Tensor<float, 4, 3>;
+using Stiffnessd = Tensor<double, 4, 3>;
+
+/// Each kernel is a separate out-of-line function so that we measure the
+/// per-call cost of a single assignment.
+/// @{
+template <cmath_policy P, class Tensor>
+[[gnu::noinline]] static void exp(Tensor& C, Tensor const& A, Tensor const&)
+{
+  C(i,j,k,l) = albert::exp<P>(A(i,j,k,l));
+}
+
+template <cmath_policy P, class Tensor>
+[[gnu::noinline]] static void log(Tensor& C, Tensor const& A, Tensor const&)
+{
+  C(i,j,k,l) = albert::log<P>(A(i,j,k,l));
+}
+
+template <cmath_policy P, class Tensor>
+[[gnu::noinline]] static void pow(Tensor& C, Tensor const& A, Tensor const& B)
+{
+  C(i,j,k,l) = albert::pow<P>(A(i,j,k,l), B(i,j,k,l));
+}
+
+template <cmath_policy P, class Tensor>
+[[gnu::noinline]] static void sqrt(Tensor& C, Tensor const& A, Tensor const&)
+{
+  C(i,j,k,l) = albert::sqrt<P>(A(i,j,k,l));
+}
+/// @}
+
+/// The distance from `x` to the correctly rounded `y`, in units of the last
+/// place of `y`.
+template <class T>
+static auto ulp(T x, long double y) -> double
+{
+  T r = T(y);
+  T u = std::nextafter(std::abs(r), std::numeric_limits<T>::infinity()) - std::abs(r);
+  return double(std::abs(x - y) / u);
+}
+
+/// Time a kernel and measure its largest error over `samples` random tensors.
+///
+/// The arguments of `exp` span its whole finite range, those of `log` span
+/// the positive normal numbers, and `pow` raises numbers in [1/1000, 1000] to
+/// powers in [-20, 20].
+template <class Tensor, cmath_policy P>
+static void tier(char const* type, char const* tier, auto&& kernel, auto&& reference, auto&& a, auto&& b)
+{
+  using T = albert::scalar_type_t<Tensor>;
+
+  std::mt19937 rng(samples);
+  Tensor A, B, C;
+  double error = 0;
+  for (int s = 0; s < samples; ++s) {
+    for (int e = 0; e < A.size(); ++e) {
+      A[e] = a(rng);
+      B[e] = b(rng);
+    }
+    kernel(C, A, B);
+    for (int e = 0; e < A.size(); ++e) {
+      error = std::max(error, ulp<T>(C[e], reference((long double)A[e], (long double)B[e])));
+    }
+  }
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s %-5s %s", type, tier, kernel.name);
+  run(name, n, [&] {
+    clobber(A); clobber(B);
+    kernel(C, A, B);
+    do_not_optimize(C);
+  });
+  std::printf("%-40s %10.3g ulp\n", "", error);
+}
+
+/// A kernel instantiated for a policy, with its name.
+template <auto f>
+struct kernel
+{
+  char const* name;
+
+  void operator()(auto& C, auto const& A, auto const& B) const
+  {
+    f(C, A, B);
+  }
+};
+
+template <class Tensor, cmath_policy P>
+static void functions(char const* type, char const* name)
+{
+  using T = albert::scalar_type_t<Tensor>;
+  using C = std::numeric_limits<T>;
+
+  // Sample the exponents (and so the binades) uniformly.
+  T range = T(std::log(C::max()) * (1 - C::epsilon()));
+  std::uniform_real_distribution<T> exponent(-range, range);
+  std::uniform_real_distribution<T> base(T(std::log(1e-3)), T(std::log(1e3)));
+  std::uniform_real_distribution<T> power(-20, 20);
+  std::uniform_real_distribution<T> uniform(0, 1000);
+
+  auto x = [&](auto& rng) { return exponent(rng); };
+  auto positive = [&](auto& rng) { return std::max(std::exp(exponent(rng)), C::min()); };
+  auto a = [&](auto& rng) { return std::exp(base(rng)); };
+  auto p = [&](auto& rng) { return power(rng); };
+  auto u = [&](auto& rng) { return uniform(rng); };
+
+  tier<Tensor, P>(type, name, kernel<exp<P, Tensor>>{"exp"}, [](auto a, auto) { return std::exp(a); }, x, u);
+  tier<Tensor, P>(type, name, kernel<log<P, Tensor>>{"log"}, [](auto a, auto) { return std::log(a); }, positive, u);
+  tier<Tensor, P>(type, name, kernel<pow<P, Tensor>>{"pow"}, [](auto a, auto b) { return std::pow(a, b); }, a, p);
+  tier<Tensor, P>(type, name, kernel<sqrt<P, Tensor>>{"sqrt"}, [](auto a, auto) { return std::sqrt(a); }, u, u);
+}
+
+int main()
+{
+  std::printf("cmath policies, order 4 tensors (simd bytes %d)\n", albert::simd_bytes);
+
+  functions<Stiffnessf, cmath_policy::exact>("float ", "exact");
+  functions<Stiffnessf, cmath_policy::ulp4>("float ", "ulp4");
+  functions<Stiffnessf, cmath_policy::fast>("float ", "fast");
+  functions<Stiffnessd, cmath_policy::exact>("double", "exact");
+  functions<Stiffnessd, cmath_policy::ulp4>("double", "ulp4");
+  functions<Stiffnessd, cmath_policy::fast>("double", "fast");
+}
@@ -0,0 +1,44 @@
+#ifndef ALBERT_BENCHMARKS_COMMON_HPP
+#define ALBERT_BENCHMARKS_COMMON_HPP
+
+#include <chrono>
+#include <cstdio>
+
+namespace albert::benchmarks
+{
+  /// Prevent the optimizer from discarding the computation that produced `x`.
+  template <class T>
+  inline void do_not_optimize(T const& x)
+  {
+    asm volatile("" : : "g"(&x) : "memory");
+  }
+
+  /// Prevent the optimizer from assuming anything about the contents of `x`.
+  template <class T>
+  inline void clobber(T& x)
+  {
+    asm volatile("" : : "g"(&x) : "memory");
+  }
+
+  /// Run `f` `n` times and report the average time per call.
+  inline auto run(char const* name, long n, auto&& f) -> double
+  {
+    using clock = std::chrono::steady_clock;
+
+    for (long i = 0; i < n / 10; ++i) {       // warm up
+      f();
+    }
+
+    auto start = clock::now();
+    for (long i = 0; i < n; ++i) {
+      f();
+    }
+    std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+
+    double ns = elapsed.count() / n;
+    std::printf("%-40s %10.2f ns/call\n", name, ns);
+    return ns;
+  }
+}
+
+#endif // ALBERT_BENCHMARKS_COMMON_HPP
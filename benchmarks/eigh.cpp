@@ -0,0 +1,190 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using albert::Tensor;
+using albert::TensorBatch;
+using albert::benchmarks::clobber;
+using albert::benchmarks::do_not_optimize;
+using albert::benchmarks::run;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+
+constexpr static long n = 2'000;
+constexpr static int matrices = 1024;
+constexpr static int L = albert::simd_width_v<double>;
+
+using Matrix = Tensor<double, 2, 3>;
+using Vector = Tensor<double, 1, 3>;
+using MatrixBatch = TensorBatch<double, 2, 3>;
+using VectorBatch = TensorBatch<double, 1, 3>;
+
+/// The largest residual `|A v - w v|` and orthogonality error `|V^T V - I|`,
+/// relative to the largest eigenvalue.
+struct error
+{
+  double residual = 0;
+  double orthogonality = 0;
+};
+
+static auto accuracy(std::vector<Matrix> const& A, std::vector<Vector> const& w, std::vector<Matrix> const& V) -> error
+{
+  error e;
+  for (int m = 0; m < matrices; ++m) {
+    double scale = std::max({ 1.0, std::abs(w[m](0)), std::abs(w[m](2)) });
+    for (int a = 0; a < 3; ++a) {
+      for (int r = 0; r < 3; ++r) {
+        double x = -w[m](a) * V[m](r,a);
+        for (int c = 0; c < 3; ++c) {
+          x += A[m](r,c) * V[m](c,a);
+        }
+        e.residual = std::max(e.residual, std::abs(x) / scale);
+      }
+      for (int b = 0; b < 3; ++b) {
+        double d = -double(a == b);
+        for (int r = 0; r < 3; ++r) {
+          d += V[m](r,a) * V[m](r,b);
+        }
+        e.orthogonality = std::max(e.orthogonality, std::abs(d));
+      }
+    }
+  }
+  return e;
+}
+
+/// Each kernel decomposes a whole array of matrices, as in a loop over the
+/// material points of a mesh.
+/// @{
+[[gnu::noinline]] static void closed_form(std::vector<Vector>& w, std::vector<Matrix>& V, std::vector<Matrix> const& A)
+{
+  for (int m = 0; m < matrices; ++m) {
+    double a[3][3], e[3], v[3][3];
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        a[r][c] = A[m](r,c);
+      }
+    }
+    albert::solver::detail::eigh3(a, e, v);
+    for (int r = 0; r < 3; ++r) {
+      w[m](r) = e[r];
+      for (int c = 0; c < 3; ++c) {
+        V[m](r,c) = v[r][c];
+      }
+    }
+  }
+}
+
+[[gnu::noinline]] static void eigh(std::vector<Vector>& w, std::vector<Matrix>& V, std::vector<Matrix> const& A)
+{
+  for (int m = 0; m < matrices; ++m) {
+    albert::solver::eigh<3>(A[m], w[m], V[m]);
+  }
+}
+
+[[gnu::noinline]] static void jacobi(std::vector<Vector>& w, std::vector<Matrix>& V, std::vector<Matrix> const& A)
+{
+  for (int m = 0; m < matrices; ++m) {
+    albert::solver::jacobi_eigh<3>(A[m], w[m], V[m]);
+  }
+}
+
+[[gnu::noinline]] static void batched(std::vector<VectorBatch>& w, std::vector<MatrixBatch>& V, std::vector<MatrixBatch> const& A)
+{
+  for (int m = 0; m < matrices / L; ++m) {
+    albert::solver::batch_eigh<3>(A[m], w[m], V[m]);
+  }
+}
+/// @}
+
+/// Run each kernel on matrices with eigenvalues `{1, 1 + gap, 3}` in random
+/// orientations.
+static void spectrum(double gap)
+{
+  std::mt19937 rng(matrices);
+  std::normal_distribution<double> normal;
+
+  std::vector<Matrix> A(matrices), V(matrices);
+  std::vector<Vector> w(matrices);
+  for (int m = 0; m < matrices; ++m) {
+    // a random rotation from the Gram-Schmidt process
+    double q[3][3];
+    for (int c = 0; c < 3; ++c) {
+      for (int r = 0; r < 3; ++r) {
+        q[r][c] = normal(rng);
+      }
+      for (int p = 0; p < c; ++p) {
+        double d = 0;
+        for (int r = 0; r < 3; ++r) {
+          d += q[r][c] * q[r][p];
+        }
+        for (int r = 0; r < 3; ++r) {
+          q[r][c] -= d * q[r][p];
+        }
+      }
+      double norm = 0;
+      for (int r = 0; r < 3; ++r) {
+        norm += q[r][c] * q[r][c];
+      }
+      for (int r = 0; r < 3; ++r) {
+        q[r][c] /= std::sqrt(norm);
+      }
+    }
+
+    double lambda[3] = { 1, 1 + gap, 3 };
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        A[m](r,c) = 0;
+        for (int p = 0; p < 3; ++p) {
+          A[m](r,c) += q[r][p] * lambda[p] * q[c][p];
+        }
+      }
+    }
+  }
+
+  std::vector<MatrixBatch> AB(matrices / L), VB(matrices / L);
+  std::vector<VectorBatch> wB(matrices / L);
+  for (int m = 0; m < matrices; ++m) {
+    albert::set_lane(AB[m / L], m % L, A[m]);
+  }
+
+  std::printf("gap %g\n", gap);
+
+  // The batched results are copied out of their lanes after timing.
+  auto report = [&](char const* name, auto&& kernel, auto&&... gather) {
+    char label[64];
+    std::snprintf(label, sizeof(label), "  %s", name);
+    run(label, n, [&] {
+      clobber(A);
+      kernel();
+      do_not_optimize(w);
+      do_not_optimize(V);
+    });
+    (gather(), ...);
+    error e = accuracy(A, w, V);
+    std::printf("%-40s %10.1e residual %10.1e orthogonality\n", "", e.residual, e.orthogonality);
+  };
+
+  report("closed form", [&] { closed_form(w, V, A); });
+  report("eigh", [&] { eigh(w, V, A); });
+  report("jacobi", [&] { jacobi(w, V, A); });
+  report("batched", [&] { batched(wB, VB, AB); }, [&] {
+    for (int m = 0; m < matrices; ++m) {
+      w[m](i) = albert::get_lane(wB[m / L], m % L)(i);
+      V[m](i,j) = albert::get_lane(VB[m / L], m % L)(i,j);
+    }
+  });
+}
+
+int main()
+{
+  std::printf("eigh, %d symmetric 3x3 matrices per array\n", matrices);
+
+  spectrum(1);
+  spectrum(1e-3);
+  spectrum(1e-6);
+  spectrum(1e-9);
+}
@@ -0,0 +1,102 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+
+using albert::Tensor;
+using albert::scalar_type_t;
+using albert::benchmarks::clobber;
+using albert::benchmarks::do_not_optimize;
+using albert::benchmarks::run;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+constexpr static long n = 10'000'000;
+
+using Matrixf = Tensor<float, 2, 3>;
+using Matrixd = Tensor<double, 2, 3>;
+using Stiffnessf = Tensor<float, 4, 3>;
+using Stiffnessd = Tensor<double, 4, 3>;
+
+/// Each kernel is a separate out-of-line function so that we measure the
+/// per-call cost of a single assignment.
+/// @{
+template <class Tensor>
+[[gnu::noinline]] static void add2(Tensor& C, Tensor const& A, Tensor const& B)
+{
+  C(i,j) = A(i,j) + B(i,j);
+}
+
+template <class Tensor>
+[[gnu::noinline]] static void axpby2(Tensor& C, Tensor const& A, Tensor const& B)
+{
+  C(i,j) += (A(i,j) - B(i,j)) / 2 + -A(i,j) * scalar_type_t<Tensor>(3);
+}
+
+template <class Tensor>
+[[gnu::noinline]] static void add4(Tensor& C, Tensor const& A, Tensor const& B)
+{
+  C(i,j,k,l) = A(i,j,k,l) + B(i,j,k,l);
+}
+
+template <class Tensor>
+[[gnu::noinline]] static void axpby4(Tensor& C, Tensor const& A, Tensor const& B)
+{
+  C(i,j,k,l) += (A(i,j,k,l) - B(i,j,k,l)) / 2 + -A(i,j,k,l) * scalar_type_t<Tensor>(3);
+}
+/// @}
+
+template <class Tensor>
+static void order2(char const* type)
+{
+  Tensor A, B, C;
+  for (int n = 0; n < A.size(); ++n) A[n] = B[n] = C[n] = 1 + n;
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s order 2 C = A + B", type);
+  run(name, n, [&] {
+    clobber(A); clobber(B);
+    add2(C, A, B);
+    do_not_optimize(C);
+  });
+
+  std::snprintf(name, sizeof(name), "%s order 2 C += (A - B) / 2 - 3A", type);
+  run(name, n, [&] {
+    clobber(A); clobber(B);
+    axpby2(C, A, B);
+    do_not_optimize(C);
+  });
+}
+
+template <class Tensor>
+static void order4(char const* type)
+{
+  Tensor A, B, C;
+  for (int n = 0; n < A.size(); ++n) A[n] = B[n] = C[n] = 1 + n;
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s order 4 C = A + B", type);
+  run(name, n, [&] {
+    clobber(A); clobber(B);
+    add4(C, A, B);
+    do_not_optimize(C);
+  });
+
+  std::snprintf(name, sizeof(name), "%s order 4 C += (A - B) / 2 - 3A", type);
+  run(name, n, [&] {
+    clobber(A); clobber(B);
+    axpby4(C, A, B);
+    do_not_optimize(C);
+  });
+}
+
+int main()
+{
+  std::printf("elementwise (simd bytes %d)\n", albert::simd_bytes);
+
+  order2<Matrixf>("float ");
+  order2<Matrixd>("double");
+  order4<Stiffnessf>("float ");
+  order4<Stiffnessd>("double");
+}
@@ -0,0 +1,193 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+
+using albert::Tensor;
+using albert::benchmarks::clobber;
+using albert::benchmarks::do_not_optimize;
+using albert::benchmarks::run;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+constexpr static long n = 10'000'000;
+
+using Vector = Tensor<double, 1, 3>;
+using Matrix = Tensor<double, 2, 3>;
+using Stiffness = Tensor<double, 4, 3>;
+
+/// Each kernel is a separate out-of-line function so that we measure the
+/// per-call cost of a single assignment, or of a sequence of assignments.
+/// @{
+[[gnu::noinline]] static void add_transpose(Matrix& C, Matrix const& A, Matrix const& B)
+{
+  C(i,j) = A(i,j) + B(j,i);
+}
+
+[[gnu::noinline]] static void add_transpose_in_place(Matrix& A, Matrix const& B)
+{
+  A(i,j) = A(i,j) + B(j,i);
+}
+
+[[gnu::noinline]] static void matvec(Vector& b, Matrix const& A, Vector const& a)
+{
+  b(i) = A(i,j) * a(j);
+}
+
+[[gnu::noinline]] static void matmul(Matrix& C, Matrix const& A, Matrix const& B)
+{
+  C(i,j) = A(i,k) * B(k,j);
+}
+
+[[gnu::noinline]] static void matmul_in_place(Matrix& A, Matrix const& B)
+{
+  A(i,j) = A(i,k) * B(k,j);
+}
+
+[[gnu::noinline]] static void double_contraction(Matrix& C, Stiffness const& D, Matrix const& A)
+{
+  C(i,j) = D(i,j,k,l) * A(k,l);
+}
+
+[[gnu::noinline]] static void scale(Stiffness& E, Stiffness const& D)
+{
+  E(i,j,k,l) = D(i,j,k,l) * 2.0;
+}
+
+[[gnu::noinline]] static void outer(Stiffness& E, Matrix const& A, Matrix const& B)
+{
+  E(i,j,k,l) = A(i,j) * B(k,l);
+}
+
+[[gnu::noinline]] static void chain(Matrix& D, Matrix const& A, Matrix const& B, Matrix const& C)
+{
+  D(i,l) = A(i,j) * B(j,k) * C(k,l);
+}
+
+[[gnu::noinline]] static void lazy_chain(Matrix& D, Matrix const& A, Matrix const& B, Matrix const& C)
+{
+  D(i,l) = albert::lazy(A(i,j) * B(j,k)) * C(k,l);
+}
+
+[[gnu::noinline]] static void matmatvec(Vector& b, Matrix const& A, Matrix const& B, Vector const& a)
+{
+  b(i) = A(i,j) * B(j,k) * a(k);
+}
+
+[[gnu::noinline]] static void lazy_matmatvec(Vector& b, Matrix const& A, Matrix const& B, Vector const& a)
+{
+  b(i) = albert::lazy(A(i,j) * B(j,k)) * a(k);
+}
+
+[[gnu::noinline]] static void stress(Matrix& S, Matrix& T, Matrix& P, Matrix const& E, Matrix const& A)
+{
+  S(i,j) = E(i,j) * 2.0 + A(i,j);
+  T(i,j) = S(i,j) - E(i,j);
+  P(i,j) += T(i,j) * 0.5 + S(i,j);
+}
+
+[[gnu::noinline]] static void fused_stress(Matrix& S, Matrix& T, Matrix& P, Matrix const& E, Matrix const& A)
+{
+  albert::fuse(
+    albert::defer(S(i,j)) = E(i,j) * 2.0 + A(i,j),
+    albert::defer(T(i,j)) = S(i,j) - E(i,j),
+    albert::defer(P(i,j)) += T(i,j) * 0.5 + S(i,j));
+}
+/// @}
+
+int main()
+{
+  std::printf("evaluate (unroll threshold %d)\n", albert::unroll_threshold);
+
+  Matrix A, B, C, F, P;
+  Vector a, b;
+  Stiffness D, E;
+  for (int n = 0; n < A.size(); ++n) A[n] = B[n] = C[n] = F[n] = P[n] = 1.0 + n;
+  for (int n = 0; n < a.size(); ++n) a[n] = b[n] = 1.0 + n;
+  for (int n = 0; n < D.size(); ++n) D[n] = E[n] = 1.0 + n;
+
+  run("C(i,j) = A(i,j) + B(j,i)", n, [&] {
+    clobber(A); clobber(B);
+    add_transpose(C, A, B);
+    do_not_optimize(C);
+  });
+
+  run("A(i,j) = A(i,j) + B(j,i)", n, [&] {
+    clobber(A); clobber(B);
+    add_transpose_in_place(A, B);
+    do_not_optimize(A);
+  });
+
+  run("b(i) = A(i,j) * a(j)", n, [&] {
+    clobber(A); clobber(a);
+    matvec(b, A, a);
+    do_not_optimize(b);
+  });
+
+  run("C(i,j) = A(i,k) * B(k,j)", n, [&] {
+    clobber(A); clobber(B);
+    matmul(C, A, B);
+    do_not_optimize(C);
+  });
+
+  run("A(i,j) = A(i,k) * B(k,j)", n, [&] {
+    clobber(A); clobber(B);
+    matmul_in_place(A, B);
+    do_not_optimize(A);
+  });
+
+  run("F(i,l) = A(i,j) * B(j,k) * C(k,l)", n, [&] {
+    clobber(A); clobber(B); clobber(C);
+    chain(F, A, B, C);
+    do_not_optimize(F);
+  });
+
+  run("F(i,l) = lazy(A(i,j) * B(j,k)) * C(k,l)", n, [&] {
+    clobber(A); clobber(B); clobber(C);
+    lazy_chain(F, A, B, C);
+    do_not_optimize(F);
+  });
+
+  run("b(i) = A(i,j) * B(j,k) * a(k)", n, [&] {
+    clobber(A); clobber(B); clobber(a);
+    matmatvec(b, A, B, a);
+    do_not_optimize(b);
+  });
+
+  run("b(i) = lazy(A(i,j) * B(j,k)) * a(k)", n, [&] {
+    clobber(A); clobber(B); clobber(a);
+    lazy_matmatvec(b, A, B, a);
+    do_not_optimize(b);
+  });
+
+  run("C(i,j) = D(i,j,k,l) * A(k,l)", n, [&] {
+    clobber(D); clobber(A);
+    double_contraction(C, D, A);
+    do_not_optimize(C);
+  });
+
+  run("E(i,j,k,l) = D(i,j,k,l) * 2.0", n, [&] {
+    clobber(D);
+    scale(E, D);
+    do_not_optimize(E);
+  });
+
+  run("E(i,j,k,l) = A(i,j) * B(k,l)", n, [&] {
+    clobber(A); clobber(B);
+    outer(E, A, B);
+    do_not_optimize(E);
+  });
+
+  run("S = 2E + A, T = S - E, P += T / 2 + S", n, [&] {
+    clobber(A); clobber(B);
+    stress(C, F, P, A, B);
+    do_not_optimize(P);
+  });
+
+  run("fuse(S = 2E + A, T = S - E, ...)", n, [&] {
+    clobber(A); clobber(B);
+    fused_stress(C, F, P, A, B);
+    do_not_optimize(P);
+  });
+}
@@ -0,0 +1,85 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+
+using albert::Tensor;
+using albert::benchmarks::clobber;
+using albert::benchmarks::do_not_optimize;
+using albert::benchmarks::run;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+constexpr static long n = 100'000;
+
+/// A compressible Neo-Hookean energy of the right Cauchy-Green tensor.
+static constexpr auto neo_hookean = [](auto const& C) {
+  auto J = albert::sqrt(albert::det(C));
+  auto lnJ = albert::log(J);
+  return 1.5 * (C(i,i) - 3.0) - 3.0 * lnJ + lnJ * lnJ;
+};
+
+/// A quadratic energy with a nonlinear term, of an order 4 tensor.
+static constexpr auto quartic = [](auto const& A) {
+  auto s = A(i,j,k,l) * A(i,j,k,l);
+  return s + albert::exp(A(i,i,k,k) / 9.0) * s;
+};
+
+/// Each kernel is a separate out-of-line function so that we measure the
+/// per-call cost of a whole gradient.
+/// @{
+template <class Tensor>
+[[gnu::noinline]] static void forward(Tensor& g, Tensor const& x, auto const& f)
+{
+  g = albert::jacobian(f, x);
+}
+
+template <class Tensor>
+[[gnu::noinline]] static void reverse(Tensor& g, Tensor const& x, auto const& f, albert::ad::Tape<double>& tape)
+{
+  g = albert::ad::gradient(tape, f, x);
+}
+/// @}
+
+/// Forward mode computes all of the derivatives in one pass with duals as
+/// wide as the number of variables, while reverse mode records the energy and
+/// then propagates its adjoints in one backward pass.
+template <class Tensor>
+static void gradients(char const* name, Tensor& x, auto const& f)
+{
+  Tensor g;
+  albert::ad::Tape<double> tape;
+
+  char label[64];
+  std::snprintf(label, sizeof(label), "forward %s", name);
+  run(label, n, [&] {
+    clobber(x);
+    forward(g, x, f);
+    do_not_optimize(g);
+  });
+
+  std::snprintf(label, sizeof(label), "reverse %s", name);
+  run(label, n, [&] {
+    clobber(x);
+    reverse(g, x, f, tape);
+    do_not_optimize(g);
+  });
+  std::printf("%-40s %10d nodes\n", "", tape.size());
+}
+
+int main()
+{
+  Tensor<double, 2, 3> C;
+  for (int e = 0; e < 9; ++e) {
+    C[e] = (e % 4 == 0) + 0.01 * e;
+  }
+
+  Tensor<double, 4, 3> A;
+  for (int e = 0; e < 81; ++e) {
+    A[e] = 0.01 * (e % 7);
+  }
+
+  gradients("neo-hookean (9)", C, neo_hookean);
+  gradients("quartic (81)", A, quartic);
+}
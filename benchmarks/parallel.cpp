@@ -0,0 +1,75 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using albert::Tensor;
+using albert::ThreadPool;
+using albert::benchmarks::do_not_optimize;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+using Matrix = Tensor<double, 2, 3>;
+using Stiffness = Tensor<double, 4, 3>;
+
+struct Point
+{
+  Matrix epsilon;
+  Matrix sigma;
+};
+
+/// Time `reps` sweeps of a linear-elastic stress update over every point.
+static auto sweep(ThreadPool& pool, std::vector<Point>& points, Stiffness const& D, int reps) -> double
+{
+  using clock = std::chrono::steady_clock;
+
+  constexpr long flops = albert::flops_v<decltype(D(i,j,k,l) * points[0].epsilon(k,l))>;
+  auto update = [&](Point& p) {
+    p.sigma(i,j) = D(i,j,k,l) * p.epsilon(k,l);
+  };
+
+  albert::for_each_batch(pool, points, update, flops); // warm up
+
+  auto start = clock::now();
+  for (int r = 0; r < reps; ++r) {
+    albert::for_each_batch(pool, points, update, flops);
+    do_not_optimize(points);
+  }
+  std::chrono::duration<double, std::milli> elapsed = clock::now() - start;
+  return elapsed.count() / reps;
+}
+
+int main(int argc, char** argv)
+{
+  long n = (argc > 1) ? std::atol(argv[1]) : 1'000'000;
+  int reps = (argc > 2) ? std::atoi(argv[2]) : 20;
+
+  Stiffness D;
+  for (int n = 0; n < D.size(); ++n) D[n] = 1.0 + n % 7;
+
+  std::vector<Point> points(n);
+  for (long p = 0; p < n; ++p) {
+    for (int n = 0; n < 9; ++n) {
+      points[p].epsilon[n] = 1e-3 * (p % 13 + n);
+    }
+  }
+
+  std::printf("parallel: %ld points, sigma(i,j) = D(i,j,k,l) * epsilon(k,l), %u hardware threads\n",
+              n, std::thread::hardware_concurrency());
+  std::printf("%8s %12s %10s %12s\n", "threads", "ms/sweep", "speedup", "efficiency");
+
+  double serial = 0;
+  for (int threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+    ThreadPool pool(threads);
+    double ms = sweep(pool, points, D, reps);
+    if (threads == 1) {
+      serial = ms;
+    }
+    std::printf("%8d %12.3f %10.2f %11.0f%%\n", threads, ms, serial / ms, 100 * serial / ms / threads);
+  }
+}
@@ -0,0 +1,118 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <vector>
+
+using albert::Symmetric;
+using albert::Tensor;
+using albert::benchmarks::clobber;
+using albert::benchmarks::do_not_optimize;
+using albert::benchmarks::run;
+using albert::solver::cholesky_tag;
+using albert::solver::ldlt_tag;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+
+constexpr static long n = 2'000;
+constexpr static int systems = 1024;
+
+/// The tensor types are computed by a helper struct so that every mention of
+/// a type shares the same tag.
+template <int M>
+struct types
+{
+  using Matrix = Tensor<double, 2, M>;
+  using Packed = Tensor<double, 2, M, Symmetric<2, M>>;
+  using Vector = Tensor<double, 1, M>;
+};
+
+/// Each kernel copies and solves a whole array of systems, as in a loop over
+/// the material points of a mesh. The factorizations work in place, so the
+/// copy is part of every kernel.
+/// @{
+template <int M, class Matrix, class Vector>
+[[gnu::noinline]] static void lu(std::vector<Vector>& x, std::vector<Matrix> const& A, std::vector<Vector> const& b)
+{
+  for (int e = 0; e < systems; ++e) {
+    Matrix LU;
+    LU(i,j) = A[e](i,j);
+    x[e](i) = b[e](i);
+    albert::solver::solve<M>(LU, x[e]);
+  }
+}
+
+template <int M, class Factor, class Matrix, class Vector>
+[[gnu::noinline]] static void symmetric(std::vector<Vector>& x, std::vector<Matrix> const& A, std::vector<Vector> const& b, auto tag)
+{
+  for (int e = 0; e < systems; ++e) {
+    Factor L;
+    L(i,j) = A[e](i,j);
+    x[e](i) = b[e](i);
+    albert::solver::solve<M>(L, x[e], tag);
+  }
+}
+/// @}
+
+template <int M>
+static void solvers()
+{
+  using Matrix = typename types<M>::Matrix;
+  using Packed = typename types<M>::Packed;
+  using Vector = typename types<M>::Vector;
+
+  std::vector<Matrix> A(systems);
+  std::vector<Vector> b(systems), x(systems);
+  for (int e = 0; e < systems; ++e) {
+    Matrix B;
+    for (int m = 0; m < M; ++m) {
+      for (int n = 0; n < M; ++n) {
+        B(m,n) = (m * 3 + n * 5 + e) % 7 - 3;
+      }
+      b[e](m) = m + 1;
+    }
+    A[e](i,j) = B(i,k) * B(j,k);
+    for (int m = 0; m < M; ++m) {
+      A[e](m,m) += M;
+    }
+  }
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "%2dx%-2d lu", M, M);
+  run(name, n, [&] {
+    clobber(A); clobber(b);
+    lu<M>(x, A, b);
+    do_not_optimize(x);
+  });
+
+  std::snprintf(name, sizeof(name), "%2dx%-2d cholesky", M, M);
+  run(name, n, [&] {
+    clobber(A); clobber(b);
+    symmetric<M, Matrix>(x, A, b, cholesky_tag);
+    do_not_optimize(x);
+  });
+
+  std::snprintf(name, sizeof(name), "%2dx%-2d ldlt", M, M);
+  run(name, n, [&] {
+    clobber(A); clobber(b);
+    symmetric<M, Matrix>(x, A, b, ldlt_tag);
+    do_not_optimize(x);
+  });
+
+  std::snprintf(name, sizeof(name), "%2dx%-2d cholesky (packed)", M, M);
+  run(name, n, [&] {
+    clobber(A); clobber(b);
+    symmetric<M, Packed>(x, A, b, cholesky_tag);
+    do_not_optimize(x);
+  });
+}
+
+int main()
+{
+  std::printf("solvers, %d systems per array\n", systems);
+
+  solvers<3>();
+  solvers<6>();
+  solvers<9>();
+  solvers<12>();
+}
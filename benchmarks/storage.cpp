@@ -0,0 +1,134 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <vector>
+
+using albert::Aligned;
+using albert::RowMajor;
+using albert::Symmetric;
+using albert::Tensor;
+using albert::scalar_type_t;
+using albert::benchmarks::clobber;
+using albert::benchmarks::do_not_optimize;
+using albert::benchmarks::run;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+constexpr static long n = 20'000;
+constexpr static int tensors = 1024;
+
+using Matrix3 = Tensor<double, 2, 3>;
+using Matrix6 = Tensor<double, 2, 6>;
+using AlignedMatrix3 = Tensor<double, 2, 3, Aligned<double, 2, 3>>;
+using AlignedMatrix6 = Tensor<double, 2, 6, Aligned<double, 2, 6>>;
+using Strain = Tensor<double, 2, 3>;
+using Stiffness = Tensor<double, 4, 3>;
+using SymmetricStrain = Tensor<double, 2, 3, Symmetric<2, 3>>;
+using SymmetricStiffness = Tensor<double, 4, 3, Symmetric<4, 3>>;
+
+/// Each kernel runs over a whole array of tensors, as in a loop over the
+/// material points of a mesh.
+/// @{
+template <class Tensor>
+[[gnu::noinline]] static void axpy(std::vector<Tensor>& C, std::vector<Tensor> const& A, std::vector<Tensor> const& B)
+{
+  using T = scalar_type_t<Tensor>;
+  for (int e = 0; e < tensors; ++e) {
+    C[e](i,j) += A[e](i,j) - T(2) * B[e](i,j);
+  }
+}
+
+template <class Tensor>
+[[gnu::noinline]] static void matmul(std::vector<Tensor>& C, std::vector<Tensor> const& A, std::vector<Tensor> const& B)
+{
+  for (int e = 0; e < tensors; ++e) {
+    C[e](i,j) = A[e](i,k) * B[e](k,j);
+  }
+}
+
+template <class Stiffness, class Strain>
+[[gnu::noinline]] static void stress(std::vector<Strain>& sigma, Stiffness const& C, std::vector<Strain> const& epsilon)
+{
+  for (int e = 0; e < tensors; ++e) {
+    sigma[e](i,j) = C(i,j,k,l) * epsilon[e](k,l);
+  }
+}
+/// @}
+
+template <class Tensor>
+static void array(char const* type)
+{
+  std::vector<Tensor> A(tensors), B(tensors), C(tensors);
+  for (int e = 0; e < tensors; ++e) {
+    for (int m = 0; m < Tensor::dim(); ++m) {
+      for (int n = 0; n < Tensor::dim(); ++n) {
+        A[e](m,n) = B[e](m,n) = C[e](m,n) = 1 + m + n;
+      }
+    }
+  }
+
+  std::printf("%s: %d bytes each, %d byte aligned\n", type, int(sizeof(Tensor)), int(alignof(Tensor)));
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s C += A - 2B", type);
+  run(name, n, [&] {
+    clobber(A); clobber(B);
+    axpy(C, A, B);
+    do_not_optimize(C);
+  });
+
+  std::snprintf(name, sizeof(name), "%s C = A * B", type);
+  run(name, n, [&] {
+    clobber(A); clobber(B);
+    matmul(C, A, B);
+    do_not_optimize(C);
+  });
+}
+
+template <class Stiffness, class Strain>
+static void constitutive(char const* type)
+{
+  Stiffness C;
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      for (int c = 0; c < 3; ++c) {
+        for (int d = 0; d < 3; ++d) {
+          C(a,b,c,d) = 3.0 * (a == b) * (c == d) + 2.0 * ((a == c) * (b == d) + (a == d) * (b == c));
+        }
+      }
+    }
+  }
+
+  std::vector<Strain> epsilon(tensors), sigma(tensors);
+  for (int e = 0; e < tensors; ++e) {
+    for (int a = 0; a < 3; ++a) {
+      for (int b = 0; b < 3; ++b) {
+        epsilon[e](a,b) = 1 + a + b;
+      }
+    }
+  }
+
+  std::printf("%s: %d + %d bytes\n", type, int(sizeof(Stiffness)), int(sizeof(Strain)));
+
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s sigma = C : epsilon", type);
+  run(name, n, [&] {
+    clobber(C); clobber(epsilon);
+    stress(sigma, C, epsilon);
+    do_not_optimize(sigma);
+  });
+}
+
+int main()
+{
+  std::printf("storage, %d tensors per array (simd bytes %d)\n", tensors, albert::simd_bytes);
+
+  array<Matrix3>("3x3 dense  ");
+  array<AlignedMatrix3>("3x3 aligned");
+  array<Matrix6>("6x6 dense  ");
+  array<AlignedMatrix6>("6x6 aligned");
+  constitutive<Stiffness, Strain>("dense    ");
+  constitutive<SymmetricStiffness, SymmetricStrain>("symmetric");
+}
@@ -4,10 +4,17 @@
 #include "albert/Index.hpp"
 #include "albert/ScalarIndex.hpp"
 #include "albert/TensorIndex.hpp"
+#include "albert/aliasing.hpp"
 #include "albert/concepts.hpp"
 #include "albert/evaluate.hpp"
+#include "albert/materialize.hpp"
+#include "albert/simd.hpp"
+#include "albert/sparsity.hpp"
+#include "albert/symmetry.hpp"
 #include "albert/utils.hpp"
 #include <ce/cvector.hpp>
+#include <array>
+#include <memory>
 #include <utility>
 
 namespace albert
@@ -96,26 +103,20 @@ namespace albert
     constexpr auto operator=(B&& b)
       -> Bind&
     {
-      return assign(FWD(b), [](auto&& a, auto&&b) {
-          FWD(a) = FWD(b);
-      });
+      return assign(FWD(b), ops::assign{});
     }
 
     template <is_expression B>
     constexpr auto operator+=(B&& b)
       -> Bind&
     {
-      return assign(FWD(b), [](auto&& a, auto&&b) {
-          FWD(a) += FWD(b);
-      });
+      return assign(FWD(b), ops::add{});
     }
 
     constexpr auto operator-=(is_expression auto && b)
       -> Bind&
     {
-      return assign(FWD(b), [](auto&& a, auto&&b) {
-          FWD(a) -= FWD(b);
-      });
+      return assign(FWD(b), ops::subtract{});
     }
 
     template <is_expression B>
@@ -126,13 +127,49 @@ namespace albert
       constexpr TensorIndex r = outer_v<B>;
       static_assert(is_permutation(l, r), "indices don't match in assignment");
 
-      constexpr bool transpose = (l != r and std::remove_cvref_t<B>::contains(tag()));
-      if constexpr (transpose or std::remove_cvref_t<B>::may_alias(tag())) {
-        return albert::evaluate_via_temp(*this, FWD(b), FWD(op));
+      // The aliasing decision is made on the original expression, any
+      // temporaries introduced by materialization or by sharing common
+      // subexpressions are computed before the left-hand-side is written.
+      //
+      // The static analysis is conservative, it only knows that a leaf may
+      // share storage with the left-hand-side (e.g., the right-hand-side
+      // contains a view, or a different tensor of the same type), so it is
+      // refined at runtime. Pointwise reads of tensors can only share storage
+      // by being the same tensor, but views can also overlap without referring
+      // to the same elements.
+      constexpr Access access = access_v<Bind, B>;
+      constexpr bool views = (is_view_tag_v<decltype(tag())> or
+                              std::remove_cvref_t<B>::contains(detail::view_probe));
+      if constexpr (access != Access::pointwise or views) {
+        Access needed = std::is_constant_evaluated() ? access : albert::access(*this, b);
+        if constexpr (detail::row_v<Bind> != '\0') {
+          if (needed == Access::row) {
+            return share(FWD(b), [&](auto&& c) -> Bind& {
+              return albert::evaluate_via_row_temp(*this, materialize(FWD(c)), op);
+            });
+          }
+        }
+        if (needed != Access::pointwise) {
+          return share(FWD(b), [&](auto&& c) -> Bind& {
+            return albert::evaluate_via_temp(*this, materialize(FWD(c)), op);
+          });
+        }
       }
-      else {
-        return albert::evaluate(*this, FWD(b), FWD(op));
+
+      // Purely elementwise assignments in a single linear order stream
+      // directly over storage with explicit vectors.
+      if constexpr (l == r and is_vectorizable<Bind> and is_vectorizable<B> and
+                    not std::is_void_v<vector_layout_t<Bind>> and
+                    std::is_same_v<scalar_type, scalar_type_t<B>> and
+                    same_vector_layout_v<Bind, B>) {
+        if (not std::is_constant_evaluated()) {
+          return albert::evaluate_linear(*this, FWD(b), FWD(op));
+        }
       }
+
+      return share(FWD(b), [&](auto&& c) -> Bind& {
+        return albert::evaluate(*this, materialize(FWD(c)), op);
+      });
     }
 
     /// Evaluate into a scalar.
@@ -141,9 +178,12 @@ namespace albert
       return evaluate(ScalarIndex<0>{});
     }
 
+    /// Traces and projections read elements other than the one being
+    /// evaluated.
     constexpr static bool may_alias(auto&& tag)
     {
-      return std::remove_cvref_t<A>::may_alias(FWD(tag));
+      return (std::remove_cvref_t<A>::may_alias(FWD(tag)) or
+              (index.n_repeated() + index.n_projected() != 0 and contains(FWD(tag))));
     }
 
     constexpr static bool contains(auto&& tag)
@@ -158,6 +198,37 @@ namespace albert
       return std::remove_cvref_t<A>::tag();
     }
 
+    /// The order in which the outer indices walk the subtree's storage.
+    ///
+    /// This lists the positions in the outer index from the slowest varying in
+    /// storage to the fastest, following the layout of a bound tensor. Axes
+    /// that are projected or contracted don't appear in the outer index and
+    /// are skipped.
+    constexpr static auto storage_order()
+      requires requires { std::remove_cvref_t<A>::layout_type::axes; }
+    {
+      constexpr TensorIndex outer = index.exclusive();
+      std::array<int, outer.size()> axes = {};
+      int k = 0;
+      for (int axis : std::remove_cvref_t<A>::layout_type::axes) {
+        for (int i = 0; i < outer.size(); ++i) {
+          if (outer[i] == index[axis]) {
+            axes[k++] = i;
+          }
+        }
+      }
+      return axes;
+    }
+
+    /// The indices that the outer index needs to visit to write each element
+    /// of packed (e.g., symmetric) storage exactly once.
+    constexpr static auto storage_indices() -> decltype(auto)
+      requires (index.n_projected() + index.n_repeated() == 0 and
+                requires { std::remove_cvref_t<A>::layout_type::unique; })
+    {
+      return (std::remove_cvref_t<A>::layout_type::unique);
+    }
+
     /// CPO support.
     constexpr static auto outer()
       -> decltype(auto)
@@ -196,11 +267,11 @@ namespace albert
         return a.evaluate(select<all, index>(i));
       };
 
-      ScalarIndex<Order + I> j(i + _projected);
-      decltype(rhs(j)) temp{};
-      do {
-        temp += rhs(j);
-      } while (carry_sum_inc<N, Order>(j));
+      ScalarIndex<Order> k(i + _projected);
+      decltype(rhs(k + ScalarIndex<I>{})) temp{};
+      for_each_index<I, N>([&](ScalarIndex<I> const& j) {
+        temp += rhs(k + j);
+      });
       return temp;
     }
 
@@ -252,6 +323,141 @@ namespace albert
   Bind(A&&, ce::cvector<int, M> const&, nttp_args<index>)
     -> Bind<A, index>;
 
+  /// Binds of raw tensors (or views), which read an element straight from
+  /// storage.
+  template <class>
+  constexpr inline bool is_tensor_bind_v = false;
+
+  template <is_tensor A, is_tensor_index auto index>
+  constexpr inline bool is_tensor_bind_v<Bind<A, index>> = not is_expression<std::remove_cvref_t<A>>;
+
+  /// Materialize the subtree of a bind node.
+  ///
+  /// Binds of raw tensors are leaves, so this only changes binds of
+  /// expression subtrees (e.g., a rebound product).
+  template <is_tensor A, is_tensor_index auto index>
+  struct materializer<Bind<A, index>>
+  {
+    constexpr static bool changes = materializer<std::remove_cvref_t<A>>::changes;
+
+    constexpr static auto apply(auto&& bind)
+    {
+      ce::cvector<int, Bind<A, index>::M> projected;
+      for (int i : bind._projected) {
+        projected.push_back(i);
+      }
+      return Bind { materialize(FWD(bind).a), projected, nttp<index> };
+    }
+  };
+
+  /// Binds of expressions are interior nodes, while binds of tensors are
+  /// leaves that are the same when they bind the same tensor.
+  template <is_tensor A, is_tensor_index auto index>
+  struct subexpression<Bind<A, index>>
+  {
+    constexpr static bool expression = is_expression<std::remove_cvref_t<A>>;
+    constexpr static int arity = expression;
+    constexpr static bool elementwise = (index.n_repeated() == 0);
+
+    constexpr static bool same(Bind<A, index> const& x, Bind<A, index> const& y)
+    {
+      for (int m = 0; m < Bind<A, index>::M; ++m) {
+        if (x._projected[m] != y._projected[m]) {
+          return false;
+        }
+      }
+      return expression or std::addressof(x.a) == std::addressof(y.a);
+    }
+
+    constexpr static auto rebuild(auto&& bind, auto&& a)
+    {
+      ce::cvector<int, Bind<A, index>::M> projected;
+      for (int i : bind._projected) {
+        projected.push_back(i);
+      }
+      return Bind { FWD(a), projected, nttp<index> };
+    }
+  };
+
+  /// Binds of expressions that don't rename, contract, or project their
+  /// subtree's index read it at the index they are evaluated at.
+  template <is_tensor A, is_tensor_index auto index>
+  requires (is_expression<std::remove_cvref_t<A>> and index == outer_v<A>)
+  struct dependence<Bind<A, index>> : local_dependence<> {};
+
+  /// Binds of expressions are diagonal wherever their subtree is.
+  template <is_tensor A, is_tensor_index auto index>
+  requires (index.n_projected() + index.n_repeated() == 0 and is_expression<std::remove_cvref_t<A>>)
+  struct diagonal<Bind<A, index>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      constexpr TensorIndex outer = outer_v<A>;
+      if (index.count(a) != 1 or index.count(b) != 1) {
+        return false;
+      }
+      return is_diagonal_in<A>(outer[index.index_of(a)], outer[index.index_of(b)]);
+    }
+  };
+
+  /// Binds of tensors with packed symmetric storage are symmetric in the
+  /// characters bound to each symmetric pair of axes.
+  template <is_tensor A, is_tensor_index auto index>
+  requires requires { std::remove_cvref_t<A>::layout_type::symmetries; }
+  struct symmetry<Bind<A, index>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      if (a == b or index.count(a) != 1 or index.count(b) != 1) {
+        return false;
+      }
+      for (auto [p, q] : std::remove_cvref_t<A>::layout_type::symmetries) {
+        if ((index[p] == a and index[q] == b) or (index[p] == b and index[q] == a)) {
+          return true;
+        }
+      }
+      return false;
+    }
+  };
+
+  /// Vectorize a bind of a tensor.
+  ///
+  /// Only binds without projection or contraction over a tensor with linear
+  /// access to its storage participate, so that offset `n` in the bind is
+  /// offset `n` in the storage. Offset `n` is only the same element in two
+  /// binds with the same layout, and streams over padding in padded layouts.
+  template <is_tensor A, is_tensor_index auto index>
+  requires (order_v<A> != 0 and
+            index.n_projected() + index.n_repeated() == 0 and
+            std::floating_point<scalar_type_t<A>> and
+            requires (std::remove_cvref_t<A> const& a) { a.data(); a[0]; })
+  struct vectorizer<Bind<A, index>>
+  {
+    constexpr static bool enabled = true;
+    using layout = typename std::remove_cvref_t<A>::layout_type;
+
+    template <class V>
+    static auto apply(Bind<A, index> const& bind, int n) -> V
+    {
+      return simd_load<V, layout::align>(bind.a.data() + n);
+    }
+  };
+
+  /// Binds of order 0 tensors are broadcast, like literals, and have no
+  /// layout of their own.
+  template <is_tensor A, is_tensor_index auto index>
+  requires (order_v<A> == 0 and std::floating_point<scalar_type_t<A>>)
+  struct vectorizer<Bind<A, index>>
+  {
+    constexpr static bool enabled = true;
+
+    template <class V>
+    static auto apply(Bind<A, index> const& bind, int) -> V
+    {
+      return simd_broadcast<V>(bind.evaluate(ScalarIndex<0>{}));
+    }
+  };
+
   template <class T>
   struct Bindable
   {
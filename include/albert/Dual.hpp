@@ -0,0 +1,396 @@
+#ifndef ALBERT_INCLUDE_DUAL_HPP
+#define ALBERT_INCLUDE_DUAL_HPP
+
+#include "albert/Tensor.hpp"
+#include "albert/TensorBatch.hpp"
+#include "albert/concepts.hpp"
+#include "albert/evaluate.hpp"
+#include "albert/simd.hpp"
+#include "albert/utils.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <type_traits>
+
+namespace albert
+{
+  /// A dual number for forward mode automatic differentiation.
+  ///
+  /// A `Dual<T, K>` carries a value and its derivatives with respect to `K`
+  /// independent variables, and every arithmetic operation and elementary
+  /// function applies the chain rule to all of them at once. The derivatives
+  /// are stored in native vectors, so each update is a handful of vector
+  /// instructions.
+  ///
+  /// Duals are scalars (see `traits::is_scalar`), so tensors of duals work
+  /// through every expression node and solver, and differentiate whatever they
+  /// compute.
+  ///
+  ///     Tensor<Dual<double, 9>, 2, 3> E = ...;  // seeded with `variable`
+  ///     Tensor S = lambda * E(k,k) * δ(i,j) + 2 * mu * E(i,j);
+  ///     S(0,0).derivative(4);                   // dS(0,0)/dE(1,1)
+  ///
+  /// Comparisons use the values only, and the derivatives of the rounding
+  /// functions are zero.
+  template <std::floating_point T, int K>
+  requires (K > 0)
+  struct Dual
+  {
+    /// The derivatives are padded to a whole number of vectors, which are no
+    /// wider than the native vectors.
+    constexpr static int lanes = std::min(std::bit_ceil(unsigned(K)),
+                                          unsigned(std::max(simd_width_v<T>, 1)));
+    constexpr static int vectors = (K + lanes - 1) / lanes;
+
+    using vector = typename batch_vector<T, lanes>::type;
+
+    T v = {};
+    std::array<vector, vectors> d = {};
+
+    constexpr Dual() = default;
+
+    /// A constant, with zero derivatives.
+    constexpr Dual(T v)
+        : v(v)
+    {
+    }
+
+    /// The `k`th independent variable, with the value `v`.
+    constexpr static auto variable(T v, int k) -> Dual
+    {
+      Dual x(v);
+      x.d[k / lanes][k % lanes] = T(1);
+      return x;
+    }
+
+    constexpr auto value() const -> T
+    {
+      return v;
+    }
+
+    /// The derivative with respect to the `k`th variable.
+    constexpr auto derivative(int k) const -> T
+    {
+      return d[k / lanes][k % lanes];
+    }
+
+    /// The dual `f(x)`, given `f(x)` and `f'(x)`.
+    constexpr friend auto chain(T f, T df, Dual const& x) -> Dual
+    {
+      Dual y(f);
+      for (int n = 0; n < vectors; ++n) {
+        y.d[n] = df * x.d[n];
+      }
+      return y;
+    }
+
+    /// The dual `f(x, y)`, given `f(x, y)` and its partial derivatives.
+    constexpr friend auto chain(T f, T dx, Dual const& x, T dy, Dual const& y) -> Dual
+    {
+      Dual z(f);
+      for (int n = 0; n < vectors; ++n) {
+        z.d[n] = dx * x.d[n] + dy * y.d[n];
+      }
+      return z;
+    }
+
+    constexpr auto operator+=(Dual const& b) -> Dual&
+    {
+      v += b.v;
+      for (int n = 0; n < vectors; ++n) {
+        d[n] += b.d[n];
+      }
+      return *this;
+    }
+
+    constexpr auto operator-=(Dual const& b) -> Dual&
+    {
+      v -= b.v;
+      for (int n = 0; n < vectors; ++n) {
+        d[n] -= b.d[n];
+      }
+      return *this;
+    }
+
+    constexpr auto operator*=(Dual const& b) -> Dual&
+    {
+      return *this = chain(v * b.v, b.v, *this, v, b);
+    }
+
+    constexpr auto operator/=(Dual const& b) -> Dual&
+    {
+      T r = T(1) / b.v;
+      T q = v * r;
+      return *this = chain(q, r, *this, -q * r, b);
+    }
+
+    constexpr auto operator+=(T b) -> Dual&
+    {
+      v += b;
+      return *this;
+    }
+
+    constexpr auto operator-=(T b) -> Dual&
+    {
+      v -= b;
+      return *this;
+    }
+
+    constexpr auto operator*=(T b) -> Dual&
+    {
+      return *this = chain(v * b, b, *this);
+    }
+
+    constexpr auto operator/=(T b) -> Dual&
+    {
+      return *this *= T(1) / b;
+    }
+
+    /// Arithmetic. The operators take their operands by value, so that they
+    /// are preferred over the expression grammar's forwarding templates.
+    /// @{
+    constexpr friend auto operator+(Dual a) -> Dual
+    {
+      return a;
+    }
+
+    constexpr friend auto operator-(Dual a) -> Dual
+    {
+      return chain(-a.v, T(-1), a);
+    }
+
+    constexpr friend auto operator+(Dual a, Dual const& b) -> Dual { return a += b; }
+    constexpr friend auto operator-(Dual a, Dual const& b) -> Dual { return a -= b; }
+    constexpr friend auto operator*(Dual a, Dual const& b) -> Dual { return a *= b; }
+    constexpr friend auto operator/(Dual a, Dual const& b) -> Dual { return a /= b; }
+
+    constexpr friend auto operator+(Dual a, T b) -> Dual { return a += b; }
+    constexpr friend auto operator-(Dual a, T b) -> Dual { return a -= b; }
+    constexpr friend auto operator*(Dual a, T b) -> Dual { return a *= b; }
+    constexpr friend auto operator/(Dual a, T b) -> Dual { return a /= b; }
+
+    constexpr friend auto operator+(T a, Dual b) -> Dual { return b += a; }
+    constexpr friend auto operator-(T a, Dual b) -> Dual { return -(b -= a); }
+    constexpr friend auto operator*(T a, Dual b) -> Dual { return b *= a; }
+    constexpr friend auto operator/(T a, Dual b) -> Dual { return Dual(a) /= b; }
+    /// @}
+
+    /// Comparisons of the values.
+    /// @{
+    constexpr friend auto operator==(Dual const& a, Dual const& b) -> bool { return a.v == b.v; }
+    constexpr friend auto operator==(Dual const& a, T b) -> bool { return a.v == b; }
+    constexpr friend auto operator<=>(Dual const& a, Dual const& b) { return a.v <=> b.v; }
+    constexpr friend auto operator<=>(Dual const& a, T b) { return a.v <=> b; }
+    /// @}
+
+    /// The elementary functions, found by argument dependent lookup in the
+    /// same way as the cmath overloads for the floating point types.
+    /// @{
+    friend auto abs(Dual x) -> Dual
+    {
+      return (x.v < T(0)) ? -x : x;
+    }
+
+    friend auto fabs(Dual x) -> Dual
+    {
+      return abs(x);
+    }
+
+    friend auto sqrt(Dual x) -> Dual
+    {
+      T s = std::sqrt(x.v);
+      return chain(s, T(0.5) / s, x);
+    }
+
+    friend auto cbrt(Dual x) -> Dual
+    {
+      T c = std::cbrt(x.v);
+      return chain(c, T(1) / (3 * c * c), x);
+    }
+
+    friend auto exp(Dual x) -> Dual
+    {
+      T e = std::exp(x.v);
+      return chain(e, e, x);
+    }
+
+    friend auto log(Dual x) -> Dual
+    {
+      return chain(std::log(x.v), T(1) / x.v, x);
+    }
+
+    friend auto pow(Dual a, Dual b) -> Dual
+    {
+      T p = std::pow(a.v, b.v);
+      T da = (b.v == T(0)) ? T(0) : b.v * std::pow(a.v, b.v - T(1));
+      T db = (a.v == T(0)) ? T(0) : p * std::log(a.v);
+      return chain(p, da, a, db, b);
+    }
+
+    friend auto pow(Dual a, T b) -> Dual
+    {
+      T da = (b == T(0)) ? T(0) : b * std::pow(a.v, b - T(1));
+      return chain(std::pow(a.v, b), da, a);
+    }
+
+    friend auto pow(T a, Dual b) -> Dual
+    {
+      T p = std::pow(a, b.v);
+      return chain(p, (a == T(0)) ? T(0) : p * std::log(a), b);
+    }
+
+    friend auto sin(Dual x) -> Dual
+    {
+      return chain(std::sin(x.v), std::cos(x.v), x);
+    }
+
+    friend auto cos(Dual x) -> Dual
+    {
+      return chain(std::cos(x.v), -std::sin(x.v), x);
+    }
+
+    friend auto tan(Dual x) -> Dual
+    {
+      T t = std::tan(x.v);
+      return chain(t, 1 + t * t, x);
+    }
+
+    friend auto asin(Dual x) -> Dual
+    {
+      return chain(std::asin(x.v), 1 / std::sqrt(1 - x.v * x.v), x);
+    }
+
+    friend auto acos(Dual x) -> Dual
+    {
+      return chain(std::acos(x.v), -1 / std::sqrt(1 - x.v * x.v), x);
+    }
+
+    friend auto atan(Dual x) -> Dual
+    {
+      return chain(std::atan(x.v), 1 / (1 + x.v * x.v), x);
+    }
+
+    friend auto atan2(Dual y, Dual x) -> Dual
+    {
+      T r = 1 / (x.v * x.v + y.v * y.v);
+      return chain(std::atan2(y.v, x.v), x.v * r, y, -y.v * r, x);
+    }
+
+    friend auto sinh(Dual x) -> Dual
+    {
+      return chain(std::sinh(x.v), std::cosh(x.v), x);
+    }
+
+    friend auto cosh(Dual x) -> Dual
+    {
+      return chain(std::cosh(x.v), std::sinh(x.v), x);
+    }
+
+    friend auto tanh(Dual x) -> Dual
+    {
+      T t = std::tanh(x.v);
+      return chain(t, 1 - t * t, x);
+    }
+
+    friend auto asinh(Dual x) -> Dual
+    {
+      return chain(std::asinh(x.v), 1 / std::sqrt(x.v * x.v + 1), x);
+    }
+
+    friend auto acosh(Dual x) -> Dual
+    {
+      return chain(std::acosh(x.v), 1 / std::sqrt(x.v * x.v - 1), x);
+    }
+
+    friend auto atanh(Dual x) -> Dual
+    {
+      return chain(std::atanh(x.v), 1 / (1 - x.v * x.v), x);
+    }
+
+    friend auto fmin(Dual a, Dual b) -> Dual
+    {
+      return (b.v < a.v or a.v != a.v) ? b : a;
+    }
+
+    friend auto fmax(Dual a, Dual b) -> Dual
+    {
+      return (b.v > a.v or a.v != a.v) ? b : a;
+    }
+
+    friend auto ceil(Dual x) -> Dual
+    {
+      return Dual(std::ceil(x.v));
+    }
+
+    friend auto floor(Dual x) -> Dual
+    {
+      return Dual(std::floor(x.v));
+    }
+    /// @}
+  };
+
+  namespace traits
+  {
+    /// Duals are scalars.
+    template <class T, int K>
+    struct is_scalar<Dual<T, K>> : std::true_type {};
+  }
+
+  /// The Jacobian of a tensor function, in one evaluation.
+  ///
+  /// The function `f` is called once with a copy of `x` whose elements are
+  /// the independent variables, and returns a dual tensor (or a dual scalar,
+  /// or an expression of either). The result is the tensor of its derivatives
+  /// with the indices of `f(x)` followed by the indices of `x`, e.g., for a
+  /// stress `S(i,j)` computed from the strain `E(k,l)` the material tangent is
+  /// `J(i,j,k,l) = ∂S(i,j)/∂E(k,l)`, of type `Tensor<T, 4, N>`.
+  constexpr auto jacobian(auto&& f, is_tensor auto const& x)
+  {
+    using X = std::remove_cvref_t<decltype(x)>;
+    using T = scalar_type_t<X>;
+    constexpr int R = order_v<X>;
+    constexpr int N = dim_v<X>;
+    constexpr int K = pow(N, R);
+    using D = Dual<T, K>;
+
+    Tensor<D, R, N> v;
+    for (int m = 0; m < K; ++m) {
+      v[m] = D::variable(x.evaluate(detail::unravel<R, N>(m)), m);
+    }
+
+    auto&& y = f(v);
+    using Y = std::remove_cvref_t<decltype(y)>;
+    if constexpr (is_scalar<Y>) {
+      Tensor<T, R, N> J;
+      for (int m = 0; m < K; ++m) {
+        J[m] = y.derivative(m);
+      }
+      return J;
+    }
+    else {
+      constexpr int S = order_v<Y>;
+      Tensor<T, S + R, N> J;
+      for (int n = 0; n < pow(N, S); ++n) {
+        D const e = y.evaluate(detail::unravel<S, N>(n));
+        for (int m = 0; m < K; ++m) {
+          J[n * K + m] = e.derivative(m);
+        }
+      }
+      return J;
+    }
+  }
+}
+
+namespace std
+{
+  template <class T, int K>
+  struct numeric_limits<albert::Dual<T, K>> : numeric_limits<T>
+  {
+  };
+}
+
+#endif // ALBERT_INCLUDE_DUAL_HPP
@@ -4,6 +4,7 @@
 #include "albert/concepts.hpp"
 #include "albert/utils.hpp"
 #include <ce/cvector.hpp>
+#include <array>
 
 namespace albert
 {
@@ -11,27 +12,34 @@ namespace albert
   ///
   /// Scalar indices are stored "big endian" in the sense that the outermost
   /// index is at offset 0.
+  ///
+  /// The storage is a fixed-size array rather than a `ce::cvector` so that the
+  /// optimizer never has to track a runtime size through index arithmetic.
   template <int Order>
   struct ScalarIndex
   {
-    ce::cvector<int, Order> _data = { Order };
+    std::array<int, Order> _data = {};
 
     constexpr ScalarIndex() = default;
 
     template <int B>
     constexpr ScalarIndex(ScalarIndex<B> const& b)
     {
-      std::copy_n(b.begin(), b.size(), _data.begin());
+      for (int i = 0; i < B; ++i) {
+        _data[i] = b[i];
+      }
     }
 
     template <int B>
     constexpr ScalarIndex(ce::cvector<int, B> const& b)
     {
-      std::copy_n(b.begin(), b.size(), _data.begin());
+      for (int i = 0, e = b.size(); i < e; ++i) {
+        _data[i] = b[i];
+      }
     }
 
     constexpr ScalarIndex(std::same_as<int> auto... is)
-        : _data { std::in_place, is... }
+        : _data { is... }
     {
     }
 
@@ -4,27 +4,35 @@
 #include "albert/Bind.hpp"
 #include "albert/TensorLayout.hpp"
 #include "albert/TensorStorage.hpp"
+#include "albert/aliasing.hpp"
 #include "albert/concepts.hpp"
 #include "albert/evaluate.hpp"
 #include "albert/utils.hpp"
 
 namespace albert
 {
+  /// A tensor that owns its storage.
+  ///
+  /// The `Layout` maps multidimensional indices to the linear storage, and
+  /// defaults to row-major (see TensorLayout.hpp for column-major, permuted and
+  /// padded layouts).
   template <
     class T,
     int Order,
     int N,
+    class Layout = RowMajor<Order, N>,
     auto _tag = []()->void{} // https://gcc.gnu.org/bugzilla/show_bug.cgi?id=99902
     >
-  struct Tensor : Bindable<Tensor<T, Order, N, _tag>>
+  struct Tensor : Bindable<Tensor<T, Order, N, Layout, _tag>>
   {
-    using Bindable<Tensor<T, Order, N, _tag>>::operator();
+    using Bindable<Tensor<T, Order, N, Layout, _tag>>::operator();
 
     using scalar_type = T;
+    using layout_type = Layout;
 
-    constexpr static RowMajor<Order, N> _map = {};
+    constexpr static Layout _map = {};
 
-    DenseStorage<T, Order, N> _data;
+    DenseStorage<T, Order, N, Layout::size, Layout::align> _data;
 
     constexpr operator scalar_type() const requires(Order == 0)
     {
@@ -36,10 +44,12 @@ namespace albert
       return _tag;
     }
 
+    /// Any view may refer to the storage of this tensor.
     constexpr static bool contains(auto&& tag)
     {
-      return std::is_same_v<std::remove_cvref_t<decltype(tag)>,
-                            std::remove_cvref_t<decltype(_tag)>>;
+      return (is_view_tag_v<decltype(tag)> or
+              std::is_same_v<std::remove_cvref_t<decltype(tag)>,
+                             std::remove_cvref_t<decltype(_tag)>>);
     }
 
     constexpr static bool may_alias(auto&&)
@@ -65,14 +75,35 @@ namespace albert
       return N;
     }
 
-    constexpr Tensor() = default;
+    constexpr Tensor() requires (Layout::dense) = default;
 
+    /// Padding is zeroed so that kernels that stream over it only see finite
+    /// values.
+    constexpr Tensor() requires (not Layout::dense)
+      : _data {}
+    {
+    }
+
+    /// Initialize the tensor from values in row-major order, whatever its
+    /// layout.
     constexpr Tensor(std::convertible_to<T> auto t, std::convertible_to<T> auto... ts)
+        requires (std::is_same_v<Layout, RowMajor<Order, N>>)
       : _data { static_cast<T>(t), static_cast<T>(ts)... }
     {
       static_assert(sizeof...(ts) < size());
     }
 
+    constexpr Tensor(std::convertible_to<T> auto t, std::convertible_to<T> auto... ts)
+        requires (not std::is_same_v<Layout, RowMajor<Order, N>>)
+      : _data {}
+    {
+      static_assert(sizeof...(ts) < size());
+      T values[] = { static_cast<T>(t), static_cast<T>(ts)... };
+      for (int n = 0; n < int(std::size(values)); ++n) {
+        _data[_map(detail::unravel<Order, N>(n))] = values[n];
+      }
+    }
+
     /// Make a copy of the data with a new tag, for both copy construction and
     /// assignment.
     constexpr Tensor(Tensor const&) = delete;
@@ -80,7 +111,7 @@ namespace albert
 
     template <auto other_tag>
     // requires (other_tag != _tag) https://gcc.gnu.org/bugzilla/show_bug.cgi?id=101155
-    constexpr Tensor(Tensor<T, Order, N, other_tag> const& b)
+    constexpr Tensor(Tensor<T, Order, N, Layout, other_tag> const& b)
         : _data { b._data }
     {
     }
@@ -94,6 +125,9 @@ namespace albert
     constexpr Tensor(B&& b)
     {
       static_assert(order_v<B> == Order, "expression order does not match");
+      if constexpr (not Layout::dense) {
+        _data = {};
+      }
       Bind(*this, {}, nttp<outer_v<B>>) = FWD(b);
     }
 
@@ -113,6 +147,25 @@ namespace albert
       return std::move(Bind(std::move(*this), {}, nttp<outer_v<B>>) = FWD(b));
     }
 
+    /// The number of elements spanned by the storage, including padding.
+    constexpr static auto span()
+      -> int
+    {
+      return Layout::size;
+    }
+
+    /// Pointer to the linear storage.
+    constexpr auto data() const -> T const*
+    {
+      return _data.data();
+    }
+
+    /// Pointer to the linear storage.
+    constexpr auto data() -> T*
+    {
+      return _data.data();
+    }
+
     /// Normal linear access.
     constexpr auto operator[](std::integral auto i) const
       -> decltype(auto)
@@ -149,12 +202,12 @@ namespace albert
   Tensor(B) -> Tensor<scalar_type_t<B>, order_v<B>, dim_v<B>>;
 
   /// Update the tag during a copy construction.
-  template <class T, int Order, int N, auto tag>
-  Tensor(Tensor<T, Order, N, tag> const&) -> Tensor<T, Order, N>;
+  template <class T, int Order, int N, class Layout, auto tag>
+  Tensor(Tensor<T, Order, N, Layout, tag> const&) -> Tensor<T, Order, N, Layout>;
 
   /// Retain the tag during a move construction.
-  template <class T, int Order, int N, auto tag>
-  Tensor(Tensor<T, Order, N, tag>&&) -> Tensor<T, Order, N, tag>;
+  template <class T, int Order, int N, class Layout, auto tag>
+  Tensor(Tensor<T, Order, N, Layout, tag>&&) -> Tensor<T, Order, N, Layout, tag>;
 }
 
 #endif // ALBERT_INCLUDE_TENSOR_HPP
@@ -0,0 +1,102 @@
+#ifndef ALBERT_INCLUDE_TENSOR_BATCH_HPP
+#define ALBERT_INCLUDE_TENSOR_BATCH_HPP
+
+#include "albert/Tensor.hpp"
+#include "albert/concepts.hpp"
+#include "albert/simd.hpp"
+#include "albert/utils.hpp"
+#include <bit>
+#include <concepts>
+#include <type_traits>
+
+namespace albert
+{
+  /// A vector of `Lanes` independent scalars, using the compiler's vector
+  /// extensions.
+  template <class T, int Lanes>
+  requires (std::has_single_bit(unsigned(Lanes)))
+  struct batch_vector
+  {
+    typedef T type __attribute__((vector_size(Lanes * sizeof(T))));
+  };
+
+  template <class T, int Lanes>
+  using batch_t = typename batch_vector<T, Lanes>::type;
+
+  /// Identify vector extension types.
+  ///
+  /// These are the only non-class, non-pointer, non-array types that support
+  /// subscripting.
+  template <class V>
+  concept is_batch = (std::is_same_v<V, std::remove_cvref_t<V>> and
+                      not std::is_class_v<V> and
+                      not std::is_pointer_v<V> and
+                      not std::is_array_v<V> and
+                      requires (V v) { v[0]; });
+
+  namespace traits
+  {
+    /// Vectors of scalars are scalars, every operation is applied lane-wise.
+    template <is_batch V>
+    struct is_scalar<V> : std::true_type {};
+  }
+
+  /// The number of lanes in a batch scalar.
+  template <is_batch V>
+  constexpr inline int lanes_v = sizeof(V) / sizeof(std::declval<V>()[0]);
+
+  /// A batch of `Lanes` tensors, stored structure-of-arrays.
+  ///
+  /// A batch tensor is a normal tensor whose scalar type is a vector of
+  /// `Lanes` scalars, so element `n` of every tensor in the batch is stored
+  /// contiguously. Binding and assignment use the existing grammar, the
+  /// element loop nest stays outermost and each scalar operation processes
+  /// every lane at once, e.g., evaluating an expression at `Lanes` quadrature
+  /// points.
+  ///
+  ///     TensorBatch<double, 2, 3> A, B, C;
+  ///     C(i,j) = A(i,k) * B(k,j) + 2.0 * A(j,i);
+  ///
+  /// The default number of lanes fills one native vector register.
+  ///
+  /// Scalar literals follow the compiler's vector conversion rules, so they
+  /// must convert to `T` without loss, e.g., `2` is fine with `double` lanes,
+  /// but `float` lanes need `2.f`.
+  ///
+  /// The tensor type is computed by a helper struct because GCC drops the
+  /// vector attribute when a dependent `batch_t` is used directly in an alias
+  /// template.
+  template <class T, int Order, int N, int Lanes>
+  struct batch_tensor
+  {
+    using type = Tensor<batch_t<T, Lanes>, Order, N>;
+  };
+
+  template <class T, int Order, int N, int Lanes = simd_width_v<T>>
+  using TensorBatch = typename batch_tensor<T, Order, N, Lanes>::type;
+
+  /// Extract lane `l` of a batch tensor as a normal tensor.
+  template <class V, int Order, int N, class Layout, auto tag>
+  requires is_batch<V>
+  constexpr auto get_lane(Tensor<V, Order, N, Layout, tag> const& batch, int l)
+  {
+    using T = std::remove_cvref_t<decltype(std::declval<V>()[0])>;
+    Tensor<T, Order, N, Layout> t;
+    for (int n = 0; n < batch.span(); ++n) {
+      t[n] = batch[n][l];
+    }
+    return t;
+  }
+
+  /// Set lane `l` of a batch tensor from a normal tensor.
+  template <class V, int Order, int N, class Layout, auto tag, class T, auto other_tag>
+  requires is_batch<V>
+  constexpr void set_lane(Tensor<V, Order, N, Layout, tag>& batch, int l, Tensor<T, Order, N, Layout, other_tag> const& t)
+  {
+    for (int n = 0; n < batch.span(); ++n) {
+      batch[n][l] = t[n];
+    }
+  }
+}
+
+#endif // ALBERT_INCLUDE_TENSOR_BATCH_HPP
@@ -2,25 +2,97 @@
 #define ALBERT_INCLUDE_TENSOR_LAYOUT_HPP
 
 #include "albert/ScalarIndex.hpp"
+#include "albert/simd.hpp"
+#include "albert/utils.hpp"
 #include <array>
 #include <concepts>
 
 namespace albert
 {
-  template <int Order, int N, bool RowMajor>
+  /// The axis order of a row-major layout, where the last axis is fastest.
+  template <int Order>
+  constexpr auto row_major_axes() -> std::array<int, Order>
+  {
+    std::array<int, Order> axes = {};
+    for (int i = 0; i < Order; ++i) {
+      axes[i] = i;
+    }
+    return axes;
+  }
+
+  /// The axis order of a column-major layout, where the first axis is fastest.
+  template <int Order>
+  constexpr auto column_major_axes() -> std::array<int, Order>
+  {
+    std::array<int, Order> axes = {};
+    for (int i = 0; i < Order; ++i) {
+      axes[i] = Order - i - 1;
+    }
+    return axes;
+  }
+
+  namespace detail
+  {
+    template <std::size_t Order>
+    constexpr bool is_axis_permutation(std::array<int, Order> const& axes)
+    {
+      for (int i = 0; i < int(Order); ++i) {
+        int n = 0;
+        for (int a : axes) {
+          n += (a == i);
+        }
+        if (n != 1) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  /// A strided layout.
+  ///
+  /// The `axes` lists the axes of the tensor from the slowest varying in
+  /// storage to the fastest varying, so row-major is `{0, 1, ...}` and
+  /// column-major is `{..., 1, 0}`. The fastest varying extent can be padded
+  /// to `Ld` elements (the leading dimension), which pads the strides of all of
+  /// the slower axes.
+  ///
+  /// Tensors that own their storage align it to `Align` bytes (0 is the
+  /// natural alignment of the scalar type).
+  ///
+  /// @param Order The order of the tensor.
+  /// @param     N The dimension of the tensor.
+  /// @param  axes The axis permutation, from slowest to fastest.
+  /// @param    Ld The padded extent of the fastest axis.
+  /// @param Align The alignment of the storage, in bytes.
+  template <int Order, int N, std::array<int, Order> _axes, int Ld = N, int Align = 0>
   struct Layout
   {
+    static_assert(Ld >= N, "padded extent must cover the dimension");
+    static_assert(detail::is_axis_permutation(_axes), "axes must be a permutation");
+    static_assert((Align & (Align - 1)) == 0, "alignment must be a power of two");
+
+    constexpr static std::array<int, Order> axes = _axes;
+
+    constexpr static int align = Align;
+
+    /// The stride of each axis (in tensor axis order, not storage order).
     constexpr static std::array<int, Order> stride = [] {
-      std::array<int, Order> stride = {1};
-      for (int i = 0; i < Order - 1; ++i) {
-        stride[i + 1] = stride[i] * N;
-      }
-      if constexpr (RowMajor) {
-        std::reverse(stride.begin(), stride.end());
+      std::array<int, Order> stride = {};
+      int s = 1;
+      for (int i = Order - 1; i >= 0; --i) {
+        stride[axes[i]] = s;
+        s *= (i == Order - 1) ? Ld : N;
       }
       return stride;
     }();
 
+    /// The number of elements needed to store the tensor, including padding.
+    constexpr static int size = (Order == 0) ? 1 : pow(N, Order - 1) * Ld;
+
+    /// Is the storage free of padding.
+    constexpr static bool dense = (size == pow(N, Order));
+
     constexpr auto operator()(ScalarIndex<Order> const& index) const -> int
     {
       int sum = 0;
@@ -31,26 +103,176 @@ namespace albert
     }
   };
 
-  template <int N, bool RowMajor>
-  struct Layout<0, N, RowMajor>
+  template <int Order, int N>
+  using RowMajor = Layout<Order, N, row_major_axes<Order>()>;
+
+  template <int Order, int N>
+  using ColumnMajor = Layout<Order, N, column_major_axes<Order>()>;
+
+  /// Any compile-time axis permutation, from slowest to fastest.
+  template <int Order, int N, std::array<int, Order> axes>
+  using Permuted = Layout<Order, N, axes>;
+
+  /// Row-major with the last axis padded to `Ld` elements.
+  template <int Order, int N, int Ld>
+  using Padded = Layout<Order, N, row_major_axes<Order>(), Ld>;
+
+  namespace detail
   {
-    constexpr auto operator()(ScalarIndex<0> const&) const -> int
+    /// The padded extent of the fastest axis in an `Aligned` layout.
+    ///
+    /// Extents up to a vector are rounded up to a power of two, so that rows
+    /// of small tensors share vectors rather than each using a whole one,
+    /// longer extents are rounded up to whole vectors.
+    template <class T, int N>
+    constexpr int aligned_extent()
     {
-      return 0;
+      constexpr int W = simd_width_v<T>;
+      if (W == 0) {
+        return N;
+      }
+      if (N >= W) {
+        return (N + W - 1) / W * W;
+      }
+      int ld = 1;
+      while (ld < N) {
+        ld *= 2;
+      }
+      return ld;
     }
-  };
+  }
 
-  template <int Order, int N>
-  struct RowMajor : Layout<Order, N, true>
+  /// Row-major with the last axis padded for vector loads, and storage aligned
+  /// to match.
+  ///
+  /// Every row starts on an aligned boundary and the storage is a whole number
+  /// of (possibly narrower than native) vectors, so the streaming kernels (see
+  /// simd.hpp) use aligned loads and stores without a scalar remainder. The
+  /// padding is traded for memory, e.g., a 3x3 matrix of double is stored in
+  /// 12 elements aligned to 32 bytes.
+  template <class T, int Order, int N>
+  using Aligned = Layout<Order, N, row_major_axes<Order>(),
+                         detail::aligned_extent<T, N>(),
+                         (simd_bytes == 0) ? 0 : min(simd_bytes, detail::aligned_extent<T, N>() * sizeof(T))>;
+
+  namespace detail
   {
-    using Layout<Order, N, true>::Layout;
-  };
+    /// The Voigt position of the symmetric pair `(i, j)` in an `N` dimensional
+    /// space.
+    ///
+    /// The diagonal comes first, followed by the off-diagonal pairs in
+    /// descending order, e.g., `00 11 22 12 02 01` in 3D.
+    constexpr int voigt(int N, int i, int j)
+    {
+      if (i == j) {
+        return i;
+      }
+      int a = min(i, j), b = max(i, j);
+      int n = N;
+      for (int c = N - 1; c >= 0; --c) {
+        for (int d = N - 1; d > c; --d) {
+          if (c == a and d == b) {
+            return n;
+          }
+          ++n;
+        }
+      }
+      return n;
+    }
+  }
 
-  template <int Order, int N>
-  struct ColumnMajor : Layout<Order, N, true>
+  /// Packed storage for symmetric tensors.
+  ///
+  /// Order 2 tensors are symmetric in their two axes and store the `N(N+1)/2`
+  /// unique entries in Voigt order (6 in 3D). Order 4 tensors have the minor
+  /// symmetries `ijkl = jikl = ijlk` and store the Voigt matrix `C_IJ`, which
+  /// is itself symmetric (21 entries in 3D) when the tensor also has the
+  /// major symmetry `ijkl = klij`, and full (36 entries in 3D) otherwise.
+  ///
+  /// The entries are the tensor components themselves, i.e., they are not
+  /// scaled like Mandel or engineering strain notation, and kernels that
+  /// visit only the unique entries weight them by their multiplicity instead.
+  ///
+  /// Assignment only evaluates the right-hand-side at the unique entries
+  /// (`unique`), so the result of assigning a non-symmetric expression to
+  /// packed storage is its value at the first equivalent index.
+  ///
+  /// @param Order The order of the tensor (2 or 4).
+  /// @param     N The dimension of the tensor.
+  /// @param Major Does an order 4 tensor have the major symmetry.
+  template <int Order, int N, bool Major = true>
+  struct Symmetric
   {
-    using Layout<Order, N, true>::Layout;
+    static_assert(Order == 2 or Order == 4, "symmetric storage is only for order 2 and 4 tensors");
+
+    constexpr static int M = N * (N + 1) / 2;  //!< number of Voigt indices
+
+    constexpr static std::array<int, Order> axes = row_major_axes<Order>();
+
+    constexpr static int align = 0;
+
+    constexpr static int size = (Order == 2) ? M : Major ? M * (M + 1) / 2 : M * M;
+
+    /// There is no padding.
+    constexpr static bool dense = true;
+
+    /// The pairs of axes that the tensor is symmetric in.
+    constexpr static std::array<std::array<int, 2>, Order / 2> symmetries = [] {
+      std::array<std::array<int, 2>, Order / 2> pairs = {};
+      for (int i = 0; i < Order / 2; ++i) {
+        pairs[i] = { 2 * i, 2 * i + 1 };
+      }
+      return pairs;
+    }();
+
+    /// The storage offset for each index, in row-major order.
+    constexpr static std::array<int, pow(N, Order)> offsets = [] {
+      std::array<int, pow(N, Order)> offsets = {};
+      for (int n = 0; n < pow(N, Order); ++n) {
+        int i[Order] = {};
+        for (int k = Order - 1, m = n; k >= 0; --k, m /= N) {
+          i[k] = m % N;
+        }
+        int I = detail::voigt(N, i[0], i[1]);
+        if constexpr (Order == 2) {
+          offsets[n] = I;
+        }
+        else {
+          int J = detail::voigt(N, i[2], i[3]);
+          offsets[n] = Major ? detail::voigt(M, I, J) : I * M + J;
+        }
+      }
+      return offsets;
+    }();
+
+    /// The first (row-major) index that maps to each storage offset.
+    constexpr static std::array<ScalarIndex<Order>, size> unique = [] {
+      std::array<ScalarIndex<Order>, size> unique = {};
+      std::array<bool, size> found = {};
+      for (int n = 0; n < pow(N, Order); ++n) {
+        if (not found[offsets[n]]) {
+          found[offsets[n]] = true;
+          for (int k = Order - 1, m = n; k >= 0; --k, m /= N) {
+            unique[offsets[n]][k] = m % N;
+          }
+        }
+      }
+      return unique;
+    }();
+
+    constexpr auto operator()(ScalarIndex<Order> const& index) const -> int
+    {
+      int n = 0;
+      for (int i = 0; i < Order; ++i) {
+        n = n * N + index[i];
+      }
+      return offsets[n];
+    }
   };
+
+  /// Order 4 tensors with only the minor symmetries.
+  template <int N>
+  using MinorSymmetric = Symmetric<4, N, false>;
 }
 
 #endif // ALBERT_INCLUDE_TENSOR_LAYOUT_HPP
@@ -5,14 +5,29 @@
 
 namespace albert
 {
-  template <class T, int Order, int N>
+  /// Linear storage for a tensor.
+  ///
+  /// The `Size` can exceed the number of elements in the tensor when the
+  /// layout is padded, and the storage is aligned to `Align` bytes (0 is the
+  /// natural alignment of `T`).
+  template <class T, int Order, int N, int Size = pow(N, Order), int Align = 0>
   struct DenseStorage
   {
-    T _data[pow(N, Order)];
+    alignas(max(Align, alignof(T))) T _data[Size];
 
     constexpr static auto size()
     {
-      return pow(N, Order);
+      return Size;
+    }
+
+    constexpr auto data() const -> T const*
+    {
+      return _data;
+    }
+
+    constexpr auto data() -> T*
+    {
+      return _data;
     }
 
     constexpr auto begin() const
@@ -0,0 +1,159 @@
+#ifndef ALBERT_INCLUDE_TENSOR_VIEW_HPP
+#define ALBERT_INCLUDE_TENSOR_VIEW_HPP
+
+#include "albert/Bind.hpp"
+#include "albert/ScalarIndex.hpp"
+#include "albert/Tensor.hpp"
+#include "albert/TensorLayout.hpp"
+#include "albert/aliasing.hpp"
+#include "albert/concepts.hpp"
+#include "albert/utils.hpp"
+#include <array>
+#include <type_traits>
+
+namespace albert
+{
+  /// A non-owning view of a tensor stored in external memory.
+  ///
+  /// The view wraps a pointer and a stride (in elements) for each dimension,
+  /// and can be bound and used on either side of an assignment, e.g., to
+  /// evaluate directly into a field stored in a mesh data structure.
+  ///
+  ///     double* stress = mesh.field("stress", cell);
+  ///     TensorView<double, 2, 3> sigma(stress);
+  ///     sigma(i,j) = D(i,j,k,l) * epsilon(k,l);
+  ///
+  /// The default strides come from the `Layout`, but any non-negative strides
+  /// can be provided at runtime. Views of `T const` can only be read.
+  ///
+  /// Views don't have a compile-time tag, so aliasing between a view and any
+  /// other leaf is decided at runtime by comparing the address ranges that
+  /// they span.
+  template <class T, int Order, int N, class Layout = RowMajor<Order, N>>
+  struct TensorView : Bindable<TensorView<T, Order, N, Layout>>
+  {
+    using Bindable<TensorView<T, Order, N, Layout>>::operator();
+
+    using scalar_type = std::remove_const_t<T>;
+    using layout_type = Layout;
+
+    T* _data;
+    std::array<int, Order> _stride;
+
+    constexpr TensorView(T* data)
+        : _data(data)
+        , _stride(Layout::stride)
+    {
+    }
+
+    constexpr TensorView(T* data, std::array<int, Order> const& stride)
+        : _data(data)
+        , _stride(stride)
+    {
+    }
+
+    /// View the storage of a tensor.
+    template <auto tag>
+    constexpr TensorView(Tensor<scalar_type, Order, N, Layout, tag>& t) requires (not std::is_const_v<T>)
+        : TensorView(t.data())
+    {
+    }
+
+    template <auto tag>
+    constexpr TensorView(Tensor<scalar_type, Order, N, Layout, tag> const& t) requires (std::is_const_v<T>)
+        : TensorView(t.data())
+    {
+    }
+
+    /// Views are copied shallowly, but assigning a view to a view would be
+    /// ambiguous, bind both sides instead (e.g., `a(i,j) = b(i,j)`).
+    constexpr TensorView(TensorView const&) = default;
+    constexpr auto operator=(TensorView const&) -> TensorView& = delete;
+
+    constexpr static auto tag() -> decltype(auto)
+    {
+      return (view_tag);
+    }
+
+    /// A view may refer to the storage of any leaf.
+    constexpr static bool contains(auto&&)
+    {
+      return true;
+    }
+
+    constexpr static bool may_alias(auto&&)
+    {
+      return false;
+    }
+
+    constexpr static auto size()
+      -> int
+    {
+      return pow(N, Order);
+    }
+
+    constexpr static auto order()
+      -> int
+    {
+      return Order;
+    }
+
+    constexpr static auto dim()
+      -> int
+    {
+      return N;
+    }
+
+    /// Pointer to the first element.
+    constexpr auto data() const -> T*
+    {
+      return _data;
+    }
+
+    /// The number of elements spanned by the view, from the first to the last.
+    constexpr auto span() const
+      -> int
+    {
+      int span = 1;
+      for (int s : _stride) {
+        span += (N - 1) * s;
+      }
+      return span;
+    }
+
+    constexpr auto stride() const -> std::array<int, Order> const&
+    {
+      return _stride;
+    }
+
+    template <is_expression B>
+    constexpr auto operator=(B&& b) const
+      -> TensorView const&
+    {
+      static_assert(order_v<B> == Order, "expression order does not match");
+      TensorView view = *this;
+      Bind(view, {}, nttp<outer_v<B>>) = FWD(b);
+      return *this;
+    }
+
+    /// Multidimensional indexing via aggregate.
+    constexpr auto evaluate(ScalarIndex<Order> const& index) const
+      -> T&
+    {
+      int offset = 0;
+      for (int i = 0; i < Order; ++i) {
+        offset += index[i] * _stride[i];
+      }
+      return _data[offset];
+    }
+
+  };
+
+  template <class T, int Order, int N, class Layout, auto tag>
+  TensorView(Tensor<T, Order, N, Layout, tag>&) -> TensorView<T, Order, N, Layout>;
+
+  template <class T, int Order, int N, class Layout, auto tag>
+  TensorView(Tensor<T, Order, N, Layout, tag> const&) -> TensorView<T const, Order, N, Layout>;
+}
+
+#endif // ALBERT_INCLUDE_TENSOR_VIEW_HPP
@@ -0,0 +1,514 @@
+#ifndef ALBERT_INCLUDE_AD_HPP
+#define ALBERT_INCLUDE_AD_HPP
+
+#include "albert/Tensor.hpp"
+#include "albert/concepts.hpp"
+#include "albert/evaluate.hpp"
+#include "albert/utils.hpp"
+#include <cmath>
+#include <compare>
+#include <concepts>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/// Reverse mode automatic differentiation.
+///
+/// A `Var<T>` is a scalar that records each operation that it takes part in
+/// on a `Tape<T>`. Once a scalar objective has been computed, a single pass
+/// backwards over the tape accumulates its derivatives with respect to every
+/// variable, so the gradient of an energy with respect to an order 4 tensor
+/// costs a small multiple of the energy itself, rather than the 81 lanes of
+/// derivatives that each forward mode `Dual` operation carries.
+///
+///     ad::Tape<double> tape;
+///     Tensor g = ad::gradient(tape, [](auto const& E) {
+///       return E(i,j) * E(i,j) + albert::log(albert::det(E));
+///     }, E);
+///
+/// `Var`s are scalars (see `traits::is_scalar`), so they are recorded by the
+/// existing expression nodes and solvers without any changes.
+namespace albert::ad
+{
+  /// A bump allocator for the tape's nodes.
+  ///
+  /// Nodes are pushed onto fixed-size chunks and addressed by their position,
+  /// which is also the order in which the backward pass visits them. Resetting
+  /// the arena keeps its chunks, so once it has grown to the size of an
+  /// evaluation, recording allocates nothing.
+  template <class Node, int Chunk = 4096>
+  requires (Chunk > 0)
+  class Arena
+  {
+    std::vector<std::unique_ptr<Node[]>> _chunks;
+    int _size = 0;
+
+    /// Growing is rare, and is kept out of line.
+    [[gnu::noinline, gnu::cold]]
+    void grow()
+    {
+      _chunks.push_back(std::make_unique_for_overwrite<Node[]>(Chunk));
+    }
+
+  public:
+    /// Append a node, returning its position.
+    auto push(Node const& node) -> int
+    {
+      if (_size == capacity()) {
+        grow();
+      }
+      int n = _size++;
+      (*this)[n] = node;
+      return n;
+    }
+
+    auto operator[](int n) -> Node&
+    {
+      return _chunks[n / Chunk][n % Chunk];
+    }
+
+    auto operator[](int n) const -> Node const&
+    {
+      return _chunks[n / Chunk][n % Chunk];
+    }
+
+    auto size() const -> int
+    {
+      return _size;
+    }
+
+    auto capacity() const -> int
+    {
+      return int(_chunks.size()) * Chunk;
+    }
+
+    /// Discard every node, keeping the memory.
+    void reset()
+    {
+      _size = 0;
+    }
+  };
+
+  template <std::floating_point T>
+  struct Var;
+
+  /// The record of a computation.
+  ///
+  /// Each node is the result of an operation with (up to) two operands, and
+  /// stores the partial derivatives of the result with respect to them, along
+  /// with the adjoint that is accumulated in the backward pass. Variables are
+  /// nodes without operands.
+  template <std::floating_point T>
+  class Tape
+  {
+    struct Node
+    {
+      T adjoint;
+      T da;
+      T db;
+      int a;
+      int b;
+    };
+
+    Arena<Node> _nodes;
+
+  public:
+    Tape() = default;
+
+    /// `Var`s refer to their tape, so it can't move.
+    Tape(Tape const&) = delete;
+    auto operator=(Tape const&) -> Tape& = delete;
+
+    /// A new independent variable, with the value `v`.
+    auto variable(T v) -> Var<T>
+    {
+      return { v, push(-1, T(0), -1, T(0)), this };
+    }
+
+    /// Record an operation, with the operands `a` and `b` (or -1).
+    ///
+    /// Unrolled expressions record hundreds of operations in a single
+    /// function, which are smaller and faster as calls.
+    [[gnu::noinline]]
+    auto push(int a, T da, int b, T db) -> int
+    {
+      return _nodes.push({ T(0), da, db, a, b });
+    }
+
+    auto size() const -> int
+    {
+      return _nodes.size();
+    }
+
+    /// Discard the recording, keeping the memory.
+    void reset()
+    {
+      _nodes.reset();
+    }
+
+    /// Accumulate the derivatives of `y` into the adjoints of every node that
+    /// it depends on.
+    ///
+    /// The adjoints accumulate, so a recording should only be propagated once.
+    void backward(Var<T> const& y)
+    {
+      if (y.tape != this) {
+        return;
+      }
+
+      _nodes[y.n].adjoint += T(1);
+      for (int n = y.n; n >= 0; --n) {
+        Node const& node = _nodes[n];
+        if (node.adjoint == T(0)) {
+          continue;
+        }
+        if (node.a >= 0) {
+          _nodes[node.a].adjoint += node.da * node.adjoint;
+        }
+        if (node.b >= 0) {
+          _nodes[node.b].adjoint += node.db * node.adjoint;
+        }
+      }
+    }
+
+    /// The derivative of the last propagated objective with respect to `x`.
+    auto adjoint(Var<T> const& x) const -> T
+    {
+      return (x.tape == this) ? _nodes[x.n].adjoint : T(0);
+    }
+  };
+
+  /// A scalar that records its computation.
+  ///
+  /// Constants, including default constructed `Var`s, are not recorded, and
+  /// neither are operations that only involve constants, or adding
+  /// constants.
+  template <std::floating_point T>
+  struct Var
+  {
+    T v = {};
+    int n = -1;
+    Tape<T>* tape = nullptr;
+
+    constexpr Var() = default;
+
+    /// A constant.
+    constexpr Var(T v)
+        : v(v)
+    {
+    }
+
+    constexpr Var(T v, int n, Tape<T>* tape)
+        : v(v)
+        , n(n)
+        , tape(tape)
+    {
+    }
+
+    constexpr auto value() const -> T
+    {
+      return v;
+    }
+
+    /// The var `f(x)`, given `f(x)` and `f'(x)`.
+    friend auto chain(T f, T df, Var const& x) -> Var
+    {
+      if (not x.tape) {
+        return f;
+      }
+      return { f, x.tape->push(x.n, df, -1, T(0)), x.tape };
+    }
+
+    /// The var `f(x, y)`, given `f(x, y)` and its partial derivatives.
+    friend auto chain(T f, T dx, Var const& x, T dy, Var const& y) -> Var
+    {
+      if (not y.tape) {
+        return chain(f, dx, x);
+      }
+      if (not x.tape) {
+        return chain(f, dy, y);
+      }
+      return { f, x.tape->push(x.n, dx, y.n, dy), x.tape };
+    }
+
+    auto operator+=(Var const& b) -> Var&
+    {
+      return *this = *this + b;
+    }
+
+    auto operator-=(Var const& b) -> Var&
+    {
+      return *this = *this - b;
+    }
+
+    auto operator*=(Var const& b) -> Var&
+    {
+      return *this = *this * b;
+    }
+
+    auto operator/=(Var const& b) -> Var&
+    {
+      return *this = *this / b;
+    }
+
+    /// Arithmetic. The operators take their operands by value, so that they
+    /// are preferred over the expression grammar's forwarding templates.
+    /// @{
+    friend auto operator+(Var a) -> Var
+    {
+      return a;
+    }
+
+    friend auto operator-(Var a) -> Var
+    {
+      return chain(-a.v, T(-1), a);
+    }
+
+    friend auto operator+(Var a, Var const& b) -> Var
+    {
+      return chain(a.v + b.v, T(1), a, T(1), b);
+    }
+
+    friend auto operator-(Var a, Var const& b) -> Var
+    {
+      return chain(a.v - b.v, T(1), a, T(-1), b);
+    }
+
+    friend auto operator*(Var a, Var const& b) -> Var
+    {
+      return chain(a.v * b.v, b.v, a, a.v, b);
+    }
+
+    friend auto operator/(Var a, Var const& b) -> Var
+    {
+      T r = T(1) / b.v;
+      T q = a.v * r;
+      return chain(q, r, a, -q * r, b);
+    }
+
+    // Adding a constant doesn't change the derivatives, so the result shares
+    // its node with the variable.
+    friend auto operator+(Var a, T b) -> Var { return { a.v + b, a.n, a.tape }; }
+    friend auto operator-(Var a, T b) -> Var { return { a.v - b, a.n, a.tape }; }
+    friend auto operator*(Var a, T b) -> Var { return chain(a.v * b, b, a); }
+    friend auto operator/(Var a, T b) -> Var { return chain(a.v / b, T(1) / b, a); }
+
+    friend auto operator+(T a, Var b) -> Var { return b + a; }
+    friend auto operator-(T a, Var b) -> Var { return chain(a - b.v, T(-1), b); }
+    friend auto operator*(T a, Var b) -> Var { return b * a; }
+    friend auto operator/(T a, Var b) -> Var { return Var(a) / b; }
+    /// @}
+
+    /// Comparisons of the values.
+    /// @{
+    constexpr friend auto operator==(Var const& a, Var const& b) -> bool { return a.v == b.v; }
+    constexpr friend auto operator==(Var const& a, T b) -> bool { return a.v == b; }
+    constexpr friend auto operator<=>(Var const& a, Var const& b) { return a.v <=> b.v; }
+    constexpr friend auto operator<=>(Var const& a, T b) { return a.v <=> b; }
+    /// @}
+
+    /// The elementary functions, found by argument dependent lookup in the
+    /// same way as the cmath overloads for the floating point types.
+    /// @{
+    friend auto abs(Var x) -> Var
+    {
+      return (x.v < T(0)) ? -x : x;
+    }
+
+    friend auto fabs(Var x) -> Var
+    {
+      return abs(x);
+    }
+
+    friend auto sqrt(Var x) -> Var
+    {
+      T s = std::sqrt(x.v);
+      return chain(s, T(0.5) / s, x);
+    }
+
+    friend auto cbrt(Var x) -> Var
+    {
+      T c = std::cbrt(x.v);
+      return chain(c, T(1) / (3 * c * c), x);
+    }
+
+    friend auto exp(Var x) -> Var
+    {
+      T e = std::exp(x.v);
+      return chain(e, e, x);
+    }
+
+    friend auto log(Var x) -> Var
+    {
+      return chain(std::log(x.v), T(1) / x.v, x);
+    }
+
+    friend auto pow(Var a, Var b) -> Var
+    {
+      T p = std::pow(a.v, b.v);
+      T da = (b.v == T(0)) ? T(0) : b.v * std::pow(a.v, b.v - T(1));
+      T db = (a.v == T(0)) ? T(0) : p * std::log(a.v);
+      return chain(p, da, a, db, b);
+    }
+
+    friend auto pow(Var a, T b) -> Var
+    {
+      T da = (b == T(0)) ? T(0) : b * std::pow(a.v, b - T(1));
+      return chain(std::pow(a.v, b), da, a);
+    }
+
+    friend auto pow(T a, Var b) -> Var
+    {
+      T p = std::pow(a, b.v);
+      return chain(p, (a == T(0)) ? T(0) : p * std::log(a), b);
+    }
+
+    friend auto sin(Var x) -> Var
+    {
+      return chain(std::sin(x.v), std::cos(x.v), x);
+    }
+
+    friend auto cos(Var x) -> Var
+    {
+      return chain(std::cos(x.v), -std::sin(x.v), x);
+    }
+
+    friend auto tan(Var x) -> Var
+    {
+      T t = std::tan(x.v);
+      return chain(t, 1 + t * t, x);
+    }
+
+    friend auto asin(Var x) -> Var
+    {
+      return chain(std::asin(x.v), 1 / std::sqrt(1 - x.v * x.v), x);
+    }
+
+    friend auto acos(Var x) -> Var
+    {
+      return chain(std::acos(x.v), -1 / std::sqrt(1 - x.v * x.v), x);
+    }
+
+    friend auto atan(Var x) -> Var
+    {
+      return chain(std::atan(x.v), 1 / (1 + x.v * x.v), x);
+    }
+
+    friend auto atan2(Var y, Var x) -> Var
+    {
+      T r = 1 / (x.v * x.v + y.v * y.v);
+      return chain(std::atan2(y.v, x.v), x.v * r, y, -y.v * r, x);
+    }
+
+    friend auto sinh(Var x) -> Var
+    {
+      return chain(std::sinh(x.v), std::cosh(x.v), x);
+    }
+
+    friend auto cosh(Var x) -> Var
+    {
+      return chain(std::cosh(x.v), std::sinh(x.v), x);
+    }
+
+    friend auto tanh(Var x) -> Var
+    {
+      T t = std::tanh(x.v);
+      return chain(t, 1 - t * t, x);
+    }
+
+    friend auto asinh(Var x) -> Var
+    {
+      return chain(std::asinh(x.v), 1 / std::sqrt(x.v * x.v + 1), x);
+    }
+
+    friend auto acosh(Var x) -> Var
+    {
+      return chain(std::acosh(x.v), 1 / std::sqrt(x.v * x.v - 1), x);
+    }
+
+    friend auto atanh(Var x) -> Var
+    {
+      return chain(std::atanh(x.v), 1 / (1 - x.v * x.v), x);
+    }
+
+    friend auto fmin(Var a, Var b) -> Var
+    {
+      return (b.v < a.v or a.v != a.v) ? b : a;
+    }
+
+    friend auto fmax(Var a, Var b) -> Var
+    {
+      return (b.v > a.v or a.v != a.v) ? b : a;
+    }
+
+    friend auto ceil(Var x) -> Var
+    {
+      return Var(std::ceil(x.v));
+    }
+
+    friend auto floor(Var x) -> Var
+    {
+      return Var(std::floor(x.v));
+    }
+    /// @}
+  };
+
+  /// The gradient of a scalar function of a tensor, in one evaluation and one
+  /// backward pass.
+  ///
+  /// The tape is reset, the function `f` is called once with a copy of `x`
+  /// whose elements are variables on the tape, and returns a `Var` (or an
+  /// order 0 expression of `Var`s). The result has the type of `x`, e.g., the
+  /// gradient of an energy `W(E)` is `∂W/∂E(k,l)`.
+  template <is_tensor X>
+  auto gradient(Tape<scalar_type_t<X>>& tape, auto&& f, X const& x)
+  {
+    using T = scalar_type_t<X>;
+    constexpr int R = order_v<X>;
+    constexpr int N = dim_v<X>;
+    constexpr int K = pow(N, R);
+
+    tape.reset();
+
+    Tensor<Var<T>, R, N> v;
+    for (int m = 0; m < K; ++m) {
+      v[m] = tape.variable(x.evaluate(detail::unravel<R, N>(m)));
+    }
+
+    Var<T> const y = f(v);
+    tape.backward(y);
+
+    Tensor<T, R, N> g;
+    for (int m = 0; m < K; ++m) {
+      g[m] = tape.adjoint(v[m]);
+    }
+    return g;
+  }
+
+  /// The gradient of a scalar function of a tensor, recorded on a tape that
+  /// is reused by each call from the same thread.
+  template <is_tensor X>
+  auto gradient(auto&& f, X const& x)
+  {
+    thread_local Tape<scalar_type_t<X>> tape;
+    return gradient(tape, FWD(f), x);
+  }
+}
+
+namespace albert::traits
+{
+  /// Vars are scalars.
+  template <class T>
+  struct is_scalar<ad::Var<T>> : std::true_type {};
+}
+
+namespace std
+{
+  template <class T>
+  struct numeric_limits<albert::ad::Var<T>> : numeric_limits<T>
+  {
+  };
+}
+
+#endif // ALBERT_INCLUDE_AD_HPP
@@ -1,6 +1,14 @@
 #ifndef ALBERT_INCLUDE_ALBERT_HPP
 #define ALBERT_INCLUDE_ALBERT_HPP
 
+#include "albert/Dual.hpp"
+#include "albert/ad.hpp"
+#include "albert/TensorBatch.hpp"
+#include "albert/TensorView.hpp"
+#include "albert/batch_solver.hpp"
+#include "albert/flops.hpp"
+#include "albert/fuse.hpp"
 #include "albert/grammar.hpp"
+#include "albert/parallel.hpp"
 
 #endif // ALBERT_INCLUDE_ALBERT_HPP
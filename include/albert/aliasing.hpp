@@ -0,0 +1,280 @@
+#ifndef ALBERT_INCLUDE_ALIASING_HPP
+#define ALBERT_INCLUDE_ALIASING_HPP
+
+#include "albert/TensorIndex.hpp"
+#include "albert/concepts.hpp"
+#include "albert/utils.hpp"
+#include <cstdint>
+#include <type_traits>
+
+namespace albert
+{
+  /// The tag reported by views of external memory.
+  ///
+  /// Compile-time aliasing analysis is based on tensor tags, but a view can
+  /// refer to any memory, including the storage of a tensor. Views report this
+  /// tag, every leaf claims to contain it, and views claim to contain every
+  /// tag. The conservative static result is refined at runtime by `overlaps`.
+  struct view_tag_t {};
+  constexpr inline view_tag_t view_tag = {};
+
+  template <class Tag>
+  constexpr inline bool is_view_tag_v = std::is_same_v<std::remove_cvref_t<Tag>, view_tag_t>;
+
+  namespace detail
+  {
+    /// A tag that only views claim to contain, used to find views in a tree.
+    struct view_probe_t {};
+    constexpr inline view_probe_t view_probe = {};
+
+    /// Visit every leaf in an expression tree that references storage.
+    ///
+    /// Leaves are identified by `data()` and `span()`, interior nodes by their
+    /// `a` and `b` subtrees.
+    template <class E>
+    void for_each_storage(E const& e, auto&& f)
+    {
+      if constexpr (requires { e.data(); e.span(); }) {
+        f(e);
+      }
+      if constexpr (requires { { e.a } -> is_tensor; }) {
+        for_each_storage(e.a, f);
+      }
+      if constexpr (requires { { e.b } -> is_tensor; }) {
+        for_each_storage(e.b, f);
+      }
+    }
+
+    template <class A, class B>
+    auto overlaps(A const& a, B const& b) -> bool
+    {
+      auto alo = reinterpret_cast<std::uintptr_t>(a.data());
+      auto ahi = reinterpret_cast<std::uintptr_t>(a.data() + a.span());
+      auto blo = reinterpret_cast<std::uintptr_t>(b.data());
+      auto bhi = reinterpret_cast<std::uintptr_t>(b.data() + b.span());
+      return alo < bhi and blo < ahi;
+    }
+
+    /// Check if two leaves map every index to the same element.
+    template <class A, class B>
+    auto same_storage(A const& a, B const& b) -> bool
+    {
+      if constexpr (not std::is_same_v<A, B>) {
+        return false;
+      }
+      else if constexpr (requires { a.stride(); }) {
+        return a.data() == b.data() and a.stride() == b.stride();
+      }
+      else {
+        return a.data() == b.data();
+      }
+    }
+  }
+
+  /// Check if any storage referenced by `a` overlaps storage referenced by `b`.
+  ///
+  /// This is only used at runtime, to refine the static aliasing analysis.
+  template <class A, class B>
+  auto overlaps(A const& a, B const& b) -> bool
+  {
+    bool overlap = false;
+    detail::for_each_storage(a, [&](auto const& x) {
+      detail::for_each_storage(b, [&](auto const& y) {
+        overlap |= detail::overlaps(x, y);
+      });
+    });
+    return overlap;
+  }
+
+  /// Check if storage referenced by `a` overlaps storage referenced by `b`
+  /// through a different mapping.
+  ///
+  /// Elementwise expressions can be evaluated in place when every overlapping
+  /// leaf is the same storage, as element `i` is read before it is written,
+  /// but not when it is shifted (e.g., overlapping windows into one array).
+  template <class A, class B>
+  auto overlaps_shifted(A const& a, B const& b) -> bool
+  {
+    bool overlap = false;
+    detail::for_each_storage(a, [&](auto const& x) {
+      detail::for_each_storage(b, [&](auto const& y) {
+        overlap |= (detail::overlaps(x, y) and not detail::same_storage(x, y));
+      });
+    });
+    return overlap;
+  }
+
+  /// How evaluating the right-hand-side of an assignment in place reads the
+  /// storage of the left-hand-side.
+  ///
+  /// Assignments write the left-hand-side in its storage order. A read is
+  /// `pointwise` when it is of the element being written, `row` when it is of
+  /// the row being written (i.e., the same index along the slowest varying
+  /// axis of storage), and `shifted` otherwise. Pointwise reads are evaluated
+  /// in place, row reads through a temporary for one row at a time, and only
+  /// shifted reads need a temporary for the whole left-hand-side.
+  enum class Access { pointwise, row, shifted };
+
+  constexpr auto max(Access a, Access b) -> Access
+  {
+    return (a < b) ? b : a;
+  }
+
+  /// Which elements of its children a node reads to evaluate one element.
+  ///
+  /// Most nodes read their children at the values of the index characters
+  /// that they are evaluated at, apart from the `contracted` characters that
+  /// they sum over, e.g., `A(i,j) + B(j,i)` reads `A` and `B` at its own `i`
+  /// and `j`, and `A(i,k) * B(k,j)` reads them at its own `i` and `j` and
+  /// every `k`. These nodes specialize this template (see `local_dependence`),
+  /// the default may read any element of its children.
+  template <class E>
+  struct dependence
+  {
+    constexpr static bool local = false;
+  };
+
+  template <TensorIndex inner = TensorIndex<0>{}>
+  struct local_dependence
+  {
+    constexpr static bool local = true;
+    constexpr static TensorIndex contracted = inner;
+  };
+
+  namespace detail
+  {
+    template <class E>
+    using child_t = std::remove_cvref_t<decltype(std::declval<E const&>().a)>;
+
+    /// Binds of storage, the leaves that `for_each_storage` visits.
+    template <class E>
+    constexpr inline bool is_storage_bind_v = requires (E const& e) { e.a.data(); e.a.span(); };
+
+    /// The character bound to the slowest varying axis of the left-hand-side
+    /// `L`'s storage, or 0 if it doesn't have rows (e.g., packed storage).
+    template <class L>
+    constexpr inline char row_v = [] {
+      using S = child_t<L>;
+      if constexpr (order_v<L> == 0 or order_v<L> != order_v<S> or
+                    not requires { S::layout_type::axes; } or
+                    requires { S::layout_type::unique; }) {
+        return '\0';
+      }
+      else {
+        return outer_v<L>[S::layout_type::axes[0]];
+      }
+    }();
+
+    /// The characters that carry the index of the element being written.
+    ///
+    /// Elements of projected left-hand-sides aren't identified by their outer
+    /// index alone, so none of their reads are pointwise.
+    template <class L>
+    constexpr inline TensorIndex bound_v = [] {
+      using S = child_t<L>;
+      return (order_v<L> == order_v<S>) ? outer_v<L> : decltype(outer_v<L>){};
+    }();
+
+    /// The access of the leaf bind `E` to the left-hand-side `L`'s storage,
+    /// when `E` is read at the values of the `bound` characters.
+    template <class E, class L, TensorIndex bound>
+    constexpr auto leaf_access() -> Access
+    {
+      using S = child_t<E>;
+      constexpr TensorIndex index = outer_v<E>;
+      constexpr char row = row_v<L>;
+      if constexpr (order_v<E> != order_v<S>) {
+        return Access::shifted;
+      }
+      else if constexpr (index == outer_v<L> and (index - bound).size() == 0) {
+        return Access::pointwise;
+      }
+      else if constexpr (row != '\0' and order_v<S> != 0 and requires { S::layout_type::axes; }) {
+        constexpr char c = index[S::layout_type::axes[0]];
+        return (c == row and bound.count(c)) ? Access::row : Access::shifted;
+      }
+      else {
+        return Access::shifted;
+      }
+    }
+
+    /// The worst access of the tree rooted at `E` to storage that may be the
+    /// left-hand-side `L`'s.
+    template <class E, class L, TensorIndex bound>
+    constexpr inline Access access_v = [] {
+      using T = std::remove_cvref_t<E>;
+      if constexpr (not T::contains(L::tag())) {
+        return Access::pointwise;
+      }
+      else if constexpr (is_storage_bind_v<T>) {
+        return leaf_access<T, L, bound>();
+      }
+      else if constexpr (dependence<T>::local) {
+        constexpr TensorIndex fixed = bound - dependence<T>::contracted;
+        Access access = access_v<child_t<T>, L, fixed>;
+        if constexpr (requires (T const& e) { { e.b } -> is_tensor; }) {
+          access = max(access, access_v<decltype(std::declval<T const&>().b), L, fixed>);
+        }
+        return access;
+      }
+      else {
+        return Access::shifted;
+      }
+    }();
+
+    /// Visit each leaf of storage in `e` that may be the left-hand-side `L`'s,
+    /// with its static access.
+    template <class L, TensorIndex bound>
+    void for_each_access(auto const& e, auto&& f)
+    {
+      using T = std::remove_cvref_t<decltype(e)>;
+      if constexpr (not T::contains(L::tag())) {
+        return;
+      }
+      else if constexpr (is_storage_bind_v<T>) {
+        f(e.a, leaf_access<T, L, bound>());
+      }
+      else if constexpr (dependence<T>::local) {
+        constexpr TensorIndex fixed = bound - dependence<T>::contracted;
+        for_each_access<L, fixed>(e.a, f);
+        if constexpr (requires { { e.b } -> is_tensor; }) {
+          for_each_access<L, fixed>(e.b, f);
+        }
+      }
+      else {
+        for_each_storage(e, [&](auto const& x) {
+          f(x, Access::shifted);
+        });
+      }
+    }
+  }
+
+  /// The static access of `B` to the storage of the left-hand-side `A`.
+  ///
+  /// This is conservative, it only knows which leaves may be `A`'s storage
+  /// (e.g., a different tensor of the same type, or a view).
+  template <class A, class B>
+  constexpr inline Access access_v = detail::access_v<B, std::remove_cvref_t<A>, detail::bound_v<std::remove_cvref_t<A>>>;
+
+  /// The access of `b` to the storage of the left-hand-side `a`.
+  ///
+  /// This refines `access_v` at runtime. Leaves that don't overlap `a` aren't
+  /// read from it, and leaves that overlap it are only read pointwise or by
+  /// row when they map every index to the same element.
+  template <class A, class B>
+  auto access(A const& a, B const& b) -> Access
+  {
+    using L = std::remove_cvref_t<A>;
+    Access access = Access::pointwise;
+    detail::for_each_access<L, detail::bound_v<L>>(b, [&](auto const& y, Access leaf) {
+      detail::for_each_storage(a, [&](auto const& x) {
+        if (detail::overlaps(x, y)) {
+          access = max(access, detail::same_storage(x, y) ? leaf : Access::shifted);
+        }
+      });
+    });
+    return access;
+  }
+}
+
+#endif // ALBERT_INCLUDE_ALIASING_HPP
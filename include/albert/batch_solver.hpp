@@ -0,0 +1,283 @@
+#ifndef ALBERT_INCLUDE_BATCH_SOLVER_HPP
+#define ALBERT_INCLUDE_BATCH_SOLVER_HPP
+
+#include "albert/TensorBatch.hpp"
+#include "albert/simd.hpp"
+#include "albert/solver.hpp"
+#include "albert/utils.hpp"
+#include <type_traits>
+
+/// Factor and solve many small independent systems at once.
+///
+/// The batched kernels mirror `lu_kij_pp` and `solve`, but each element
+/// accessed through `A(i,j)` is a vector of independent systems (e.g., the
+/// scalar type of a `TensorBatch`). Every operation processes all of the
+/// lanes, and pivoting is done with lane-wise blends rather than branches, so
+/// each system picks its own pivot rows without divergence.
+///
+/// Singular systems produce non-finite values in their own lanes and report
+/// their row in the returned codes, they don't affect the other lanes.
+namespace albert::solver
+{
+  namespace detail
+  {
+    /// The lane-wise mask (and integer) vector type for a batch vector.
+    template <class V>
+    using batch_mask_t = decltype(std::declval<V>() < std::declval<V>());
+
+    template <class V>
+    constexpr auto magnitude(V const& x) -> V
+    {
+      return (x < 0) ? -x : x;
+    }
+
+    /// Swap `a` and `b` in the lanes selected by `mask`.
+    template <class V, class I>
+    constexpr void swap_lanes(V& a, V& b, I const& mask)
+    {
+      V t = a;
+      a = mask ? b : a;
+      b = mask ? t : b;
+    }
+  }
+
+  /// Run the pivoting algorithm on a batch of matrices.
+  ///
+  /// @tparam           M The size of the matrices.
+  ///
+  /// @param[in/out]    A The batch to pivot, `A(i,j)` is a vector.
+  /// @param[out]    perm The permutation, `perm(i)` is a vector with the same
+  ///                     number of lanes as `A(i,j)`.
+  /// @param[in]        j The column that we are processing.
+  ///
+  /// @returns            The row index that each lane swapped.
+  template <int M>
+  constexpr auto batch_pivot(auto&& A, auto&& perm, int j)
+  {
+    using V = std::remove_cvref_t<decltype(A(0,0))>;
+    using I = detail::batch_mask_t<V>;
+
+    // Find the maximum magnitude in column j in each lane.
+    V max = detail::magnitude(A(j,j));
+    I row = I{} + j;
+    for (int ii = j + 1; ii < M; ++ii) {
+      V a = detail::magnitude(A(ii,j));
+      I mask = a > max;
+      max = mask ? a : max;
+      row = mask ? I{} + ii : row;
+    }
+
+    // Swap the rows in the lanes that chose them.
+    for (int ii = j + 1; ii < M; ++ii) {
+      I mask = (row == ii);
+      for (int jj = 0; jj < M; ++jj) {
+        detail::swap_lanes(A(j,jj), A(ii,jj), mask);
+      }
+      detail::swap_lanes(perm(j), perm(ii), mask);
+    }
+
+    return row;
+  }
+
+  /// Factor a batch of matrices.
+  ///
+  /// @tparam           M The size of the matrices.
+  ///
+  /// @param[in/out]    A The batch to factor, `A(i,j)` is a vector.
+  /// @param[out]    perm The permutation, `perm(i)` is a vector with the same
+  ///                     number of lanes as `A(i,j)`.
+  ///
+  /// @returns            A vector of codes, 0 in the lanes that succeeded and
+  ///                     the 1-based row of the first zero pivot in the lanes
+  ///                     that would have divided by zero.
+  template <int M>
+  constexpr auto batch_lu(auto&& A, auto&& perm)
+  {
+    using V = std::remove_cvref_t<decltype(A(0,0))>;
+    using I = detail::batch_mask_t<V>;
+
+    for (int k = 0; k < M - 1; ++k) {
+      batch_pivot<M>(A, perm, k);
+      for (int i = k + 1; i < M; ++i) {
+        V z = A(i, k) /= A(k, k);
+        for (int j = k + 1; j < M; ++j) {
+          A(i, j) -= z * A(k, j);
+        }
+      }
+    }
+
+    I e = {};
+    for (int i = 0; i < M; ++i) {
+      e = ((e == 0) & (A(i, i) == 0)) ? I{} + (i + 1) : e;
+    }
+    return e;
+  }
+
+  /// Solve a batch of systems.
+  ///
+  /// This factors each matrix in `A`, permutes `b`, and performs the lower and
+  /// upper substitution, as with `solve`. The result is returned in `b`.
+  ///
+  /// @tparam           M The size of the matrices and vectors.
+  ///
+  /// @param[in/out]    A The batch of matrices, will be factored.
+  /// @param[in/out]    b The batch of vectors, will be written with the
+  ///                     solutions.
+  ///
+  /// @returns            The codes from `batch_lu`.
+  template <int M>
+  constexpr auto batch_solve(auto&& A, auto&& b)
+  {
+    auto e = batch_lu<M>(A, b);
+
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < i; ++j) {
+        b(i) -= A(i, j) * b(j);
+      }
+    }
+
+    for (int i = M - 1; i >= 0; --i) {
+      for (int j = i + 1; j < M; ++j) {
+        b(i) -= A(i, j) * b(j);
+      }
+      b(i) /= A(i, i);
+    }
+
+    return e;
+  }
+
+  /// Compute the eigenvalues and eigenvectors of a batch of symmetric 3x3
+  /// matrices.
+  ///
+  /// All of the lanes run the closed-form method from `eigh<3>` together. The
+  /// lanes that are too close to degenerate for it are then redone one at a
+  /// time with `jacobi_eigh`, so the cost of the fallback is only paid where
+  /// it is needed.
+  ///
+  /// @tparam           M The size of the matrices, must be 3.
+  ///
+  /// @param[in]        A The batch of matrices, `A(i,j)` is a vector.
+  /// @param[out]       w The eigenvalues, `w(i)` is a vector.
+  /// @param[out]       V The eigenvectors, `V(i,k)` is a vector.
+  ///
+  /// @returns            A vector of codes, as for `jacobi_eigh` in each lane.
+  template <int M>
+  constexpr auto batch_eigh(auto&& A, auto&& w, auto&& V)
+  {
+    static_assert(M == 3, "batch_eigh is only implemented for 3x3 matrices");
+
+    using V_ = std::remove_cvref_t<decltype(A(0,0))>;
+    using I = detail::batch_mask_t<V_>;
+    constexpr int N = sizeof(V_) / sizeof(A(0,0)[0]);
+
+    V_ a[3][3], e[3], v[3][3];
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        a[i][j] = A(i, j);
+      }
+    }
+
+    I fallback = detail::eigh3(a, e, v);
+
+    I codes = {};
+    for (int l = 0; l < N; ++l) {
+      if (fallback[l]) {
+        codes[l] = jacobi_eigh<3>(
+            [&](int i, int j) { return a[i][j][l]; },
+            [&](int i) -> decltype(auto) { return e[i][l]; },
+            [&](int i, int j) -> decltype(auto) { return v[i][j][l]; });
+      }
+    }
+
+    for (int i = 0; i < 3; ++i) {
+      w(i) = e[i];
+      for (int j = 0; j < 3; ++j) {
+        V(i, j) = v[i][j];
+      }
+    }
+    return codes;
+  }
+
+  /// Solve `K` systems stored interleaved in memory.
+  ///
+  /// Element `(i,j)` of system `s` is stored at `A[(i * M + j) * K + s]` and
+  /// element `i` of its right-hand-side at `b[i * K + s]`, i.e., the storage of
+  /// a `TensorBatch` with `K` lanes. Systems are loaded one native vector at a
+  /// time and solved with `batch_solve`. A remainder is padded with identity
+  /// systems.
+  ///
+  /// @tparam           M The size of the matrices and vectors.
+  ///
+  /// @param[in/out]    A The matrices, will be overwritten with their factors.
+  /// @param[in/out]    b The vectors, will be written with the solutions.
+  /// @param[out]    info The code for each system, as for `solve`.
+  /// @param[in]        K The number of systems.
+  ///
+  /// @returns            The number of singular systems.
+  template <int M, class T>
+  auto solve_interleaved(T* A, T* b, int* info, int K) -> int
+  {
+    constexpr int W = max(simd_width_v<T>, 1);
+    using V = batch_t<T, W>;
+
+    V a[M][M], x[M];
+    auto ma = [&](int i, int j) -> V& { return a[i][j]; };
+    auto vx = [&](int i) -> V& { return x[i]; };
+
+    int singular = 0;
+    for (int s = 0; s < K; s += W) {
+      int n = min(W, K - s);
+      if (n == W) {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            a[i][j] = simd_load<V>(A + (i * M + j) * K + s);
+          }
+          x[i] = simd_load<V>(b + i * K + s);
+        }
+      }
+      else {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            for (int l = 0; l < W; ++l) {
+              a[i][j][l] = (l < n) ? A[(i * M + j) * K + s + l] : T(i == j);
+            }
+          }
+          for (int l = 0; l < W; ++l) {
+            x[i][l] = (l < n) ? b[i * K + s + l] : T(0);
+          }
+        }
+      }
+
+      auto e = batch_solve<M>(ma, vx);
+
+      if (n == W) {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            simd_store<V>(A + (i * M + j) * K + s, a[i][j]);
+          }
+          simd_store<V>(b + i * K + s, x[i]);
+        }
+      }
+      else {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            for (int l = 0; l < n; ++l) {
+              A[(i * M + j) * K + s + l] = a[i][j][l];
+            }
+          }
+          for (int l = 0; l < n; ++l) {
+            b[i * K + s + l] = x[i][l];
+          }
+        }
+      }
+
+      for (int l = 0; l < n; ++l) {
+        info[s + l] = int(e[l]);
+        singular += (e[l] != 0);
+      }
+    }
+    return singular;
+  }
+}
+
+#endif // ALBERT_INCLUDE_BATCH_SOLVER_HPP
@@ -2,7 +2,13 @@
 #define ALBERT_INCLUDE_CMATH_HPP
 
 #include "albert/Bind.hpp"
+#include "albert/materialize.hpp"
+#include "albert/simd.hpp"
+#include "albert/simd_math.hpp"
+#include "albert/symmetry.hpp"
 #include <cmath>
+#include <tuple>
+#include <type_traits>
 
 namespace albert
 {
@@ -33,25 +39,172 @@ namespace albert
 
   constexpr CMathTag CMATH_TAG_MAX = CMathTag(unsigned(FLOOR) + 1);
 
+  /// The tags that take two arguments.
+  constexpr bool is_binary(CMathTag tag)
+  {
+    return tag <= POW or tag == ATAN2;
+  }
+
   template <CMathTag tag>
   struct cmath_tag {};
 
   template <CMathTag tag>
   constexpr inline cmath_tag<tag> cmath_tag_v = {};
 
-  template <is_expression A, CMathTag tag>
-  struct CMath : Bindable<CMath<A, tag>>
+  /// The accuracy of the vectorized cmath functions.
+  ///
+  /// - `exact` calls libm for every element, so vectorized and scalar
+  ///   evaluation produce the same results.
+  /// - `ulp4` uses the vector kernels for `exp`, `log`, and `pow`, which are
+  ///   accurate to 4 ulp over their full domain.
+  /// - `fast` uses the shorter kernels, which are accurate to 2^13 ulp in
+  ///   double precision and 64 ulp in single precision for finite arguments
+  ///   inside the domain of the function (see simd_math.hpp for the details).
+  ///
+  /// `sqrt`, `abs`, `ceil`, `floor`, `fmin`, and `fmax` are exact under every
+  /// policy, and the remaining functions always call libm. Scalar evaluation
+  /// always calls libm, which meets every contract.
+  enum class cmath_policy {
+    exact,
+    ulp4,
+    fast
+  };
+
+  /// The policy used by the grammar when an expression does not choose one,
+  /// e.g., `-DALBERT_CMATH_POLICY=fast`. With 16 byte vectors and no fused
+  /// multiply-add the kernels are no faster than libm, so the default is
+  /// `ulp4` only for wider vectors.
+#ifndef ALBERT_CMATH_POLICY
+#  if ALBERT_SIMD_BYTES >= 32
+#    define ALBERT_CMATH_POLICY ulp4
+#  else
+#    define ALBERT_CMATH_POLICY exact
+#  endif
+#endif
+
+  constexpr inline cmath_policy default_cmath_policy = cmath_policy::ALBERT_CMATH_POLICY;
+
+  template <cmath_policy P>
+  struct cmath_policy_tag {};
+
+  template <cmath_policy P>
+  constexpr inline cmath_policy_tag<P> cmath_policy_v = {};
+
+  namespace detail
+  {
+    /// Apply a cmath function to a scalar, or to a vector with the kernels in
+    /// simd_math.hpp that the policy allows, and libm for the other lanes.
+    /// @{
+    template <CMathTag tag, cmath_policy P, class T>
+    constexpr auto cmath(T const& x)
+    {
+      using std::abs;
+      using std::exp;
+      using std::log;
+      using std::sqrt;
+      using std::sin;
+      using std::cos;
+      using std::tan;
+      using std::asin;
+      using std::acos;
+      using std::atan;
+      using std::sinh;
+      using std::cosh;
+      using std::tanh;
+      using std::asinh;
+      using std::acosh;
+      using std::atanh;
+      using std::ceil;
+      using std::floor;
+
+      constexpr bool fast = P == cmath_policy::fast;
+
+      if constexpr (not std::is_same_v<T, simd_element_t<T>>) {
+        if constexpr (tag == ABS)   return simd_abs(x);
+        if constexpr (tag == SQRT)  return simd_sqrt(x);
+        if constexpr (tag == CEIL)  return simd_ceil(x);
+        if constexpr (tag == FLOOR) return simd_floor(x);
+        if constexpr (P != cmath_policy::exact) {
+          if constexpr (tag == EXP) return fast ? simd_fast_exp(x) : simd_exp(x);
+          if constexpr (tag == LOG) return fast ? simd_fast_log(x) : simd_log(x);
+        }
+        return simd_map(x, [](auto x) { return cmath<tag, P>(x); });
+      }
+      else {
+        if constexpr (tag == ABS)   return abs(x);
+        if constexpr (tag == EXP)   return exp(x);
+        if constexpr (tag == LOG)   return log(x);
+        if constexpr (tag == SQRT)  return sqrt(x);
+        if constexpr (tag == CEIL)  return ceil(x);
+        if constexpr (tag == FLOOR) return floor(x);
+        if constexpr (tag == SIN)   return sin(x);
+        if constexpr (tag == COS)   return cos(x);
+        if constexpr (tag == TAN)   return tan(x);
+        if constexpr (tag == ASIN)  return asin(x);
+        if constexpr (tag == ACOS)  return acos(x);
+        if constexpr (tag == ATAN)  return atan(x);
+        if constexpr (tag == SINH)  return sinh(x);
+        if constexpr (tag == COSH)  return cosh(x);
+        if constexpr (tag == TANH)  return tanh(x);
+        if constexpr (tag == ASINH) return asinh(x);
+        if constexpr (tag == ACOSH) return acosh(x);
+        if constexpr (tag == ATANH) return atanh(x);
+      }
+    }
+
+    template <CMathTag tag, cmath_policy P, class T, class U>
+    constexpr auto cmath(T const& x, U const& y)
+    {
+      using std::fmin;
+      using std::fmax;
+      using std::pow;
+      using std::atan2;
+
+      // a vector with a scalar broadcasts the scalar
+      using V = std::conditional_t<std::is_same_v<T, simd_element_t<T>>, U, T>;
+
+      if constexpr (not std::is_same_v<V, simd_element_t<V>>) {
+        V const u = x + V{};
+        V const v = y + V{};
+        if constexpr (tag == FMIN)  return simd_fmin(u, v);
+        if constexpr (tag == FMAX)  return simd_fmax(u, v);
+        if constexpr (tag == POW and P == cmath_policy::ulp4) return simd_pow(u, v);
+        if constexpr (tag == POW and P == cmath_policy::fast) return simd_fast_pow(u, v);
+        V z;
+        for (int i = 0; i < int(sizeof(V) / sizeof(z[0])); ++i) {
+          z[i] = cmath<tag, P>(u[i], v[i]);
+        }
+        return z;
+      }
+      else {
+        if constexpr (tag == FMIN)  return fmin(x, y);
+        if constexpr (tag == FMAX)  return fmax(x, y);
+        if constexpr (tag == POW)   return pow(x, y);
+        if constexpr (tag == ATAN2) return atan2(x, y);
+      }
+    }
+    /// @}
+  }
+
+  /// A cmath function applied elementwise.
+  ///
+  /// The result has the same shape and index as `a`, e.g., `exp(A(i,j))` is
+  /// an order 2 expression that evaluates `exp(A(i,j))` for each `i` and `j`.
+  template <is_expression A, CMathTag tag, cmath_policy P = default_cmath_policy>
+  struct CMath : Bindable<CMath<A, tag, P>>
   {
-    static_assert(POW < tag and tag < CMATH_TAG_MAX);
+    static_assert(not is_binary(tag) and tag < CMATH_TAG_MAX);
 
     using scalar_type = scalar_type_t<A>;
 
+    constexpr static CMathTag function = tag;
+    constexpr static cmath_policy policy = P;
+
     A a;
 
-    constexpr CMath(A a, cmath_tag<tag>)
+    constexpr CMath(A a, cmath_tag<tag>, cmath_policy_tag<P> = {})
         : a(std::move(a))
     {
-      static_assert(order_v<A> == 0);     // can't currently handle tensor cmath
     }
 
     /// Evaluate into a scalar.
@@ -60,24 +213,24 @@ namespace albert
       return evaluate(ScalarIndex<0>{});
     }
 
-    constexpr static bool contains(auto)
+    constexpr static bool contains(auto&& tag_)
     {
-      return false;
+      return A::contains(FWD(tag_));
     }
 
-    constexpr static bool may_alias(auto)
+    constexpr static bool may_alias(auto&& tag_)
     {
-      return false;
+      return A::may_alias(FWD(tag_));
     }
 
     constexpr static auto order() -> int
     {
-      return 0;
+      return order_v<A>;
     }
 
-    constexpr static auto outer() -> TensorIndex<0>
+    constexpr static auto outer() -> is_tensor_index auto
     {
-      return {};
+      return outer_v<A>;
     }
 
     constexpr static auto dim() -> int
@@ -85,79 +238,102 @@ namespace albert
       return dim_v<A>;
     }
 
-    constexpr auto evaluate(ScalarIndex<order_v<CMath>> const&) const
+    /// The argument of the function for the element `i`, as a tuple.
+    constexpr auto arguments(ScalarIndex<order_v<CMath>> const& i) const
     {
-      using std::abs;
-      using std::exp;
-      using std::log;
-      using std::sqrt;
-      using std::sin;
-      using std::cos;
-      using std::tan;
-      using std::asin;
-      using std::acos;
-      using std::atan;
-      using std::atan2;
-      using std::sinh;
-      using std::cosh;
-      using std::tanh;
-      using std::asinh;
-      using std::acosh;
-      using std::atanh;
-      using std::ceil;
-      using std::floor;
+      return std::tuple(a.evaluate(i));
+    }
 
-      switch (tag) {
-       case ABS:   return abs(a.evaluate());
-       case EXP:   return exp(a.evaluate());
-       case LOG:   return log(a.evaluate());
-       case SQRT:  return sqrt(a.evaluate());
-       case SIN:   return sin(a.evaluate());
-       case COS:   return cos(a.evaluate());
-       case TAN:   return tan(a.evaluate());
-       case ASIN:  return asin(a.evaluate());
-       case ACOS:  return acos(a.evaluate());
-       case ATAN:  return atan(a.evaluate());
-       case ATAN2: return atan2(a.evaluate());
-       case SINH:  return sinh(a.evaluate());
-       case COSH:  return cosh(a.evaluate());
-       case TANH:  return tanh(a.evaluate());
-       case ASINH: return asinh(a.evaluate());
-       case ACOSH: return acosh(a.evaluate());
-       case ATANH: return atanh(a.evaluate());
-       case CEIL:  return ceil(a.evaluate());
-       case FLOOR: return floor(a.evaluate());
-       default:
-        __builtin_abort();
-      }
-      __builtin_unreachable();
+    constexpr auto evaluate(ScalarIndex<order_v<CMath>> const& i) const
+    {
+      return detail::cmath<tag, P>(a.evaluate(i));
     }
   };
 
-  template <is_expression A, is_expression B, CMathTag tag>
-  struct CMath2 : Bindable<CMath<A, tag>>
+  template <is_expression A, CMathTag tag, cmath_policy P>
+  struct materializer<CMath<A, tag, P>>
   {
-    using scalar_type = scalar_type_t<A>;
+    constexpr static bool changes = materializer<A>::changes;
+
+    constexpr static auto apply(auto&& cmath)
+    {
+      return CMath(materialize(FWD(cmath).a), cmath_tag_v<tag>, cmath_policy_v<P>);
+    }
+  };
+
+  template <is_expression A, CMathTag tag, cmath_policy P>
+  struct subexpression<CMath<A, tag, P>> : stateless_subexpression<1, false>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a)
+    {
+      return CMath(FWD(a), cmath_tag_v<tag>, cmath_policy_v<P>);
+    }
+  };
+
+  template <is_expression A, CMathTag tag, cmath_policy P>
+  struct dependence<CMath<A, tag, P>> : local_dependence<> {};
+
+  /// Contiguous elements are evaluated a vector at a time.
+  template <is_vectorizable A, CMathTag tag, cmath_policy P>
+  requires std::floating_point<scalar_type_t<A>>
+  struct vectorizer<CMath<A, tag, P>>
+  {
+    constexpr static bool enabled = true;
+    using layout = vector_layout_t<A>;
+
+    template <class V>
+    static auto apply(CMath<A, tag, P> const& cmath, int n) -> V
+    {
+      return detail::cmath<tag, P>(vectorize<V>(cmath.a, n));
+    }
+  };
+
+  template <class A, CMathTag tag, cmath_policy P>
+  struct symmetry<CMath<A, tag, P>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_symmetric_in<A>(a, b);
+    }
+  };
+
+  /// A two argument cmath function applied elementwise.
+  ///
+  /// The arguments either have the same outer indices (in any order, as with
+  /// `Sum`), or one of them is a scalar that is broadcast, e.g., `pow(A(i,j),
+  /// 2.0)` or `fmax(A(i,j), B(j,i))`.
+  template <is_expression A, is_expression B, CMathTag tag, cmath_policy P = default_cmath_policy>
+  struct CMath2 : Bindable<CMath2<A, B, tag, P>>
+  {
+    static_assert(is_binary(tag));
+
+    using scalar_type = scalar_type_t<std::conditional_t<order_v<A> == 0, B, A>>;
+
+    constexpr static CMathTag function = tag;
+    constexpr static cmath_policy policy = P;
 
     A a;
     B b;
 
-    constexpr CMath2(A a, B b, cmath_tag<tag>)
+    constexpr CMath2(A a, B b, cmath_tag<tag>, cmath_policy_tag<P> = {})
         : a(std::move(a))
         , b(std::move(b))
     {
-      static_assert(order_v<A> == 0);     // can't currently handle tensor cmath
-      static_assert(order_v<B> == 0);     // can't currently handle tensor cmath
+      static_assert(order_v<A> == 0 or order_v<B> == 0 or is_permutation(outer_v<A>, outer_v<B>));
+      static_assert(dim_v<A> == 0 || dim_v<B> == 0 || dim_v<A> == dim_v<B>);
     }
 
-    constexpr static bool contains(auto)
+    constexpr static bool contains(auto&& tag_)
     {
-      return false;
+      return A::contains(FWD(tag_)) || B::contains(FWD(tag_));
     }
 
-    constexpr static bool may_alias(auto)
+    constexpr static bool may_alias(auto&& tag_)
     {
-      return false;
+      return (A::may_alias(FWD(tag_)) ||
+              B::may_alias(FWD(tag_)) ||
+              (outer_v<A> != outer_v<B> and order_v<A> != 0 and order_v<B> != 0 and
+               contains(FWD(tag_))));
     }
 
     /// Evaluate into a scalar.
@@ -168,32 +344,110 @@ namespace albert
 
     constexpr static auto order() -> int
     {
-      return 0;
+      return max(order_v<A>, order_v<B>);
     }
 
-    constexpr static auto outer() -> TensorIndex<0>
+    constexpr static auto outer() -> is_tensor_index auto
     {
-      return {};
+      if constexpr (order_v<A> == 0) {
+        return outer_v<B>;
+      }
+      else {
+        return outer_v<A>;
+      }
     }
 
     constexpr static auto dim() -> int
     {
-      return dim_v<A>;
+      return max(dim_v<A>, dim_v<B>);
     }
 
-    constexpr auto evaluate(ScalarIndex<order_v<CMath2>> const&) const
+    /// The arguments of the function for the element `i`, as a tuple, where a
+    /// scalar argument is broadcast.
+    constexpr auto arguments(ScalarIndex<order_v<CMath2>> const& i) const
     {
-      using std::fmin;
-      using std::fmax;
-      using std::pow;
-      switch (tag) {
-       case FMIN: return fmin(a.evaluate(), b.evaluate());
-       case FMAX: return fmax(a.evaluate(), b.evaluate());
-       case POW:  return pow(a.evaluate(), b.evaluate());
-       default:
-        __builtin_abort();
-      }
-      __builtin_unreachable();
+      constexpr TensorIndex l = outer_v<CMath2>;
+      constexpr TensorIndex r = outer_v<B>;
+      auto x = [&] {
+        if constexpr (order_v<A> == 0) {
+          return a.evaluate(ScalarIndex<0>{});
+        }
+        else {
+          return a.evaluate(i);
+        }
+      };
+      auto y = [&] {
+        if constexpr (order_v<B> == 0) {
+          return b.evaluate(ScalarIndex<0>{});
+        }
+        else if constexpr (l == r) {
+          return b.evaluate(i);
+        }
+        else {
+          return b.evaluate(select<l, r>(i));
+        }
+      };
+      return std::tuple(x(), y());
+    }
+
+    constexpr auto evaluate(ScalarIndex<order_v<CMath2>> const& i) const
+    {
+      auto [x, y] = arguments(i);
+      return detail::cmath<tag, P>(x, y);
+    }
+  };
+
+  template <is_expression A, is_expression B, CMathTag tag, cmath_policy P>
+  struct materializer<CMath2<A, B, tag, P>>
+  {
+    constexpr static bool changes = materializer<A>::changes || materializer<B>::changes;
+
+    constexpr static auto apply(auto&& cmath)
+    {
+      return CMath2(materialize(FWD(cmath).a), materialize(FWD(cmath).b), cmath_tag_v<tag>, cmath_policy_v<P>);
+    }
+  };
+
+  template <is_expression A, is_expression B, CMathTag tag, cmath_policy P>
+  struct subexpression<CMath2<A, B, tag, P>> : stateless_subexpression<2, false>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a, auto&& b)
+    {
+      return CMath2(FWD(a), FWD(b), cmath_tag_v<tag>, cmath_policy_v<P>);
+    }
+  };
+
+  template <is_expression A, is_expression B, CMathTag tag, cmath_policy P>
+  struct dependence<CMath2<A, B, tag, P>> : local_dependence<> {};
+
+  /// Contiguous elements are evaluated a vector at a time, when both arguments
+  /// stream in the same order or one of them is broadcast.
+  template <is_vectorizable A, is_vectorizable B, CMathTag tag, cmath_policy P>
+  requires ((outer_v<A> == outer_v<B> or
+             (order_v<A> == 0 and std::is_void_v<vector_layout_t<A>>) or
+             (order_v<B> == 0 and std::is_void_v<vector_layout_t<B>>)) and
+            std::floating_point<scalar_type_t<CMath2<A, B, tag, P>>> and
+            std::is_same_v<scalar_type_t<A>, scalar_type_t<B>> and
+            same_vector_layout_v<A, B>)
+  struct vectorizer<CMath2<A, B, tag, P>>
+  {
+    constexpr static bool enabled = true;
+    using layout = common_vector_layout_t<A, B>;
+
+    template <class V>
+    static auto apply(CMath2<A, B, tag, P> const& cmath, int n) -> V
+    {
+      return detail::cmath<tag, P>(vectorize<V>(cmath.a, n), vectorize<V>(cmath.b, n));
+    }
+  };
+
+  template <class A, class B, CMathTag tag, cmath_policy P>
+  struct symmetry<CMath2<A, B, tag, P>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return ((order_v<A> == 0 or is_symmetric_in<A>(a, b)) and
+              (order_v<B> == 0 or is_symmetric_in<B>(a, b)));
     }
   };
 }
@@ -77,6 +77,9 @@ namespace albert
   template <class T>
   inline constexpr auto outer_v = std::remove_cvref_t<T>::outer();
 
+  template <class T>
+  inline constexpr auto inner_v = std::remove_cvref_t<T>::inner();
+
   template <class T>
   inline constexpr int order_v = std::remove_cvref_t<T>::order();
 
@@ -0,0 +1,329 @@
+#ifndef ALBERT_INCLUDE_CSE_HPP
+#define ALBERT_INCLUDE_CSE_HPP
+
+#include "albert/Bind.hpp"
+#include "albert/Tensor.hpp"
+#include "albert/concepts.hpp"
+#include "albert/materialize.hpp"
+#include "albert/utils.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace albert
+{
+  /// Common subexpression elimination.
+  ///
+  /// Expressions like `symmetrize(A(i,k) * B(k,j))`, or `(A(i,k) * B(k,j)) +
+  /// (A(i,k) * B(k,j))(j,i)`, contain the same subtree more than once, and
+  /// each copy is evaluated independently. Before an assignment is
+  /// materialized the largest subtree that appears more than once is found,
+  /// each of its distinct occurrences is evaluated once into a stack
+  /// temporary, and every occurrence is replaced by a bind of its temporary.
+  /// This repeats until no subtree is repeated.
+  ///
+  /// Subtrees are equal at compile time when they have the same type, which
+  /// includes the bind indices and the tags of the leaf tensors, and a
+  /// structural hash of each subtree limits the comparisons. Different tensors
+  /// can share a type, and projections are runtime values, so occurrences
+  /// only share a temporary at runtime when their leaves are identical (see
+  /// `subexpression`).
+  ///
+  /// Purely elementwise subtrees (e.g., `A(i,j) + B(i,j)`) are cheaper to
+  /// recompute than to store, and are never shared. Use `lazy()` to hide a
+  /// subtree from this transformation.
+  namespace cse
+  {
+    template <class E>
+    using a_t = std::remove_cvref_t<decltype(std::declval<E&>().a)>;
+
+    template <class E>
+    using b_t = std::remove_cvref_t<decltype(std::declval<E&>().b)>;
+
+    /// The number of interior nodes in the tree rooted at `E`.
+    template <class E>
+    constexpr inline int size_v = [] {
+      constexpr int arity = subexpression<E>::arity;
+      if constexpr (arity == 0) {
+        return 0;
+      }
+      else if constexpr (arity == 1) {
+        return 1 + size_v<a_t<E>>;
+      }
+      else {
+        return 1 + size_v<a_t<E>> + size_v<b_t<E>>;
+      }
+    }();
+
+    /// The `p`th interior node in pre-order.
+    template <class E, int p>
+    constexpr auto at()
+    {
+      if constexpr (p == 0) {
+        return std::type_identity<E>{};
+      }
+      else if constexpr (p - 1 < size_v<a_t<E>>) {
+        return at<a_t<E>, p - 1>();
+      }
+      else {
+        return at<b_t<E>, p - 1 - size_v<a_t<E>>>();
+      }
+    }
+
+    template <class E, int p>
+    using at_t = typename decltype(at<E, p>())::type;
+
+    /// The number of occurrences of `X` in the tree rooted at `E`.
+    template <class E, class X>
+    constexpr inline int count_v = [] {
+      constexpr int arity = subexpression<E>::arity;
+      if constexpr (std::is_same_v<E, X>) {
+        return 1;
+      }
+      else if constexpr (arity == 0) {
+        return 0;
+      }
+      else if constexpr (arity == 1) {
+        return count_v<a_t<E>, X>;
+      }
+      else {
+        return count_v<a_t<E>, X> + count_v<b_t<E>, X>;
+      }
+    }();
+
+    constexpr auto mix(std::uint64_t h, std::uint64_t v) -> std::uint64_t
+    {
+      return (h ^ v) * 0x100000001b3;
+    }
+
+    /// A structural hash of the tree rooted at `E`.
+    ///
+    /// Equal types have equal hashes, the converse is checked with the types.
+    template <class E>
+    constexpr inline std::uint64_t hash_v = [] {
+      constexpr int arity = subexpression<E>::arity;
+      std::uint64_t h = 0xcbf29ce484222325;
+      h = mix(h, arity);
+      h = mix(h, sizeof(E));
+      h = mix(h, order_v<E>);
+      h = mix(h, dim_v<E>);
+      for (char c : outer_v<E>) {
+        h = mix(h, c);
+      }
+      if constexpr (arity >= 1) {
+        h = mix(h, hash_v<a_t<E>>);
+      }
+      if constexpr (arity == 2) {
+        h = mix(h, hash_v<b_t<E>>);
+      }
+      return h;
+    }();
+
+    /// Is any node in the tree rooted at `E` worth storing.
+    template <class E>
+    constexpr inline bool expensive_v = [] {
+      using S = subexpression<E>;
+      if constexpr (S::arity == 0) {
+        return false;
+      }
+      else if constexpr (S::arity == 1) {
+        return not S::elementwise or expensive_v<a_t<E>>;
+      }
+      else {
+        return not S::elementwise or expensive_v<a_t<E>> or expensive_v<b_t<E>>;
+      }
+    }();
+
+    /// The positions of the subtrees that might be shared, largest first.
+    ///
+    /// A subtree is only a candidate if it's worth storing and another subtree
+    /// has the same hash.
+    template <class E>
+    constexpr auto candidates()
+    {
+      constexpr int M = size_v<E>;
+      struct {
+        std::array<int, M> p = {};
+        int n = 0;
+      } out;
+
+      [&]<int... p>(std::integer_sequence<int, p...>) {
+        constexpr std::array<std::uint64_t, M> hashes = { hash_v<at_t<E, p>>... };
+        constexpr std::array<int, M> sizes = { size_v<at_t<E, p>>... };
+        constexpr std::array<bool, M> eligible = {
+          (expensive_v<at_t<E, p>> and dim_v<at_t<E, p>> != 0)...
+        };
+
+        for (int q = 0; q < M; ++q) {
+          int n = 0;
+          for (int r = 0; r < M; ++r) {
+            n += (hashes[r] == hashes[q]);
+          }
+          if (eligible[q] and n > 1) {
+            out.p[out.n++] = q;
+          }
+        }
+
+        // stable insertion sort by size
+        for (int k = 1; k < out.n; ++k) {
+          for (int j = k; j > 0 and sizes[out.p[j - 1]] < sizes[out.p[j]]; --j) {
+            std::swap(out.p[j - 1], out.p[j]);
+          }
+        }
+      }(std::make_integer_sequence<int, M>());
+      return out;
+    }
+
+    template <class E>
+    constexpr inline auto candidates_v = candidates<E>();
+
+    /// The position of the subtree to share, or -1 if there isn't one.
+    template <class E, int r = 0>
+    constexpr auto select() -> int
+    {
+      constexpr auto const& c = candidates_v<E>;
+      if constexpr (r == c.n) {
+        return -1;
+      }
+      else if constexpr (count_v<E, at_t<E, c.p[r]>> > 1) {
+        return c.p[r];
+      }
+      else {
+        return select<E, r + 1>();
+      }
+    }
+
+    template <class E>
+    constexpr inline int select_v = select<E>();
+
+    /// Do two instances of a subtree evaluate to the same values.
+    template <class T>
+    constexpr bool identical(T const& x, T const& y)
+    {
+      using S = subexpression<T>;
+      bool same = S::same(x, y);
+      if constexpr (S::arity >= 1) {
+        same = same and identical(x.a, y.a);
+      }
+      if constexpr (S::arity == 2) {
+        same = same and identical(x.b, y.b);
+      }
+      return same;
+    }
+
+    /// Collect the occurrences of `X` in pre-order.
+    template <class X>
+    constexpr void gather(auto const& e, auto& occurrences, int& n)
+    {
+      using T = std::remove_cvref_t<decltype(e)>;
+      if constexpr (std::is_same_v<T, X>) {
+        occurrences[n++] = std::addressof(e);
+      }
+      else if constexpr (count_v<T, X> != 0) {
+        gather<X>(e.a, occurrences, n);
+        if constexpr (subexpression<T>::arity == 2) {
+          gather<X>(e.b, occurrences, n);
+        }
+      }
+    }
+
+    /// The temporary for each occurrence of `X`, in pre-order.
+    template <class X>
+    struct Temporaries
+    {
+      using Temporary = Tensor<scalar_type_t<X>, order_v<X>, dim_v<X>>;
+
+      Temporary* temps;
+      int const* group;
+      int n = 0;
+
+      constexpr auto next() -> decltype(auto)
+      {
+        return temps[group[n++]].template rebind<outer_v<X>>();
+      }
+    };
+
+    /// Replace the occurrences of `X` with binds of their temporaries.
+    template <class X>
+    constexpr auto replace(auto&& e, Temporaries<X>& temps)
+    {
+      using T = std::remove_cvref_t<decltype(e)>;
+      using S = subexpression<T>;
+      if constexpr (std::is_same_v<T, X>) {
+        return temps.next();
+      }
+      else if constexpr (count_v<T, X> == 0) {
+        return T(FWD(e));
+      }
+      else if constexpr (S::arity == 1) {
+        return S::rebuild(FWD(e), replace<X>(FWD(e).a, temps));
+      }
+      else {
+        auto a = replace<X>(FWD(e).a, temps);
+        auto b = replace<X>(FWD(e).b, temps);
+        return S::rebuild(FWD(e), std::move(a), std::move(b));
+      }
+    }
+
+    template <class E>
+    requires (select_v<E> >= 0)
+    struct sharing<E>
+    {
+      constexpr static bool changes = true;
+
+      /// The shared subtree, and the number of times it appears.
+      using type = at_t<E, select_v<E>>;
+      constexpr static int count = count_v<E, type>;
+
+      /// The tree after the subtree is shared.
+      using result = decltype(replace<type>(std::declval<E>(), std::declval<Temporaries<type>&>()));
+
+      template <class F>
+      constexpr static auto apply(auto&& e, F&& f) -> decltype(auto)
+      {
+        using X = type;
+        using Temporary = typename Temporaries<X>::Temporary;
+
+        std::array<X const*, count> occurrences;
+        int n = 0;
+        gather<X>(e, occurrences, n);
+
+        // Occurrences that are identical to an earlier one share its
+        // temporary, the others are evaluated into their own.
+        std::array<int, count> group;
+        std::array<Temporary, count> temps;
+        for (int k = 0; k < count; ++k) {
+          group[k] = k;
+          for (int m = 0; m < k; ++m) {
+            if (group[m] == m and identical(*occurrences[m], *occurrences[k])) {
+              group[k] = m;
+              break;
+            }
+          }
+          if (group[k] == k) {
+            temps[k] = *occurrences[k];
+          }
+        }
+
+        Temporaries<X> t = { temps.data(), group.data() };
+        return share(replace<X>(FWD(e), t), FWD(f));
+      }
+    };
+
+    /// The number of subtrees that are shared, for reports and tests.
+    template <class E>
+    constexpr inline int merges_v = [] {
+      using T = std::remove_cvref_t<E>;
+      if constexpr (sharing<T>::changes) {
+        return 1 + merges_v<typename sharing<T>::result>;
+      }
+      else {
+        return 0;
+      }
+    }();
+  }
+}
+
+#endif // ALBERT_INCLUDE_CSE_HPP
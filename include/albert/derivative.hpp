@@ -0,0 +1,797 @@
+#ifndef ALBERT_INCLUDE_DERIVATIVE_HPP
+#define ALBERT_INCLUDE_DERIVATIVE_HPP
+
+#include "albert/Bind.hpp"
+#include "albert/Index.hpp"
+#include "albert/ScalarIndex.hpp"
+#include "albert/TensorIndex.hpp"
+#include "albert/aliasing.hpp"
+#include "albert/cmath.hpp"
+#include "albert/concepts.hpp"
+#include "albert/expressions.hpp"
+#include "albert/materialize.hpp"
+#include "albert/utils.hpp"
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/// Symbolic differentiation.
+///
+/// `D(f, x)` is the partial derivative of the expression `f` with respect to
+/// a bound tensor variable `x`, e.g., `D(S(i,j), E(k,l))` is the order 4
+/// tangent `∂S(i,j)/∂E(k,l)`. The derivative is built at compile time by
+/// applying the usual rules to the expression tree: linearity over sums,
+/// the product rule over products (including contractions), and the chain
+/// rule through the cmath functions, inverses, and determinants. The
+/// derivative of the variable itself is a product of deltas, `∂E(i,j)/∂E(k,l)
+/// = δ(i,k) δ(j,l)`.
+///
+/// The result is an ordinary expression with no runtime bookkeeping, and
+/// subtrees that don't depend on the variable are eliminated at compile time.
+///
+/// Variables are identified by their tag, and then by their storage, so
+/// tensors of the same type that aren't the variable are constants. Views are
+/// always constants.
+namespace albert
+{
+  /// A tensor of zeros, the derivative of anything that doesn't depend on the
+  /// variable.
+  template <is_tensor_index auto index>
+  struct Zero : Bindable<Zero<index>>
+  {
+    using scalar_type = int;
+
+    constexpr static bool contains(auto)
+    {
+      return false;
+    }
+
+    constexpr static bool may_alias(auto)
+    {
+      return false;
+    }
+
+    constexpr static auto order() -> int
+    {
+      return index.size();
+    }
+
+    constexpr static auto dim() -> int
+    {
+      return 0;
+    }
+
+    constexpr static auto outer() -> is_tensor_index auto
+    {
+      return index;
+    }
+
+    constexpr static auto evaluate(ScalarIndex<order_v<Zero>> const&) -> int
+    {
+      return 0;
+    }
+  };
+
+  template <class>
+  constexpr inline bool is_zero_v = false;
+
+  template <auto index>
+  constexpr inline bool is_zero_v<Zero<index>> = true;
+
+  /// An elementwise product, used for the chain rule.
+  ///
+  /// The characters that appear in both operands are not contracted, e.g., the
+  /// derivative of `exp(A(i,j))` with respect to `X(k,l)` is the product of
+  /// `exp(A(i,j))` with `∂A(i,j)/∂X(k,l)` for each `i` and `j`. The outer
+  /// index is the outer index of `b` followed by any characters that only
+  /// appear in `a`.
+  template <is_expression A, is_expression B>
+  struct Chain : Bindable<Chain<A, B>>
+  {
+    using scalar_type = decltype(std::declval<scalar_type_t<A>>() * std::declval<scalar_type_t<B>>());
+
+    A a;
+    B b;
+
+    constexpr Chain(A a, B b)
+        : a(std::move(a))
+        , b(std::move(b))
+    {
+      static_assert(dim_v<A> == 0 || dim_v<B> == 0 || dim_v<A> == dim_v<B>);
+    }
+
+    constexpr static bool contains(auto&& tag)
+    {
+      return A::contains(FWD(tag)) || B::contains(FWD(tag));
+    }
+
+    constexpr static bool may_alias(auto&& tag)
+    {
+      return (A::may_alias(FWD(tag)) ||
+              B::may_alias(FWD(tag)) ||
+              (outer_v<A> != outer_v<B> and contains(FWD(tag))));
+    }
+
+    /// Evaluate into a scalar.
+    constexpr operator scalar_type() const requires (order_v<Chain> == 0)
+    {
+      return evaluate(ScalarIndex<0>{});
+    }
+
+    constexpr static auto order() -> int
+    {
+      return outer().size();
+    }
+
+    constexpr static auto dim() -> int
+    {
+      return max(dim_v<A>, dim_v<B>);
+    }
+
+    constexpr static auto outer() -> is_tensor_index auto
+    {
+      return outer_v<B> + (outer_v<A> - outer_v<B>);
+    }
+
+    constexpr auto evaluate(ScalarIndex<order_v<Chain>> const& i) const
+    {
+      constexpr TensorIndex outer = outer_v<Chain>;
+      constexpr TensorIndex     l = outer_v<A>;
+      constexpr TensorIndex     r = outer_v<B>;
+      return a.evaluate(select<outer, l>(i)) * b.evaluate(select<outer, r>(i));
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct materializer<Chain<A, B>>
+  {
+    constexpr static bool changes = materializer<A>::changes || materializer<B>::changes;
+
+    constexpr static auto apply(auto&& chain)
+    {
+      return Chain { materialize(FWD(chain).a), materialize(FWD(chain).b) };
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct subexpression<Chain<A, B>> : stateless_subexpression<2>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a, auto&& b)
+    {
+      return Chain { FWD(a), FWD(b) };
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct dependence<Chain<A, B>> : local_dependence<> {};
+
+  namespace detail
+  {
+    /// The derivative of a cmath function with respect to its `arg`th
+    /// argument, for scalars.
+    /// @{
+    template <CMathTag tag, cmath_policy P, int arg, class T>
+    constexpr auto cmath_derivative(T const& x)
+    {
+      using U = decltype(cmath<tag, P>(x));
+      U const one = U(1);
+      U const sq = x * x;
+      if constexpr (tag == ABS)   return (x < 0) ? -one : one;
+      if constexpr (tag == EXP)   return cmath<EXP, P>(x);
+      if constexpr (tag == LOG)   return one / x;
+      if constexpr (tag == SQRT)  return one / (U(2) * cmath<SQRT, P>(x));
+      if constexpr (tag == SIN)   return cmath<COS, P>(x);
+      if constexpr (tag == COS)   return -cmath<SIN, P>(x);
+      if constexpr (tag == TAN)   return one / (cmath<COS, P>(x) * cmath<COS, P>(x));
+      if constexpr (tag == ASIN)  return one / cmath<SQRT, P>(one - sq);
+      if constexpr (tag == ACOS)  return -one / cmath<SQRT, P>(one - sq);
+      if constexpr (tag == ATAN)  return one / (one + sq);
+      if constexpr (tag == SINH)  return cmath<COSH, P>(x);
+      if constexpr (tag == COSH)  return cmath<SINH, P>(x);
+      if constexpr (tag == TANH)  return one / (cmath<COSH, P>(x) * cmath<COSH, P>(x));
+      if constexpr (tag == ASINH) return one / cmath<SQRT, P>(sq + one);
+      if constexpr (tag == ACOSH) return one / cmath<SQRT, P>(sq - one);
+      if constexpr (tag == ATANH) return one / (one - sq);
+      if constexpr (tag == CEIL)  return U(0);
+      if constexpr (tag == FLOOR) return U(0);
+    }
+
+    template <CMathTag tag, cmath_policy P, int arg, class T, class U>
+    constexpr auto cmath_derivative(T const& x, U const& y)
+    {
+      using V = decltype(cmath<tag, P>(x, y));
+      if constexpr (tag == FMIN) {
+        return V((arg == 0) ? not (y < x) : (y < x));
+      }
+      if constexpr (tag == FMAX) {
+        return V((arg == 0) ? not (x < y) : (x < y));
+      }
+      if constexpr (tag == POW and arg == 0) {
+        return V(y) * cmath<POW, P>(x, y - 1);
+      }
+      if constexpr (tag == POW and arg == 1) {
+        return cmath<POW, P>(x, y) * cmath<LOG, P>(x);
+      }
+      if constexpr (tag == ATAN2) {
+        V const r = V(x * x + y * y);
+        return (arg == 0) ? V(y) / r : V(-x) / r;
+      }
+    }
+    /// @}
+  }
+
+  /// The derivative of a cmath node `E` with respect to its `arg`th argument,
+  /// elementwise.
+  template <is_expression E, int arg = 0>
+  struct CMathDerivative : Bindable<CMathDerivative<E, arg>>
+  {
+    using scalar_type = scalar_type_t<E>;
+
+    E a;
+
+    constexpr CMathDerivative(E a, nttp_args<arg> = {})
+        : a(std::move(a))
+    {
+    }
+
+    constexpr static bool contains(auto&& tag)
+    {
+      return E::contains(FWD(tag));
+    }
+
+    constexpr static bool may_alias(auto&& tag)
+    {
+      return E::may_alias(FWD(tag));
+    }
+
+    constexpr static auto order() -> int
+    {
+      return order_v<E>;
+    }
+
+    constexpr static auto dim() -> int
+    {
+      return dim_v<E>;
+    }
+
+    constexpr static auto outer() -> is_tensor_index auto
+    {
+      return outer_v<E>;
+    }
+
+    constexpr auto evaluate(ScalarIndex<order_v<CMathDerivative>> const& i) const
+    {
+      return std::apply([](auto const&... xs) {
+        return detail::cmath_derivative<E::function, E::policy, arg>(xs...);
+      }, a.arguments(i));
+    }
+  };
+
+  template <is_expression E, int arg>
+  struct materializer<CMathDerivative<E, arg>>
+  {
+    constexpr static bool changes = materializer<E>::changes;
+
+    constexpr static auto apply(auto&& d)
+    {
+      return CMathDerivative(materialize(FWD(d).a), nttp<arg>);
+    }
+  };
+
+  template <is_expression E, int arg>
+  struct subexpression<CMathDerivative<E, arg>> : stateless_subexpression<1, false>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a)
+    {
+      return CMathDerivative(FWD(a), nttp<arg>);
+    }
+  };
+
+  template <is_expression E, int arg>
+  struct dependence<CMathDerivative<E, arg>> : local_dependence<> {};
+
+  /// Build the derivative of a node.
+  ///
+  /// The differentiator for a node type is `enabled` if it knows how to
+  /// `apply` the rules of differentiation to an instance, producing the
+  /// derivative with respect to the variable `x` as a new expression. Its outer
+  /// index is the node's outer index followed by the variable's, up to a
+  /// permutation.
+  ///
+  /// Subtrees that don't depend on the variable are never visited, their
+  /// derivative is a `Zero`.
+  template <class E>
+  struct differentiator
+  {
+    constexpr static bool enabled = false;
+  };
+
+  namespace detail
+  {
+    /// Does the tree `E` read the tensor with the tag type `Tag`.
+    template <class E, class Tag>
+    constexpr bool depends_on()
+    {
+      using T = std::remove_cvref_t<E>;
+      if constexpr (is_tensor_bind_v<T>) {
+        if constexpr (requires { T::tag(); }) {
+          return std::is_same_v<std::remove_cvref_t<decltype(T::tag())>, Tag>;
+        }
+        else {
+          return false;
+        }
+      }
+      else {
+        bool depends = false;
+        if constexpr (requires (T t) { { t.a } -> is_tensor; }) {
+          depends |= depends_on<decltype(std::declval<T>().a), Tag>();
+        }
+        if constexpr (requires (T t) { { t.b } -> is_tensor; }) {
+          depends |= depends_on<decltype(std::declval<T>().b), Tag>();
+        }
+        return depends;
+      }
+    }
+
+    /// Does any node in the tree `E` use the character `c`.
+    template <class E>
+    constexpr bool mentions(char c)
+    {
+      using T = std::remove_cvref_t<E>;
+      bool found = bound_index(static_cast<T const*>(nullptr)).count(c) != 0;
+      if constexpr (is_expression<T>) {
+        found |= outer_v<T>.count(c) != 0;
+      }
+      if constexpr (requires (T t) { { t.a } -> is_tensor; }) {
+        found |= mentions<decltype(std::declval<T>().a)>(c);
+      }
+      if constexpr (requires (T t) { { t.b } -> is_tensor; }) {
+        found |= mentions<decltype(std::declval<T>().b)>(c);
+      }
+      if constexpr (requires (T t) { { t.x } -> is_tensor; }) {
+        found |= mentions<decltype(std::declval<T>().x)>(c);
+      }
+      return found;
+    }
+
+    /// Pick `n` characters that aren't used by any of the trees `Es`, for the
+    /// indices that the derivative introduces.
+    template <int n, class... Es>
+    constexpr auto fresh() -> std::array<char, n>
+    {
+      std::array<char, n> out = {};
+      int k = 0;
+      for (char c = 'z'; c >= 'a' and k < n; --c) {
+        if (not (mentions<Es>(c) or ...)) {
+          out[k++] = c;
+        }
+      }
+      for (char c = 'Z'; c >= 'A' and k < n; --c) {
+        if (not (mentions<Es>(c) or ...)) {
+          out[k++] = c;
+        }
+      }
+      return out;
+    }
+
+    template <class E, class X>
+    constexpr auto zero()
+    {
+      return Zero<outer_v<E> + outer_v<X>>{};
+    }
+
+    /// Rename the characters of `e` in `from` to the corresponding characters
+    /// in `to`.
+    template <auto from, auto to, class E>
+    constexpr auto rename(E&& e)
+    {
+      constexpr auto index = [] {
+        TensorIndex<order_v<E>> out;
+        for (char c : outer_v<E>) {
+          out.push(from.count(c) ? to[from.index_of(c)] : c);
+        }
+        return out;
+      }();
+
+      if constexpr (is_zero_v<std::remove_cvref_t<E>>) {
+        return Zero<index>{};
+      }
+      else {
+        return substitute<from, to>(FWD(e));
+      }
+    }
+
+    /// The product of deltas `δ(i[p], j[p])`, which is the derivative of a
+    /// tensor bound to `i` with respect to itself bound to `j`.
+    template <auto i, auto j, int N, int p = 0>
+    constexpr auto deltas()
+    {
+      constexpr TensorIndex ij(Index<i[p], j[p]>{});
+      if constexpr (p + 1 == i.size()) {
+        return Delta<ij, N>{};
+      }
+      else {
+        return Product { Delta<ij, N>{}, deltas<i, j, N, p + 1>() };
+      }
+    }
+
+    /// Build nodes of the derivative, eliminating zeros.
+    /// @{
+    template <class A, class B>
+    constexpr auto d_sum(A&& a, B&& b)
+    {
+      if constexpr (is_zero_v<std::remove_cvref_t<A>>) {
+        return std::remove_cvref_t<B>(FWD(b));
+      }
+      else if constexpr (is_zero_v<std::remove_cvref_t<B>>) {
+        return std::remove_cvref_t<A>(FWD(a));
+      }
+      else {
+        return Sum { FWD(a), FWD(b) };
+      }
+    }
+
+    template <class A, class B>
+    constexpr auto d_diff(A&& a, B&& b)
+    {
+      if constexpr (is_zero_v<std::remove_cvref_t<B>>) {
+        return std::remove_cvref_t<A>(FWD(a));
+      }
+      else if constexpr (is_zero_v<std::remove_cvref_t<A>>) {
+        return Negate { FWD(b) };
+      }
+      else {
+        return Diff { FWD(a), FWD(b) };
+      }
+    }
+
+    template <class A>
+    constexpr auto d_negate(A&& a)
+    {
+      if constexpr (is_zero_v<std::remove_cvref_t<A>>) {
+        return std::remove_cvref_t<A>(FWD(a));
+      }
+      else {
+        return Negate { FWD(a) };
+      }
+    }
+
+    template <class A, class B>
+    constexpr auto d_product(A&& a, B&& b)
+    {
+      using P = Product<std::remove_cvref_t<A>, std::remove_cvref_t<B>>;
+      if constexpr (is_zero_v<std::remove_cvref_t<A>> or is_zero_v<std::remove_cvref_t<B>>) {
+        return Zero<outer_v<P>>{};
+      }
+      else {
+        return Product { FWD(a), FWD(b) };
+      }
+    }
+
+    template <class A, class B>
+    constexpr auto d_chain(A&& a, B&& b)
+    {
+      using C = Chain<std::remove_cvref_t<A>, std::remove_cvref_t<B>>;
+      if constexpr (is_zero_v<std::remove_cvref_t<A>> or is_zero_v<std::remove_cvref_t<B>>) {
+        return Zero<outer_v<C>>{};
+      }
+      else {
+        return Chain { FWD(a), FWD(b) };
+      }
+    }
+    /// @}
+  }
+
+  /// The derivative of `e` with respect to the bound tensor `x`.
+  template <is_expression E, is_expression X>
+  constexpr auto differentiate(E const& e, X const& x)
+  {
+    using Tag = std::remove_cvref_t<decltype(X::tag())>;
+    if constexpr (not detail::depends_on<E, Tag>()) {
+      return detail::zero<E, X>();
+    }
+    else {
+      static_assert(differentiator<E>::enabled, "expression is not differentiable (e.g., matrix functions, use Dual)");
+      return differentiator<E>::apply(e, x);
+    }
+  }
+
+  template <class E, class X>
+  using derivative_t = decltype(differentiate(std::declval<E const&>(), std::declval<X const&>()));
+
+  /// The derivative of a bound tensor is a product of deltas if it is the
+  /// variable. A tensor with the same tag may still be a different tensor, so
+  /// the product is scaled by the result of comparing their storage.
+  ///
+  /// Bound expressions (e.g., `symmetrize`) rename the characters of the
+  /// derivative of their subtree.
+  template <is_tensor A, is_tensor_index auto index>
+  struct differentiator<Bind<A, index>>
+  {
+    constexpr static bool enabled = (index.n_projected() == 0 and
+                                     (is_tensor_bind_v<Bind<A, index>> or index.n_repeated() == 0));
+
+    template <class X>
+    constexpr static auto apply(Bind<A, index> const& bind, X const& x)
+    {
+      if constexpr (is_tensor_bind_v<Bind<A, index>>) {
+        bool same = false;
+        if constexpr (std::is_lvalue_reference_v<A> and std::is_lvalue_reference_v<decltype(x.a)>) {
+          same = (static_cast<void const*>(&bind.a) == static_cast<void const*>(&x.a));
+        }
+        if constexpr (index.size() == 0) {
+          return Literal { int(same) };
+        }
+        else {
+          return Product { Literal { int(same) }, detail::deltas<index, outer_v<X>, dim_v<A>>() };
+        }
+      }
+      else {
+        return detail::rename<outer_v<A>, index>(differentiate(bind.a, x));
+      }
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct differentiator<Sum<A, B>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Sum<A, B> const& sum, auto const& x)
+    {
+      return detail::d_sum(differentiate(sum.a, x), differentiate(sum.b, x));
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct differentiator<Diff<A, B>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Diff<A, B> const& diff, auto const& x)
+    {
+      return detail::d_diff(differentiate(diff.a, x), differentiate(diff.b, x));
+    }
+  };
+
+  template <is_expression A>
+  struct differentiator<Negate<A>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Negate<A> const& negate, auto const& x)
+    {
+      return detail::d_negate(differentiate(negate.a, x));
+    }
+  };
+
+  /// The product rule, where the variable's indices are never contracted.
+  template <is_expression A, is_expression B>
+  struct differentiator<Product<A, B>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Product<A, B> const& product, auto const& x)
+    {
+      return detail::d_sum(detail::d_product(differentiate(product.a, x), product.b),
+                           detail::d_product(product.a, differentiate(product.b, x)));
+    }
+  };
+
+  template <is_expression A, std::integral B>
+  struct differentiator<Ratio<A, B>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Ratio<A, B> const& ratio, auto const& x)
+    {
+      auto da = differentiate(ratio.a, x);
+      if constexpr (is_zero_v<decltype(da)>) {
+        return da;
+      }
+      else {
+        return Ratio { std::move(da), ratio.b };
+      }
+    }
+  };
+
+  template <is_expression A>
+  struct differentiator<Lazy<A>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Lazy<A> const& lazy, auto const& x)
+    {
+      auto da = differentiate(lazy.a, x);
+      if constexpr (is_zero_v<decltype(da)>) {
+        return da;
+      }
+      else {
+        return Lazy { std::move(da) };
+      }
+    }
+  };
+
+  /// `∂(1/a) = -∂a / a^2` for scalars, and `∂A^-1 = -A^-1 ∂A A^-1` for
+  /// matrices.
+  template <is_expression A>
+  struct differentiator<Inverse<A>>
+  {
+    constexpr static bool enabled = true;
+
+    template <class X>
+    constexpr static auto apply(Inverse<A> const& inverse, X const& x)
+    {
+      if constexpr (order_v<A> == 0) {
+        return detail::d_negate(detail::d_product(Product { inverse, inverse },
+                                                  differentiate(inverse.a, x)));
+      }
+      else {
+        constexpr TensorIndex pq = outer_v<A>;
+        constexpr std::array mn = detail::fresh<2, A, X>();
+        constexpr TensorIndex pm(Index<pq[0], mn[0]>{});
+        constexpr TensorIndex nq(Index<mn[1], pq[1]>{});
+        constexpr TensorIndex to(Index<mn[0], mn[1]>{});
+        auto da = detail::rename<pq, to>(differentiate(inverse.a, x));
+        return detail::d_negate(detail::d_product(detail::d_product(Inverse<A>(inverse).template rebind<pm>(), std::move(da)),
+                                                  Inverse<A>(inverse).template rebind<nq>()));
+      }
+    }
+  };
+
+  /// `∂det(A) = det(A) A^-T : ∂A`.
+  template <is_expression A>
+  struct differentiator<Determinant<A>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Determinant<A> const& det, auto const& x)
+    {
+      constexpr TensorIndex pq = outer_v<A>;
+      constexpr TensorIndex qp = pq.reverse();
+      return detail::d_product(det, detail::d_product(Inverse { det.a }.template rebind<qp>(),
+                                                      differentiate(det.a, x)));
+    }
+  };
+
+  /// The chain rule through the cmath functions.
+  /// @{
+  template <is_expression A, CMathTag tag, cmath_policy P>
+  struct differentiator<CMath<A, tag, P>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(CMath<A, tag, P> const& cmath, auto const& x)
+    {
+      return detail::d_chain(CMathDerivative(cmath, nttp<0>), differentiate(cmath.a, x));
+    }
+  };
+
+  template <is_expression A, is_expression B, CMathTag tag, cmath_policy P>
+  struct differentiator<CMath2<A, B, tag, P>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(CMath2<A, B, tag, P> const& cmath, auto const& x)
+    {
+      return detail::d_sum(detail::d_chain(CMathDerivative(cmath, nttp<0>), differentiate(cmath.a, x)),
+                           detail::d_chain(CMathDerivative(cmath, nttp<1>), differentiate(cmath.b, x)));
+    }
+  };
+  /// @}
+
+  template <is_expression A, is_expression B>
+  struct differentiator<Chain<A, B>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Chain<A, B> const& chain, auto const& x)
+    {
+      return detail::d_sum(detail::d_chain(differentiate(chain.a, x), chain.b),
+                           detail::d_chain(chain.a, differentiate(chain.b, x)));
+    }
+  };
+
+  /// The partial derivative of `a` with respect to the bound tensor `x`.
+  ///
+  /// The outer index is the outer index of `a` followed by the index of `x`.
+  /// The materializer replaces the node with its derivative before the
+  /// assignment is evaluated. Evaluating an unmaterialized node (e.g., inside
+  /// of `lazy()`) builds the derivative for each element that it produces.
+  template <is_expression A, is_expression X>
+  struct Partial : Bindable<Partial<A, X>>
+  {
+    using scalar_type = scalar_type_t<A>;
+
+    A a;
+    X x;
+
+    constexpr Partial(A a, X x)
+        : a(std::move(a))
+        , x(std::move(x))
+    {
+      static_assert(is_tensor_bind_v<X> and order_v<X> == order_v<decltype(x.a)>,
+                    "differentiate with respect to a tensor bound to distinct indices (e.g., E(k,l))");
+      static_assert(not is_view_tag_v<decltype(X::tag())>, "views can't be variables");
+      static_assert([] {
+        for (char c : outer_v<X>) {
+          if (detail::mentions<A>(c)) {
+            return false;
+          }
+        }
+        return true;
+      }(), "the variable's indices must not appear in the expression");
+    }
+
+    constexpr static bool contains(auto&& tag)
+    {
+      return A::contains(FWD(tag));
+    }
+
+    /// Every element reads elements of `a` other than its own.
+    constexpr static bool may_alias(auto&& tag)
+    {
+      return A::contains(FWD(tag));
+    }
+
+    /// Evaluate into a scalar.
+    constexpr operator scalar_type() const requires (order_v<Partial> == 0)
+    {
+      return materialize(*this).evaluate(ScalarIndex<0>{});
+    }
+
+    constexpr static auto order() -> int
+    {
+      return outer().size();
+    }
+
+    constexpr static auto dim() -> int
+    {
+      return max(dim_v<A>, dim_v<X>);
+    }
+
+    constexpr static auto outer() -> is_tensor_index auto
+    {
+      return outer_v<A> + outer_v<X>;
+    }
+
+    constexpr auto evaluate(ScalarIndex<order_v<Partial>> const& i) const
+    {
+      auto d = differentiate(a, x);
+      constexpr TensorIndex l = outer_v<Partial>;
+      constexpr TensorIndex r = outer_v<decltype(d)>;
+      if constexpr (l == r) {
+        return d.evaluate(i);
+      }
+      else {
+        return d.evaluate(select<l, r>(i));
+      }
+    }
+  };
+
+  template <is_expression A, is_expression X>
+  struct materializer<Partial<A, X>>
+  {
+    constexpr static bool changes = true;
+
+    constexpr static auto apply(auto&& partial)
+    {
+      return materialize(differentiate(partial.a, partial.x));
+    }
+  };
+
+  /// Higher derivatives differentiate the derivative.
+  template <is_expression A, is_expression X>
+  struct differentiator<Partial<A, X>>
+  {
+    constexpr static bool enabled = true;
+
+    constexpr static auto apply(Partial<A, X> const& partial, auto const& x)
+    {
+      return differentiate(differentiate(partial.a, partial.x), x);
+    }
+  };
+}
+
+#endif // ALBERT_INCLUDE_DERIVATIVE_HPP
@@ -6,68 +6,384 @@
 #include "albert/TensorLayout.hpp"
 #include "albert/TensorStorage.hpp"
 #include "albert/concepts.hpp"
+#include "albert/simd.hpp"
+#include "albert/sparsity.hpp"
 #include "albert/utils.hpp"
+#include <array>
+#include <type_traits>
+#include <utility>
+
+/// Iteration spaces with at most this many elements are evaluated with a fully
+/// unrolled loop nest rather than the runtime `carry_sum_inc` odometer.
+#ifndef ALBERT_UNROLL_THRESHOLD
+#define ALBERT_UNROLL_THRESHOLD 81
+#endif
 
 namespace albert
 {
-  template <is_expression A, is_expression B>
-  [[gnu::noinline]]
-  constexpr auto evaluate(A&& a, B&& b, auto&& op) -> decltype(auto)
+  constexpr inline int unroll_threshold = ALBERT_UNROLL_THRESHOLD;
+
+  namespace detail
   {
-    static_assert(is_permutation(outer_v<A>, outer_v<B>));
-    static_assert(dim_v<A> == 0 || dim_v<B> == 0 || dim_v<A> == dim_v<B>);
+    /// Map a linear offset to the scalar index that it represents.
+    ///
+    /// The `axes` lists the axes from the slowest varying to the fastest, so
+    /// that the default is row-major.
+    template <int Order, int N>
+    constexpr auto unravel(int n, std::array<int, Order> const& axes = row_major_axes<Order>())
+      -> ScalarIndex<Order>
+    {
+      ScalarIndex<Order> i;
+      for (int k = Order - 1; k >= 0; --k) {
+        i[axes[k]] = n % N;
+        n /= N;
+      }
+      return i;
+    }
+
+    /// The scalar index for each linear offset, as a compile-time constant.
+    template <int Order, int N, std::array<int, Order> axes, int n>
+    constexpr inline ScalarIndex<Order> unravel_v = unravel<Order, N>(n, axes);
+
+    /// Visit each index in the iteration space with straight-line code.
+    ///
+    /// Each index is a compile-time constant and the whole visit is flattened,
+    /// so every offset that `f` computes folds to a constant.
+    template <int Order, int N, std::array<int, Order> axes, int... n>
+    [[gnu::flatten]]
+    constexpr void for_each_index_unrolled(auto&& f, std::integer_sequence<int, n...>)
+    {
+      (f(unravel_v<Order, N, axes, n>), ...);
+    }
+
+    /// Visit each index in a compile-time list with straight-line code.
+    template <auto const& indices, int... n>
+    [[gnu::flatten]]
+    constexpr void for_each_index_in(auto&& f, std::integer_sequence<int, n...>)
+    {
+      (f(indices[n]), ...);
+    }
+
+    /// Visit each index in the iteration space with the runtime odometer.
+    template <int Order, int N, std::array<int, Order> axes>
+    [[gnu::noinline]]
+    constexpr void for_each_index_loop(auto&& f)
+    {
+      ScalarIndex<Order> i;
+      if constexpr (axes == row_major_axes<Order>()) {
+        do {
+          f(i);
+        } while (carry_sum_inc<N>(i));
+      }
+      else {
+        // the same odometer, but carrying from the fastest axis in `axes`
+        while (true) {
+          f(i);
+          int k = Order - 1;
+          for (; k >= 0; --k) {
+            if (++i[axes[k]] < N) {
+              break;
+            }
+            i[axes[k]] = 0;
+          }
+          if (k < 0) {
+            return;
+          }
+        }
+      }
+    }
+  }
+
+  /// Visit each index in an `Order`, `N` iteration space.
+  ///
+  /// The `axes` order the visit from the slowest varying axis to the fastest,
+  /// the default is row-major. Small spaces are unrolled at compile time,
+  /// larger spaces use the odometer.
+  template <int Order, int N, std::array<int, Order> axes = row_major_axes<Order>()>
+  constexpr void for_each_index(auto&& f)
+  {
+    if constexpr (pow(N, Order) <= unroll_threshold) {
+      detail::for_each_index_unrolled<Order, N, axes>(FWD(f), std::make_integer_sequence<int, pow(N, Order)>());
+    }
+    else {
+      detail::for_each_index_loop<Order, N, axes>(FWD(f));
+    }
+  }
 
-    constexpr TensorIndex l = outer_v<A>;
-    constexpr TensorIndex r = outer_v<B>;
+  /// The order in which to visit the outer index of an expression, so that
+  /// its storage is walked with unit stride, from the slowest varying axis to
+  /// the fastest. Expressions without storage are visited in row-major order.
+  template <class A>
+  constexpr inline std::array<int, order_v<A>> storage_order_v = [] {
+    if constexpr (requires { std::remove_cvref_t<A>::storage_order(); }) {
+      return std::remove_cvref_t<A>::storage_order();
+    }
+    else {
+      return row_major_axes<order_v<A>>();
+    }
+  }();
+
+  /// Visit each index that an assignment to `A` needs to write.
+  ///
+  /// This is every index in the iteration space, in `A`'s storage order,
+  /// unless `A` has packed storage that provides a list of the unique indices
+  /// that it stores.
+  template <class A, int N>
+  constexpr void for_each_index_of(auto&& f)
+  {
+    constexpr int Order = order_v<A>;
+    if constexpr (requires { std::remove_cvref_t<A>::storage_indices(); }) {
+      constexpr auto const& indices = std::remove_cvref_t<A>::storage_indices();
+      constexpr int size = indices.size();
+      if constexpr (size <= unroll_threshold) {
+        detail::for_each_index_in<indices>(FWD(f), std::make_integer_sequence<int, size>());
+      }
+      else {
+        for (auto const& i : indices) {
+          f(i);
+        }
+      }
+    }
+    else {
+      for_each_index<Order, N, storage_order_v<A>>(FWD(f));
+    }
+  }
+
+  /// The assignment operators.
+  ///
+  /// Evaluation can reason about these, e.g., accumulating an expression
+  /// doesn't need to visit the elements where it is zero.
+  namespace ops
+  {
+    struct assign
+    {
+      constexpr void operator()(auto&& a, auto&& b) const
+      {
+        FWD(a) = FWD(b);
+      }
+    };
+
+    struct add
+    {
+      constexpr void operator()(auto&& a, auto&& b) const
+      {
+        FWD(a) += FWD(b);
+      }
+    };
+
+    struct subtract
+    {
+      constexpr void operator()(auto&& a, auto&& b) const
+      {
+        FWD(a) -= FWD(b);
+      }
+    };
+
+    template <class Op>
+    constexpr inline bool is_assignment_v = (std::is_same_v<std::remove_cvref_t<Op>, assign> or
+                                             std::is_same_v<std::remove_cvref_t<Op>, add> or
+                                             std::is_same_v<std::remove_cvref_t<Op>, subtract>);
+  }
+
+  /// Evaluate an assignment of a diagonal expression (see `diagonal`).
+  ///
+  /// Overwriting assignments zero the left-hand-side first, and then the
+  /// right-hand-side is only evaluated on its diagonal, e.g., `C(i,j,k,l) +=
+  /// δ(i,k) * δ(j,l)` visits `N^2` elements rather than `N^4`.
+  template <Diagonal diagonal, is_expression A, is_expression B>
+  constexpr auto evaluate_diagonal(A&& a, B&& b, auto&& op) -> decltype(auto)
+  {
     constexpr int Order = order_v<A>;
     constexpr int N = max(dim_v<A>, dim_v<B>);
+    constexpr int M = diagonal.n;
 
-    ScalarIndex<Order> i;
-    do {
+    if constexpr (std::is_same_v<std::remove_cvref_t<decltype(op)>, ops::assign>) {
+      for_each_index_of<A, N>([&](ScalarIndex<Order> const& i) {
+        op(a.evaluate(i), scalar_type_t<B>{});
+      });
+    }
+
+    for_each_index<M, N>([&](ScalarIndex<M> const& j) {
+      constexpr TensorIndex l = outer_v<A>;
+      constexpr TensorIndex r = outer_v<B>;
+      ScalarIndex<Order> i;
+      for (int p = 0; p < Order; ++p) {
+        i[p] = j[diagonal.axis(p)];
+      }
       if constexpr (l == r) {
         op(a.evaluate(i), b.evaluate(i));
       }
       else {
         op(a.evaluate(i), b.evaluate(select<l, r>(i)));
       }
-    } while (carry_sum_inc<N>(i));
+    });
 
     return FWD(a);
   }
 
   template <is_expression A, is_expression B>
-  [[gnu::noinline]]
+  constexpr auto evaluate(A&& a, B&& b, auto&& op) -> decltype(auto)
+  {
+    static_assert(is_permutation(outer_v<A>, outer_v<B>));
+    static_assert(dim_v<A> == 0 || dim_v<B> == 0 || dim_v<A> == dim_v<B>);
+
+    constexpr int Order = order_v<A>;
+    constexpr int N = max(dim_v<A>, dim_v<B>);
+
+    // diagonal right-hand-sides are evaluated on their diagonal, unless the
+    // left-hand-side has packed storage
+    constexpr Diagonal diagonal = diagonal_of<B, Order>(outer_v<A>);
+    if constexpr (not diagonal.is_dense() and ops::is_assignment_v<decltype(op)> and
+                  not requires { std::remove_cvref_t<A>::storage_indices(); }) {
+      return evaluate_diagonal<diagonal>(FWD(a), FWD(b), FWD(op));
+    }
+    else {
+      // visit the left-hand-side in its storage order
+      for_each_index_of<A, N>([&](ScalarIndex<Order> const& i) {
+        constexpr TensorIndex l = outer_v<A>;
+        constexpr TensorIndex r = outer_v<B>;
+        if constexpr (l == r) {
+          op(a.evaluate(i), b.evaluate(i));
+        }
+        else {
+          op(a.evaluate(i), b.evaluate(select<l, r>(i)));
+        }
+      });
+
+      return FWD(a);
+    }
+  }
+
+  template <is_expression A, is_expression B>
   constexpr auto evaluate_via_temp(A&& a, B&& b, auto&& op) -> decltype(auto)
   {
     static_assert(is_permutation(outer_v<A>, outer_v<B>));
     static_assert(dim_v<A> == 0 || dim_v<B> == 0 || dim_v<A> == dim_v<B>);
 
-    constexpr TensorIndex l = outer_v<A>;
-    constexpr TensorIndex r = outer_v<B>;
     constexpr int Order = order_v<A>;
     constexpr int N = max(dim_v<A>, dim_v<B>);
     using T = scalar_type_t<A>;
 
-    constexpr RowMajor<Order, N> map = {};
+    // the temp shares the left-hand-side's storage order, so that both loops
+    // walk both the temp and the left-hand-side with unit stride
+    constexpr std::array axes = storage_order_v<A>;
+    constexpr Layout<Order, N, axes> map = {};
     DenseStorage<T, Order, N> temp;
 
-    { // first evaluate into the temp storage
+    // first evaluate into the temp storage
+    for_each_index_of<A, N>([&](ScalarIndex<Order> const& i) {
+      constexpr TensorIndex l = outer_v<A>;
+      constexpr TensorIndex r = outer_v<B>;
+      if constexpr (l == r) {
+        temp[map(i)] = b.evaluate(i);
+      }
+      else {
+        temp[map(i)] = b.evaluate(select<l, r>(i));
+      }
+    });
+
+    // copy out (or accumulate) to the left-hand-side
+    for_each_index_of<A, N>([&](ScalarIndex<Order> const& i) {
+      op(a.evaluate(i), temp[map(i)]);
+    });
+
+    return FWD(a);
+  }
+
+  /// Evaluate an assignment through a temporary for one row at a time.
+  ///
+  /// This is used when the right-hand-side only reads the left-hand-side
+  /// within the row being written (e.g., `A(i,j) = A(i,k) * B(k,j)`), where
+  /// rows are along the slowest varying axis of the left-hand-side's storage.
+  /// Each row is evaluated into the temp before any of it is written.
+  template <is_expression A, is_expression B>
+  constexpr auto evaluate_via_row_temp(A&& a, B&& b, auto&& op) -> decltype(auto)
+  {
+    static_assert(is_permutation(outer_v<A>, outer_v<B>));
+    static_assert(dim_v<A> == 0 || dim_v<B> == 0 || dim_v<A> == dim_v<B>);
+    static_assert(order_v<A> != 0);
+
+    constexpr int Order = order_v<A>;
+    constexpr int N = max(dim_v<A>, dim_v<B>);
+    using T = scalar_type_t<A>;
+
+    // the row is along the first axis in storage order, and its elements are
+    // visited in the storage order of the rest
+    constexpr std::array axes = storage_order_v<A>;
+    constexpr std::array rest = [] {
+      std::array<int, Order - 1> rest = {};
+      for (int p = 0; p < Order - 1; ++p) {
+        rest[p] = storage_order_v<A>[p + 1];
+      }
+      return rest;
+    }();
+    DenseStorage<T, Order - 1, N> temp;
+
+    auto index = [&](int x, ScalarIndex<Order - 1> const& j) {
       ScalarIndex<Order> i;
-      do {
+      i[axes[0]] = x;
+      for (int p = 0; p < Order - 1; ++p) {
+        i[rest[p]] = j[p];
+      }
+      return i;
+    };
+
+    for (int x = 0; x < N; ++x) {
+      int n = 0;
+      for_each_index<Order - 1, N>([&](ScalarIndex<Order - 1> const& j) {
+        constexpr TensorIndex l = outer_v<A>;
+        constexpr TensorIndex r = outer_v<B>;
         if constexpr (l == r) {
-          temp[map(i)] = b.evaluate(i);
+          temp[n++] = b.evaluate(index(x, j));
         }
         else {
-          temp[map(i)] = b.evaluate(select<l, r>(i));
+          temp[n++] = b.evaluate(select<l, r>(index(x, j)));
         }
-      } while (carry_sum_inc<N>(i));
+      });
+
+      n = 0;
+      for_each_index<Order - 1, N>([&](ScalarIndex<Order - 1> const& j) {
+        op(a.evaluate(index(x, j)), temp[n++]);
+      });
     }
 
-    { // copy out (or accumulate) to the left-hand-side
-      ScalarIndex<Order> i;
-      do {
-        op(a.evaluate(i), temp[map(i)]);
-      } while (carry_sum_inc<N>(i));
+    return FWD(a);
+  }
+
+  /// Evaluate an elementwise assignment as a streaming loop over storage.
+  ///
+  /// The left-hand-side and every leaf in the right-hand-side share a single
+  /// layout, so element `n` of the result only depends on element `n` of
+  /// each leaf. Whole vectors are processed first, followed by a scalar tail.
+  ///
+  /// Padded layouts are streamed in full, padding included. Layouts that are
+  /// aligned to less than a full vector are streamed with vectors of their
+  /// alignment, so a layout that is padded to whole vectors has no tail.
+  template <is_vectorizable A, is_vectorizable B>
+  auto evaluate_linear(A&& a, B&& b, auto&& op) -> decltype(auto)
+  {
+    static_assert(outer_v<A> == outer_v<B>);
+    static_assert(std::is_same_v<scalar_type_t<A>, scalar_type_t<B>>);
+
+    using T = scalar_type_t<A>;
+    using Layout = vector_layout_t<A>;
+    constexpr int size = Layout::size;
+    constexpr int align = Layout::align;
+    constexpr int bytes = (int(sizeof(T)) < align and align < simd_bytes) ? align : simd_bytes;
+    using V = simd_t<T, bytes>;
+    constexpr int W = simd_width_v<T, bytes>;
+
+    T* out = a.a.data();
+
+    int n = 0;
+    for (; n + W <= size; n += W) {
+      V lhs = simd_load<V, align>(out + n);
+      op(lhs, vectorize<V>(b, n));
+      simd_store<V, align>(out + n, lhs);
+    }
+
+    for (; n < size; ++n) {
+      op(out[n], vectorize<T>(b, n));
     }
 
     return FWD(a);
@@ -4,11 +4,22 @@
 #include "albert/Bind.hpp"
 #include "albert/Index.hpp"
 #include "albert/ScalarIndex.hpp"
+#include "albert/Tensor.hpp"
 #include "albert/cmath.hpp"
 #include "albert/concepts.hpp"
+#include "albert/cse.hpp"
+#include "albert/materialize.hpp"
+#include "albert/simd.hpp"
 #include "albert/solver.hpp"
+#include "albert/sparsity.hpp"
+#include "albert/symmetry.hpp"
 #include "albert/utils.hpp"
+#include <algorithm>
+#include <array>
 #include <bit>
+#include <cstdint>
+#include <string>
+#include <tuple>
 #include <utility>
 
 namespace albert
@@ -93,6 +104,63 @@ namespace albert
   template <is_expression A, is_expression B>
   Sum(A, B) -> Sum<A, B>;
 
+  template <is_expression A, is_expression B>
+  struct materializer<Sum<A, B>>
+  {
+    constexpr static bool changes = materializer<A>::changes || materializer<B>::changes;
+
+    constexpr static auto apply(auto&& sum)
+    {
+      return Sum { materialize(FWD(sum).a), materialize(FWD(sum).b) };
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct subexpression<Sum<A, B>> : stateless_subexpression<2>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a, auto&& b)
+    {
+      return Sum { FWD(a), FWD(b) };
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct dependence<Sum<A, B>> : local_dependence<> {};
+
+  template <is_vectorizable A, is_vectorizable B>
+  requires (outer_v<A> == outer_v<B> and
+            std::is_same_v<scalar_type_t<A>, scalar_type_t<B>> and
+            same_vector_layout_v<A, B>)
+  struct vectorizer<Sum<A, B>>
+  {
+    constexpr static bool enabled = true;
+    using layout = common_vector_layout_t<A, B>;
+
+    template <class V>
+    static auto apply(Sum<A, B> const& sum, int n) -> V
+    {
+      return vectorize<V>(sum.a, n) + vectorize<V>(sum.b, n);
+    }
+  };
+
+  template <class A, class B>
+  struct symmetry<Sum<A, B>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_symmetric_in<A>(a, b) and is_symmetric_in<B>(a, b);
+    }
+  };
+
+  template <class A, class B>
+  struct diagonal<Sum<A, B>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_diagonal_in<A>(a, b) and is_diagonal_in<B>(a, b);
+    }
+  };
+
   template <is_expression A, is_expression B>
   struct Diff : Addition<A, B>, Bindable<Diff<A, B>>
   {
@@ -117,6 +185,90 @@ namespace albert
   template <is_expression A, is_expression B>
   Diff(A, B) -> Diff<A, B>;
 
+  template <is_expression A, is_expression B>
+  struct materializer<Diff<A, B>>
+  {
+    constexpr static bool changes = materializer<A>::changes || materializer<B>::changes;
+
+    constexpr static auto apply(auto&& diff)
+    {
+      return Diff { materialize(FWD(diff).a), materialize(FWD(diff).b) };
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct subexpression<Diff<A, B>> : stateless_subexpression<2>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a, auto&& b)
+    {
+      return Diff { FWD(a), FWD(b) };
+    }
+  };
+
+  template <is_expression A, is_expression B>
+  struct dependence<Diff<A, B>> : local_dependence<> {};
+
+  template <is_vectorizable A, is_vectorizable B>
+  requires (outer_v<A> == outer_v<B> and
+            std::is_same_v<scalar_type_t<A>, scalar_type_t<B>> and
+            same_vector_layout_v<A, B>)
+  struct vectorizer<Diff<A, B>>
+  {
+    constexpr static bool enabled = true;
+    using layout = common_vector_layout_t<A, B>;
+
+    template <class V>
+    static auto apply(Diff<A, B> const& diff, int n) -> V
+    {
+      return vectorize<V>(diff.a, n) - vectorize<V>(diff.b, n);
+    }
+  };
+
+  template <class A, class B>
+  struct symmetry<Diff<A, B>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_symmetric_in<A>(a, b) and is_symmetric_in<B>(a, b);
+    }
+  };
+
+  template <class A, class B>
+  struct diagonal<Diff<A, B>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_diagonal_in<A>(a, b) and is_diagonal_in<B>(a, b);
+    }
+  };
+
+  namespace detail
+  {
+    /// Find disjoint pairs of positions in an inner index in which both
+    /// operands of a product are symmetric.
+    template <class A, class B, int I>
+    constexpr auto symmetric_pairs(TensorIndex<I> const& inner)
+    {
+      struct {
+        std::array<std::array<int, 2>, I / 2 + 1> pairs = {};
+        int n = 0;
+      } out;
+
+      bool used[I + 1] = {};
+      for (int p = 0; p < inner.size(); ++p) {
+        for (int q = p + 1; q < inner.size() and not used[p]; ++q) {
+          if (not used[q] and
+              is_symmetric_in<A>(inner[p], inner[q]) and
+              is_symmetric_in<B>(inner[p], inner[q])) {
+            used[p] = used[q] = true;
+            out.pairs[out.n++] = { p, q };
+          }
+        }
+      }
+      return out;
+    }
+  }
+
   template <is_expression A, is_expression B>
   struct Product : Bindable<Product<A, B>>
   {
@@ -141,13 +293,15 @@ namespace albert
     {
       // if there's a contraction and one of my children contains the tag then
       // we may alias
-      return ((outer_v<A> & outer_v<B>).size() and contains(FWD(tag)));
+      return (A::may_alias(FWD(tag)) ||
+              B::may_alias(FWD(tag)) ||
+              ((outer_v<A> & outer_v<B>).size() and contains(FWD(tag))));
     }
 
     /// Evaluate into a scalar.
     constexpr operator scalar_type() const requires (order_v<Product> == 0)
     {
-      return evaluate(ScalarIndex<0>{});
+      return materialize(*this).evaluate(ScalarIndex<0>{});
     }
 
     constexpr static auto order() -> int
@@ -168,29 +322,497 @@ namespace albert
       return c;
     }
 
+    /// The contracted indices.
+    constexpr static auto inner() -> is_tensor_index auto
+    {
+      constexpr TensorIndex a = outer_v<A>;
+      constexpr TensorIndex b = outer_v<B>;
+      constexpr TensorIndex c = a & b;
+      return c;
+    }
+
     constexpr auto evaluate(ScalarIndex<order_v<Product>> const& i) const
       -> auto
     {
       constexpr TensorIndex outer = outer_v<Product>;
       constexpr TensorIndex     l = outer_v<A>;
       constexpr TensorIndex     r = outer_v<B>;
-      constexpr TensorIndex inner = l & r;
+      constexpr TensorIndex inner = inner_v<Product>;
       constexpr TensorIndex   all = outer + inner;
       constexpr int     N = dim();
-      constexpr int Order = outer.size();
       constexpr int     I = inner.size();
 
       auto rhs = [&](auto const& index) {
         return a.evaluate(select<all, l>(index)) * b.evaluate(select<all, r>(index));
       };
 
-      ScalarIndex<Order + I> j(i);
-      decltype(rhs(j)) temp{};
-      do {
-        temp += rhs(j);
-      } while (carry_sum_inc<N, Order>(j));
+      // Diagonal products (e.g., `A(i,j) * δ(k,l)`) are zero off of their
+      // diagonal, without evaluating either operand.
+      constexpr Diagonal diagonal = diagonal_of<Product, order_v<Product>>(outer);
+      if constexpr (not diagonal.is_dense()) {
+        for (int p = 0; p < order_v<Product>; ++p) {
+          if (i[p] != i[diagonal.first[p]]) {
+            return decltype(rhs(i + ScalarIndex<I>{})){};
+          }
+        }
+      }
+
+      // Contracted pairs in which both operands are symmetric (e.g., `kl` in
+      // `C(i,j,k,l) * e(k,l)`) only visit the pairs with `j[p] <= j[q]`, and
+      // count the off-diagonal terms twice.
+      constexpr auto symmetric = detail::symmetric_pairs<A, B>(inner_v<Product>);
+      constexpr int P = symmetric.n;
+
+      decltype(rhs(i + ScalarIndex<I>{})) temp{};
+      for_each_index<I, N>([&](ScalarIndex<I> const& j) {
+        if constexpr (P == 0) {
+          temp += rhs(i + j);
+        }
+        else {
+          for (int k = 0; k < P; ++k) {
+            if (j[symmetric.pairs[k][0]] > j[symmetric.pairs[k][1]]) {
+              return;
+            }
+          }
+          auto term = rhs(i + j);
+          for (int k = 0; k < P; ++k) {
+            if (j[symmetric.pairs[k][0]] != j[symmetric.pairs[k][1]]) {
+              term += term;
+            }
+          }
+          temp += term;
+        }
+      });
       return temp;
     }
+
+  };
+
+  /// The outer product of a symmetric operand is symmetric.
+  template <class A, class B>
+  struct symmetry<Product<A, B>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      constexpr TensorIndex l = outer_v<A>;
+      constexpr TensorIndex r = outer_v<B>;
+      auto in = [](auto const& index, char c) { return index.count(c) != 0; };
+      return ((is_symmetric_in<A>(a, b) and not in(r, a) and not in(r, b)) or
+              (is_symmetric_in<B>(a, b) and not in(l, a) and not in(l, b)));
+    }
+  };
+
+  /// The outer product of a diagonal operand is diagonal.
+  template <class A, class B>
+  struct diagonal<Product<A, B>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      constexpr TensorIndex l = outer_v<A>;
+      constexpr TensorIndex r = outer_v<B>;
+      auto in = [](auto const& index, char c) { return index.count(c) != 0; };
+      return ((is_diagonal_in<A>(a, b) and not in(r, a) and not in(r, b)) or
+              (is_diagonal_in<B>(a, b) and not in(l, a) and not in(l, b)));
+    }
+  };
+
+  template <class>
+  constexpr inline bool is_product_v = false;
+
+  template <class A, class B>
+  constexpr inline bool is_product_v<Product<A, B>> = true;
+
+  /// Contraction path search.
+  ///
+  /// The grammar builds left-associative product trees in source order, which
+  /// is often not the cheapest order in which to perform the contractions,
+  /// e.g., `A(i,j) * B(j,k) * v(k)` costs `N^3 + N^2` while `A(i,j) *
+  /// (B(j,k) * v(k))` costs `2N^2`. Before evaluation each maximal product
+  /// tree is flattened into its operands and re-associated into the lowest-cost
+  /// tree.
+  ///
+  /// Operands keep their source order, only the association changes, so the
+  /// outer index of the product (and thus its meaning) is unchanged. Each
+  /// intermediate is assumed to be evaluated once, i.e., materialized, and
+  /// costs `N^k` multiply-adds where `k` is the number of distinct indices in
+  /// its two children.
+  namespace contraction
+  {
+    /// Flatten a product tree into a tuple of its operands in source order.
+    template <class E>
+    constexpr auto operands(E&& e)
+    {
+      if constexpr (is_product_v<std::remove_cvref_t<E>>) {
+        return std::tuple_cat(operands(FWD(e).a), operands(FWD(e).b));
+      }
+      else {
+        return std::tuple<std::remove_cvref_t<E>>(FWD(e));
+      }
+    }
+
+    /// The result of the path search for `M` operands.
+    template <int M>
+    struct Path
+    {
+      bool valid = true;                        //!< is this einstein notation
+      std::array<std::array<int, M>, M> split = {};
+      std::array<std::array<long, M>, M> cost = {};
+      long source_cost = 0;                     //!< cost of the source order
+
+      constexpr auto optimal_cost() const -> long
+      {
+        return cost[0][M - 1];
+      }
+    };
+
+    /// Find the lowest-cost association of the operands `Ts...`.
+    ///
+    /// This is the standard interval dynamic program for chain products, where
+    /// the index sets are tracked as bitmasks over the distinct characters.
+    /// Ties are broken in favor of the left-associative split, so a source tree
+    /// that is already optimal is left alone.
+    template <class... Ts>
+    constexpr auto search() -> Path<sizeof...(Ts)>
+    {
+      constexpr int M = sizeof...(Ts);
+      constexpr int N = [] {
+        int n = 0;
+        ((n = max(n, dim_v<Ts>)), ...);
+        return n;
+      }();
+
+      Path<M> path;
+
+      // Map each operand's outer index to a bitmask over the distinct
+      // characters, and count character occurrences.
+      std::array<char, 64> chars = {};
+      std::array<int, 64> counts = {};
+      int n_chars = 0;
+      std::array<uint64_t, M> masks = {};
+
+      int m = 0;
+      ([&](is_tensor_index auto const& outer) {
+        for (char c : outer) {
+          int k = 0;
+          while (k < n_chars and chars[k] != c) {
+            ++k;
+          }
+          if (k == n_chars) {
+            if (n_chars == 64) {
+              path.valid = false;
+              return;
+            }
+            chars[n_chars++] = c;
+          }
+          counts[k] += 1;
+          masks[m] |= uint64_t(1) << k;
+        }
+        ++m;
+      }(outer_v<Ts>), ...);
+
+      // Reassociation is only valid if every index appears at most twice.
+      for (int k = 0; k < n_chars; ++k) {
+        path.valid &= (counts[k] <= 2);
+      }
+
+      // The outer index of the interval [i, j] is the symmetric difference of
+      // its operands' indices.
+      auto outer = [&](int i, int j) {
+        uint64_t mask = 0;
+        for (int k = i; k <= j; ++k) {
+          mask ^= masks[k];
+        }
+        return mask;
+      };
+
+      auto flops = [&](int i, int k, int j) -> long {
+        long n = 1;
+        for (int c = std::popcount(outer(i, k) | outer(k + 1, j)); c > 0; --c) {
+          n *= N;
+        }
+        return n;
+      };
+
+      for (int w = 1; w < M; ++w) {
+        for (int i = 0, j = w; j < M; ++i, ++j) {
+          path.split[i][j] = j - 1;
+          path.cost[i][j] = path.cost[i][j - 1] + flops(i, j - 1, j);
+          for (int k = j - 2; k >= i; --k) {
+            long cost = path.cost[i][k] + path.cost[k + 1][j] + flops(i, k, j);
+            if (cost < path.cost[i][j]) {
+              path.split[i][j] = k;
+              path.cost[i][j] = cost;
+            }
+          }
+        }
+      }
+
+      for (int j = 1; j < M; ++j) {
+        path.source_cost += flops(0, j - 1, j);
+      }
+
+      return path;
+    }
+
+    template <class... Ts>
+    constexpr inline Path<sizeof...(Ts)> path_v = search<Ts...>();
+
+    /// Rebuild the product tree for the interval [i, j] from the path.
+    template <auto const& path, int i, int j, class... Ts>
+    constexpr auto build(std::tuple<Ts...>& operands)
+    {
+      if constexpr (i == j) {
+        return std::move(std::get<i>(operands));
+      }
+      else {
+        constexpr int k = path.split[i][j];
+        return Product {
+          build<path, i, k>(operands),
+          build<path, k + 1, j>(operands)
+        };
+      }
+    }
+
+    template <class... Ts>
+    constexpr auto rebuild(std::tuple<Ts...>&& operands)
+    {
+      constexpr auto const& path = path_v<Ts...>;
+      return build<path, 0, sizeof...(Ts) - 1>(operands);
+    }
+
+    /// Re-associate a product tree into its lowest-cost form.
+    template <class E>
+    constexpr auto reassociate(E&& e)
+    {
+      using Operands = decltype(operands(FWD(e)));
+      if constexpr (not []<class... Ts>(std::tuple<Ts...>*) {
+          return path_v<Ts...>.valid;
+        }(static_cast<Operands*>(nullptr))) {
+        return std::remove_cvref_t<E>(FWD(e));
+      }
+      else {
+        return rebuild(operands(FWD(e)));
+      }
+    }
+
+    template <class E>
+    using reassociated_t = decltype(reassociate(std::declval<E>()));
+
+    /// Append a description of an operand, or the tree rooted at `e`.
+    template <class E>
+    auto describe(std::string& out)
+    {
+      if constexpr (is_product_v<E>) {
+        out += "(";
+        describe<decltype(std::declval<E>().a)>(out);
+        out += " * ";
+        describe<decltype(std::declval<E>().b)>(out);
+        out += ")";
+      }
+      else if constexpr (order_v<E> == 0) {
+        out += "_";
+      }
+      else {
+        for (char c : outer_v<E>) {
+          out += c;
+        }
+      }
+    }
+  }
+
+  /// Describe the contraction path that will be used to evaluate `e`.
+  ///
+  /// The description has the form
+  ///
+  ///     ij * jk * k -> i: (ij * (jk * k)), cost 18 (source order 36)
+  ///
+  /// where the costs are the number of multiply-adds performed by the
+  /// contractions for dimension `N`, and scalar operands are shown as `_`.
+  template <is_expression E>
+  auto contraction_path(E&&) -> std::string
+  {
+    using namespace contraction;
+    using Operands = decltype(operands(std::declval<E>()));
+    using Reassociated = reassociated_t<E>;
+
+    std::string out;
+    [&]<class... Ts>(std::tuple<Ts...>*) {
+      int m = 0;
+      ((out += (m++ ? " * " : ""), describe<Ts>(out)), ...);
+      out += " -> ";
+      for (char c : outer_v<E>) {
+        out += c;
+      }
+      out += ": ";
+      describe<Reassociated>(out);
+      if constexpr (sizeof...(Ts) > 1) {
+        constexpr auto const& path = path_v<Ts...>;
+        if (path.valid) {
+          out += ", cost " + std::to_string(path.optimal_cost());
+          out += " (source order " + std::to_string(path.source_cost) + ")";
+        }
+      }
+    }(static_cast<Operands*>(nullptr));
+    return out;
+  }
+
+  namespace cse
+  {
+    template <class T>
+    void describe(std::string& out)
+    {
+      using S = sharing<T>;
+      if constexpr (S::changes) {
+        contraction::describe<typename S::type>(out);
+        out += " -> ";
+        for (char c : outer_v<typename S::type>) {
+          out += c;
+        }
+        out += " x" + std::to_string(S::count) + "\n";
+        describe<typename S::result>(out);
+      }
+    }
+  }
+
+  /// Describe the common subexpressions that are shared when `e` is assigned.
+  ///
+  /// Each shared subtree is described on its own line, largest first, as
+  ///
+  ///     (ik * kj) -> ij x2
+  ///
+  /// where the count is the number of times the subtree appears. The
+  /// description is empty when nothing is shared.
+  template <is_expression E>
+  auto common_subexpressions(E&&) -> std::string
+  {
+    std::string out;
+    cse::describe<std::remove_cvref_t<E>>(out);
+    return out;
+  }
+
+  namespace kronecker
+  {
+    template <class E>
+    struct eliminator;
+  }
+
+  namespace levi_civita
+  {
+    template <class E>
+    struct grouper;
+  }
+
+  /// Materialize nested contractions.
+  ///
+  /// A product evaluates both of its children once for every (outer, inner)
+  /// index pair. If a child is itself a contraction, and its sibling carries
+  /// indices that the child doesn't, then each element of the child is
+  /// recomputed once for each value of those indices, e.g., `A(i,j) * B(j,k) *
+  /// C(k,l)` evaluates `A * B` `N` times per output element. Such children are
+  /// evaluated once into a stack temporary before the parent is evaluated.
+  ///
+  /// Contracted deltas are eliminated first (see `kronecker`), contracted
+  /// Levi-Civita symbols are pulled out of the tree (see `levi_civita`), and
+  /// then the product tree is re-associated into its lowest-cost form.
+  ///
+  /// Use `lazy()` to opt a subtree out of this transformation.
+  template <is_expression A, is_expression B>
+  struct materializer<Product<A, B>>
+  {
+    /// Should the child `C` with sibling `S` be evaluated into a temporary.
+    template <class C, class S>
+    constexpr static bool temporary = []
+    {
+      if constexpr (is_product_v<C>) {
+        return (inner_v<C>.size() != 0 and
+                (outer_v<S> - outer_v<C>).size() != 0 and
+                dim_v<C> != 0);
+      }
+      else {
+        return false;
+      }
+    }();
+
+    /// Are there any contracted deltas.
+    constexpr static bool eliminates = kronecker::eliminator<Product<A, B>>::changes;
+
+    /// Is there a contracted Levi-Civita symbol.
+    constexpr static bool groups = levi_civita::grouper<Product<A, B>>::changes;
+
+    /// Does the contraction path search pick a different tree.
+    constexpr static bool reassociates =
+      not std::is_same_v<contraction::reassociated_t<Product<A, B>>, Product<A, B>>;
+
+    constexpr static bool changes = (eliminates ||
+                                     groups ||
+                                     reassociates ||
+                                     materializer<A>::changes ||
+                                     materializer<B>::changes ||
+                                     temporary<A, B> ||
+                                     temporary<B, A>);
+
+    template <class C, class S>
+    constexpr static auto operand(auto&& c)
+    {
+      if constexpr (temporary<C, S>) {
+        Tensor<scalar_type_t<C>, order_v<C>, dim_v<C>> t = FWD(c);
+        return std::move(t).template rebind<outer_v<C>>();
+      }
+      else {
+        return std::remove_cvref_t<decltype(c)>(FWD(c));
+      }
+    }
+
+    constexpr static auto apply(auto&& product)
+    {
+      if constexpr (eliminates) {
+        return materialize(kronecker::eliminator<Product<A, B>>::apply(FWD(product)));
+      }
+      else if constexpr (groups) {
+        return materialize(levi_civita::grouper<Product<A, B>>::apply(FWD(product)));
+      }
+      else if constexpr (reassociates) {
+        return materialize(contraction::reassociate(FWD(product)));
+      }
+      else {
+        return Product {
+          operand<A, B>(materialize(FWD(product).a)),
+          operand<B, A>(materialize(FWD(product).b))
+        };
+      }
+    }
+  };
+
+  /// Only contractions are worth sharing.
+  template <is_expression A, is_expression B>
+  struct subexpression<Product<A, B>> : stateless_subexpression<2, inner_v<Product<A, B>>.size() == 0>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a, auto&& b)
+    {
+      return Product { FWD(a), FWD(b) };
+    }
+  };
+
+  /// Products read their operands at every value of their contracted
+  /// characters.
+  template <is_expression A, is_expression B>
+  struct dependence<Product<A, B>> : local_dependence<inner_v<Product<A, B>>> {};
+
+  /// Products are only elementwise when one side is a scalar.
+  template <is_vectorizable A, is_vectorizable B>
+  requires ((order_v<A> == 0) != (order_v<B> == 0) and
+            std::is_same_v<scalar_type_t<std::conditional_t<order_v<A> == 0, B, A>>,
+                           scalar_type_t<Product<A, B>>>)
+  struct vectorizer<Product<A, B>>
+  {
+    constexpr static bool enabled = true;
+    using layout = vector_layout_t<std::conditional_t<order_v<A> == 0, B, A>>;
+
+    template <class V>
+    static auto apply(Product<A, B> const& product, int n) -> V
+    {
+      return vectorize<V>(product.a, n) * vectorize<V>(product.b, n);
+    }
   };
 
   /// Represent a scalar division operation for an integral divisor.
@@ -258,6 +880,69 @@ namespace albert
     }
   };
 
+  template <is_expression A, std::integral B>
+  struct materializer<Ratio<A, B>>
+  {
+    constexpr static bool changes = materializer<A>::changes;
+
+    constexpr static auto apply(auto&& ratio)
+    {
+      return Ratio { materialize(FWD(ratio).a), ratio.b };
+    }
+  };
+
+  template <is_expression A, std::integral B>
+  struct subexpression<Ratio<A, B>>
+  {
+    constexpr static int arity = 1;
+    constexpr static bool elementwise = true;
+
+    constexpr static bool same(Ratio<A, B> const& x, Ratio<A, B> const& y)
+    {
+      return x.b == y.b;
+    }
+
+    constexpr static auto rebuild(auto&& ratio, auto&& a)
+    {
+      return Ratio { FWD(a), ratio.b };
+    }
+  };
+
+  template <is_expression A, std::integral B>
+  struct dependence<Ratio<A, B>> : local_dependence<> {};
+
+  template <is_vectorizable A, std::integral B>
+  requires (std::is_same_v<scalar_type_t<A>, scalar_type_t<Ratio<A, B>>>)
+  struct vectorizer<Ratio<A, B>>
+  {
+    constexpr static bool enabled = true;
+    using layout = vector_layout_t<A>;
+
+    template <class V>
+    static auto apply(Ratio<A, B> const& ratio, int n) -> V
+    {
+      return vectorize<V>(ratio.a, n) / simd_broadcast<V>(ratio.b);
+    }
+  };
+
+  template <class A, class B>
+  struct symmetry<Ratio<A, B>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_symmetric_in<A>(a, b);
+    }
+  };
+
+  template <class A, class B>
+  struct diagonal<Ratio<A, B>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_diagonal_in<A>(a, b);
+    }
+  };
+
   template <is_expression A>
   struct Negate : Bindable<Negate<A>>
   {
@@ -301,39 +986,96 @@ namespace albert
     }
   };
 
-  template <is_expression A, is_tensor_index auto index>
-  struct Partial : Bindable<Partial<A, index>>
+  template <is_expression A>
+  struct materializer<Negate<A>>
   {
-    using scalar_type = scalar_type_t<A>;
+    constexpr static bool changes = materializer<A>::changes;
+
+    constexpr static auto apply(auto&& negate)
+    {
+      return Negate { materialize(FWD(negate).a) };
+    }
+  };
+
+  template <is_expression A>
+  struct subexpression<Negate<A>> : stateless_subexpression<1>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a)
+    {
+      return Negate { FWD(a) };
+    }
+  };
+
+  template <is_expression A>
+  struct dependence<Negate<A>> : local_dependence<> {};
+
+  template <is_vectorizable A>
+  struct vectorizer<Negate<A>>
+  {
+    constexpr static bool enabled = true;
+    using layout = vector_layout_t<A>;
+
+    template <class V>
+    static auto apply(Negate<A> const& negate, int n) -> V
+    {
+      return -vectorize<V>(negate.a, n);
+    }
+  };
+
+  template <class A>
+  struct symmetry<Negate<A>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_symmetric_in<A>(a, b);
+    }
+  };
+
+  template <class A>
+  struct diagonal<Negate<A>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_diagonal_in<A>(a, b);
+    }
+  };
+
+  /// Opt a subtree out of materialization.
+  ///
+  /// The subtree is evaluated lazily, element by element, even where it would
+  /// otherwise be evaluated into a temporary. This can be cheaper when the
+  /// subtree is small relative to the cost of the temporary.
+  template <is_expression A>
+  struct Lazy : Bindable<Lazy<A>>
+  {
+    using scalar_type = scalar_type_t<A>;
 
     A a;
 
-    constexpr Partial(A a)
+    constexpr Lazy(A a)
         : a(std::move(a))
     {
     }
 
     constexpr static bool contains(auto&& tag)
     {
-      assert(not A::contains(FWD(tag)));
-      return false;
+      return A::contains(FWD(tag));
     }
 
     constexpr static bool may_alias(auto&& tag)
     {
-      assert(not A::contains(FWD(tag)));
-      return false;
+      return A::may_alias(FWD(tag));
     }
 
     /// Evaluate into a scalar.
-    constexpr operator scalar_type() const requires (order_v<Partial> == 0)
+    constexpr operator scalar_type() const requires (order_v<A> == 0)
     {
       return evaluate(ScalarIndex<0>{});
     }
 
     constexpr static auto order() -> int
     {
-      return outer().size();
+      return order_v<A>;
     }
 
     constexpr static auto dim() -> int
@@ -343,15 +1085,84 @@ namespace albert
 
     constexpr static auto outer() -> is_tensor_index auto
     {
-      return (outer_v<A> + index).exclusive();
+      return outer_v<A>;
+    }
+
+    constexpr auto evaluate(ScalarIndex<order_v<Lazy>> const& i) const
+    {
+      return a.evaluate(i);
+    }
+  };
+
+  template <class A>
+  struct symmetry<Lazy<A>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_symmetric_in<A>(a, b);
     }
+  };
 
-    constexpr auto evaluate(ScalarIndex<order_v<Partial>> const&) const;
+  template <class A>
+  struct diagonal<Lazy<A>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_diagonal_in<A>(a, b);
+    }
   };
 
+  template <is_expression A>
+  struct dependence<Lazy<A>> : local_dependence<> {};
+
+  namespace detail
+  {
+    /// Evaluate an order 2 expression into a stack temporary.
+    template <is_expression A>
+    constexpr auto matrix(A const& a)
+    {
+      Tensor<scalar_type_t<A>, 2, dim_v<A>> m;
+      for (int i = 0; i < dim_v<A>; ++i) {
+        for (int j = 0; j < dim_v<A>; ++j) {
+          m(i,j) = a.evaluate(ScalarIndex<2>(i, j));
+        }
+      }
+      return m;
+    }
+
+    /// Compute the inverse of an order 2 expression into a stack temporary.
+    ///
+    /// The closed-form kernels read each element of `a` more than once, so
+    /// anything other than a bound tensor is evaluated into a temporary first.
+    template <is_expression A>
+    constexpr auto inverse(A const& a)
+    {
+      Tensor<scalar_type_t<A>, 2, dim_v<A>> inv;
+      if constexpr (dim_v<A> <= 4 and is_tensor_bind_v<A>) {
+        solver::inverse<dim_v<A>>([&](int i, int j) {
+          return a.evaluate(ScalarIndex<2>(i, j));
+        }, inv);
+      }
+      else {
+        auto m = matrix(a);
+        solver::inverse<dim_v<A>>(m, inv);
+      }
+      return inv;
+    }
+  }
+
+  /// The inverse of a matrix.
+  ///
+  /// Each element of the inverse depends on every element of `a`, so the
+  /// materializer computes the whole inverse once into a stack temporary
+  /// before the parent is evaluated. Matrices up to 4x4 use the closed-form
+  /// kernels in `solver`. An inverse that isn't materialized, e.g., inside of
+  /// `lazy()`, recomputes the inverse for every element that it produces.
   template <is_expression A>
   struct Inverse : Bindable<Inverse<A>>
   {
+    static_assert(order_v<A> == 2, "inverse requires a scalar or an order 2 tensor");
+
     using scalar_type = scalar_type_t<A>;
 
     A a;
@@ -366,9 +1177,10 @@ namespace albert
       return A::contains(FWD(tag));
     }
 
+    /// Every element reads all of `a`.
     constexpr static bool may_alias(auto&& tag)
     {
-      return A::may_alias(FWD(tag));
+      return A::contains(FWD(tag));
     }
 
     constexpr static auto order() -> int
@@ -386,7 +1198,10 @@ namespace albert
       return outer_v<A>;
     }
 
-    constexpr auto evaluate(ScalarIndex<order_v<Inverse>> const&) const;
+    constexpr auto evaluate(ScalarIndex<2> const& i) const
+    {
+      return detail::inverse(a).evaluate(i);
+    }
   };
 
   template <is_expression A> requires(order_v<A> == 0)
@@ -439,6 +1254,45 @@ namespace albert
     }
   };
 
+  template <is_expression A>
+  struct materializer<Inverse<A>>
+  {
+    constexpr static bool changes = order_v<A> != 0 || materializer<A>::changes;
+
+    constexpr static auto apply(auto&& inverse)
+    {
+      if constexpr (order_v<A> != 0) {
+        return detail::inverse(materialize(FWD(inverse).a)).template rebind<outer_v<A>>();
+      }
+      else {
+        return Inverse { materialize(FWD(inverse).a) };
+      }
+    }
+  };
+
+  template <is_expression A>
+  struct subexpression<Inverse<A>> : stateless_subexpression<1, false>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a)
+    {
+      return Inverse { FWD(a) };
+    }
+  };
+
+  /// Scalar inverses (e.g., from `A(i,j) / 2.0`) are broadcast.
+  template <is_vectorizable A>
+  requires (order_v<A> == 0)
+  struct vectorizer<Inverse<A>>
+  {
+    constexpr static bool enabled = true;
+
+    template <class V>
+    static auto apply(Inverse<A> const& inverse, int) -> V
+    {
+      return simd_broadcast<V>(inverse.evaluate(ScalarIndex<0>{}));
+    }
+  };
+
   template <class T>
   struct Literal
   {
@@ -489,24 +1343,75 @@ namespace albert
     }
   };
 
-  template <TensorIndex<2> index>
-  struct Delta : Bindable<Delta<index>>
+  /// Literals are broadcast.
+  template <class T>
+  struct vectorizer<Literal<T>>
   {
-    using scalar_type = int;
+    constexpr static bool enabled = true;
 
-    constexpr static bool contains(auto)
+    template <class V>
+    static auto apply(Literal<T> const& literal, int) -> V
     {
-      return false;
+      return simd_broadcast<V>(literal.x);
     }
+  };
 
-    constexpr static bool may_alias(auto)
+  /// Literals of arithmetic types are the same when they have the same value,
+  /// other scalars (e.g., tape variables) are never the same.
+  template <class T>
+  struct subexpression<Literal<T>>
+  {
+    constexpr static int arity = 0;
+    constexpr static bool elementwise = true;
+
+    constexpr static bool same(Literal<T> const& x, Literal<T> const& y)
     {
-      return false;
+      if constexpr (std::is_arithmetic_v<T>) {
+        return x.x == y.x;
+      }
+      else {
+        return false;
+      }
+    }
+  };
+
+  /// The determinant of a matrix.
+  ///
+  /// The determinant is a scalar, and is materialized into a literal once per
+  /// assignment rather than recomputed for each element of its parent.
+  template <is_expression A>
+  struct Determinant : Bindable<Determinant<A>>
+  {
+    static_assert(order_v<A> == 2, "determinant requires an order 2 tensor");
+
+    using scalar_type = scalar_type_t<A>;
+
+    A a;
+
+    constexpr Determinant(A a)
+        : a(std::move(a))
+    {
+    }
+
+    constexpr static bool contains(auto&& tag)
+    {
+      return A::contains(FWD(tag));
+    }
+
+    constexpr static bool may_alias(auto&& tag)
+    {
+      return A::contains(FWD(tag));
+    }
+
+    /// Evaluate into a scalar.
+    constexpr operator scalar_type() const
+    {
+      return evaluate(ScalarIndex<0>{});
     }
 
     constexpr static auto order() -> int
     {
-      return 2;
+      return 0;
     }
 
     constexpr static auto dim() -> int
@@ -514,20 +1419,172 @@ namespace albert
       return 0;
     }
 
-    constexpr static auto outer() -> TensorIndex<2>
+    constexpr static auto outer() -> TensorIndex<0>
     {
-      return index;
+      return {};
     }
 
-    constexpr static auto evaluate(ScalarIndex<order_v<Delta>> const& i)
-      -> int
+    constexpr auto evaluate(ScalarIndex<0> const&) const
+      -> scalar_type
     {
-      return i[0] == i[1];
+      return solver::determinant<dim_v<A>>(detail::matrix(a));
     }
   };
 
-  template <is_tensor_index auto index>
-  struct LeviCivita : Bindable<LeviCivita<index>>
+  template <is_expression A>
+  struct materializer<Determinant<A>>
+  {
+    constexpr static bool changes = true;
+
+    constexpr static auto apply(auto&& det)
+    {
+      return Literal { det.evaluate(ScalarIndex<0>{}) };
+    }
+  };
+
+  template <is_expression A>
+  struct subexpression<Determinant<A>> : stateless_subexpression<1, false>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a)
+    {
+      return Determinant { FWD(a) };
+    }
+  };
+
+  /// The matrix functions that can appear in expressions.
+  enum MatrixFunctionTag : unsigned {
+    EXPM,
+    LOGM,
+    SQRTM
+  };
+
+  template <MatrixFunctionTag tag>
+  struct matrix_function_tag {};
+
+  template <MatrixFunctionTag tag>
+  constexpr inline matrix_function_tag<tag> matrix_function_tag_v = {};
+
+  namespace detail
+  {
+    /// Compute a matrix function of an order 2 expression into a stack
+    /// temporary.
+    template <MatrixFunctionTag tag, is_expression A>
+    constexpr auto matrix_function(A const& a)
+    {
+      constexpr int M = dim_v<A>;
+      auto m = matrix(a);
+      Tensor<scalar_type_t<A>, 2, M> f;
+      if constexpr (tag == EXPM) {
+        solver::expm<M>(m, f);
+      }
+      else if constexpr (tag == LOGM) {
+        solver::logm<M>(m, f);
+      }
+      else {
+        solver::sqrtm<M>(m, f);
+      }
+      return f;
+    }
+  }
+
+  /// A function of a matrix, i.e., `expm`, `logm`, or `sqrtm`.
+  ///
+  /// As with `Inverse`, every element depends on all of `a`, so the
+  /// materializer computes the whole result once into a stack temporary before
+  /// the parent is evaluated. The kernels are the ones in `solver`, which are
+  /// specialized for 2x2 and 3x3 matrices.
+  template <is_expression A, MatrixFunctionTag tag>
+  struct MatrixFunction : Bindable<MatrixFunction<A, tag>>
+  {
+    static_assert(order_v<A> == 2, "matrix functions require an order 2 tensor");
+
+    using scalar_type = scalar_type_t<A>;
+
+    A a;
+
+    constexpr MatrixFunction(A a, matrix_function_tag<tag>)
+        : a(std::move(a))
+    {
+    }
+
+    constexpr static bool contains(auto&& tag_)
+    {
+      return A::contains(FWD(tag_));
+    }
+
+    /// Every element reads all of `a`.
+    constexpr static bool may_alias(auto&& tag_)
+    {
+      return A::contains(FWD(tag_));
+    }
+
+    constexpr static auto order() -> int
+    {
+      return 2;
+    }
+
+    constexpr static auto dim() -> int
+    {
+      return dim_v<A>;
+    }
+
+    constexpr static auto outer() -> is_tensor_index auto
+    {
+      return outer_v<A>;
+    }
+
+    constexpr auto evaluate(ScalarIndex<2> const& i) const
+    {
+      return detail::matrix_function<tag>(a).evaluate(i);
+    }
+  };
+
+  template <is_expression A, MatrixFunctionTag tag>
+  struct materializer<MatrixFunction<A, tag>>
+  {
+    constexpr static bool changes = true;
+
+    constexpr static auto apply(auto&& f)
+    {
+      return detail::matrix_function<tag>(materialize(FWD(f).a)).template rebind<outer_v<A>>();
+    }
+  };
+
+  template <is_expression A, MatrixFunctionTag tag>
+  struct subexpression<MatrixFunction<A, tag>> : stateless_subexpression<1, false>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a)
+    {
+      return MatrixFunction(FWD(a), matrix_function_tag_v<tag>);
+    }
+  };
+
+  /// The factors of a polar decomposition `F = R U`, computed once from an
+  /// order 2 expression, along with the code returned by `solver::polar`.
+  template <class T, int M>
+  struct Polar
+  {
+    Tensor<T, 2, M> R;
+    Tensor<T, 2, M> U;
+    int info;
+
+    template <is_expression A>
+    constexpr explicit Polar(A const& a)
+        : info(solver::polar<M>(detail::matrix(a), R, U))
+    {
+    }
+  };
+
+  template <is_expression A>
+  Polar(A const&) -> Polar<scalar_type_t<A>, dim_v<A>>;
+
+  /// The Kronecker delta.
+  ///
+  /// The delta usually takes its dimension from the tensors around it, but
+  /// can carry one (`N`) for contractions in which it is the only operand
+  /// with the index, e.g., the delta products built by symbolic derivatives.
+  template <TensorIndex<2> index, int N = 0>
+  struct Delta : Bindable<Delta<index, N>>
   {
     using scalar_type = int;
 
@@ -543,43 +1600,38 @@ namespace albert
 
     constexpr static auto order() -> int
     {
-      return index.size();
+      return 2;
     }
 
     constexpr static auto dim() -> int
     {
-      return order();
+      return N;
     }
 
-    constexpr static auto outer() -> is_tensor_index auto
+    constexpr static auto outer() -> TensorIndex<2>
     {
       return index;
     }
 
-    constexpr auto evaluate(ScalarIndex<order_v<LeviCivita>> const& i) const
+    constexpr static auto evaluate(ScalarIndex<order_v<Delta>> const& i)
       -> int
     {
-      static_assert(0 <= order() and order() < 64);
-      uint64_t n = 0;
-      for (auto i : i) {
-        n |= 1u << i;
-      }
-
-      return (std::popcount(n) != order()) ? 0 : parity(i);
+      return i[0] == i[1];
     }
+  };
 
-    constexpr auto parity(ScalarIndex<order_v<LeviCivita>> perm) const
-      -> int
+  template <TensorIndex<2> index, int N>
+  struct diagonal<Delta<index, N>>
+  {
+    constexpr static bool apply(char a, char b)
     {
-      int swaps = 0;
-      for (int i = 0, e = std::size(perm); i < e; ++i) {
-        for (int j = std::exchange(perm[i], i); i != j; std::swap(j, perm[j])) {
-          ++swaps;
-        }
-      }
-      return (swaps & 1) ? -1 : 1;
+      return (a == index[0] and b == index[1]) or (a == index[1] and b == index[0]);
     }
+  };
 
+  /// The nonzero elements of the Levi-Civita symbol.
+  namespace levi_civita
+  {
     // Adapted from https://github.com/llvm-mirror/libcxx/blob/master/include/algorithm
     // and https://en.cppreference.com/w/cpp/algorithm/next_permutation for random
     // access iterators and parity tracking.
@@ -609,7 +1661,654 @@ namespace albert
       std::reverse(first, last);
       return 0;
     }
-  };
+
+    /// One of the `N!` nonzero elements, and its sign.
+    template <int N>
+    struct Permutation
+    {
+      ScalarIndex<N> index;
+      int sign = 1;
+    };
+
+    /// The `N!` nonzero elements of the order `N` symbol, in lexicographic
+    /// order.
+    template <int N>
+    constexpr auto permutations() -> std::array<Permutation<N>, factorial(N)>
+    {
+      std::array<Permutation<N>, factorial(N)> out;
+      std::array<int, N> p;
+      for (int k = 0; k < N; ++k) {
+        p[k] = k;
+      }
+
+      int sign = 1;
+      for (auto& e : out) {
+        for (int k = 0; k < N; ++k) {
+          e.index[k] = p[k];
+        }
+        e.sign = sign;
+        sign = next_permutation(sign, p.begin(), p.end());
+      }
+      return out;
+    }
+
+    template <int N>
+    constexpr inline std::array permutations_v = permutations<N>();
+  }
+
+  template <is_tensor_index auto index>
+  struct LeviCivita : Bindable<LeviCivita<index>>
+  {
+    using scalar_type = int;
+
+    constexpr static bool contains(auto)
+    {
+      return false;
+    }
+
+    constexpr static bool may_alias(auto)
+    {
+      return false;
+    }
+
+    constexpr static auto order() -> int
+    {
+      return index.size();
+    }
+
+    constexpr static auto dim() -> int
+    {
+      return order();
+    }
+
+    constexpr static auto outer() -> is_tensor_index auto
+    {
+      return index;
+    }
+
+    constexpr auto evaluate(ScalarIndex<order_v<LeviCivita>> const& i) const
+      -> int
+    {
+      static_assert(0 <= order() and order() < 64);
+      uint64_t n = 0;
+      for (auto i : i) {
+        n |= 1u << i;
+      }
+
+      return (std::popcount(n) != order()) ? 0 : parity(i);
+    }
+
+    constexpr auto parity(ScalarIndex<order_v<LeviCivita>> perm) const
+      -> int
+    {
+      int swaps = 0;
+      for (int i = 0, e = std::size(perm); i < e; ++i) {
+        for (int j = std::exchange(perm[i], i); i != j; std::swap(j, perm[j])) {
+          ++swaps;
+        }
+      }
+      return (swaps & 1) ? -1 : 1;
+    }
+  };
+
+  /// Reorder the outer index of a subtree.
+  ///
+  /// Rewrites that rename the indices of a subtree (e.g., delta elimination)
+  /// can change the order of its outer index, which positional consumers like
+  /// binds and temporaries depend on, so the original order is restored with
+  /// a transpose.
+  template <is_expression A, is_tensor_index auto index>
+  struct Transpose : Bindable<Transpose<A, index>>
+  {
+    using scalar_type = scalar_type_t<A>;
+
+    A a;
+
+    constexpr Transpose(A a)
+        : a(std::move(a))
+    {
+      static_assert(is_permutation(index, outer_v<A>));
+    }
+
+    constexpr static bool contains(auto&& tag)
+    {
+      return A::contains(FWD(tag));
+    }
+
+    constexpr static bool may_alias(auto&& tag)
+    {
+      return A::may_alias(FWD(tag));
+    }
+
+    constexpr static auto order() -> int
+    {
+      return order_v<A>;
+    }
+
+    constexpr static auto dim() -> int
+    {
+      return dim_v<A>;
+    }
+
+    constexpr static auto outer() -> is_tensor_index auto
+    {
+      return index;
+    }
+
+    constexpr auto evaluate(ScalarIndex<order_v<Transpose>> const& i) const
+    {
+      return a.evaluate(select<index, outer_v<A>>(i));
+    }
+  };
+
+  template <is_expression A, is_tensor_index auto index>
+  struct materializer<Transpose<A, index>>
+  {
+    constexpr static bool changes = materializer<A>::changes;
+
+    constexpr static auto apply(auto&& transpose)
+    {
+      using M = std::remove_cvref_t<decltype(materialize(FWD(transpose).a))>;
+      return Transpose<M, index>(materialize(FWD(transpose).a));
+    }
+  };
+
+  template <is_expression A, is_tensor_index auto index>
+  struct subexpression<Transpose<A, index>> : stateless_subexpression<1>
+  {
+    constexpr static auto rebuild(auto&&, auto&& a)
+    {
+      return Transpose<std::remove_cvref_t<decltype(a)>, index>(FWD(a));
+    }
+  };
+
+  template <is_expression A, is_tensor_index auto index>
+  struct dependence<Transpose<A, index>> : local_dependence<> {};
+
+  template <class A, auto index>
+  struct symmetry<Transpose<A, index>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_symmetric_in<A>(a, b);
+    }
+  };
+
+  template <class A, auto index>
+  struct diagonal<Transpose<A, index>>
+  {
+    constexpr static bool apply(char a, char b)
+    {
+      return is_diagonal_in<A>(a, b);
+    }
+  };
+
+  namespace detail
+  {
+    /// The index that a tree is bound to, if it is a bind.
+    constexpr auto bound_index(auto const*)
+    {
+      return TensorIndex<0>{};
+    }
+
+    template <class A, auto index>
+    constexpr auto bound_index(Bind<A, index> const*)
+    {
+      return index;
+    }
+
+    /// Rename the characters of `e` in `from` to the corresponding characters
+    /// in `to`.
+    ///
+    /// Binds of tensors are rebound directly, so that they remain leaves, and
+    /// deltas are renamed in place. Anything else is bound to the renamed
+    /// outer index.
+    template <auto from, auto to, class E>
+    constexpr auto substitute(E&& e)
+    {
+      using T = std::remove_cvref_t<E>;
+
+      constexpr auto rename = [](auto const& index) {
+        std::remove_cvref_t<decltype(index)> out;
+        for (char c : index) {
+          out.push(from.count(c) ? to[from.index_of(c)] : c);
+        }
+        return out;
+      };
+
+      // rebinding a tensor can't introduce characters that it traces over
+      constexpr auto bound = bound_index(static_cast<T const*>(nullptr));
+      constexpr bool rebind = (is_tensor_bind_v<T> and
+                               bound.n_projected() == 0 and
+                               (bound.repeated() & to).size() == 0);
+
+      if constexpr (rebind) {
+        constexpr TensorIndex index = rename(bound);
+        return Bind { FWD(e).a, {}, nttp<index> };
+      }
+      else {
+        constexpr TensorIndex index = rename(outer_v<T>);
+        return Bind { FWD(e), {}, nttp<index> };
+      }
+    }
+  }
+
+  /// Kronecker delta elimination.
+  ///
+  /// A delta that is contracted with another operand of a product only renames
+  /// the contracted index, e.g., `A(i,j) * δ(j,k)` is `A(i,k)` and `A(i,j) *
+  /// δ(i,j)` is `A(j,j)`. Each maximal product tree is flattened into its
+  /// operands, the contracted deltas are removed one at a time by substituting
+  /// their other character in their partner, and the remaining operands are
+  /// rebuilt into a product (which is then re-associated as usual).
+  ///
+  /// Deltas that aren't contracted are left in place, where they make the
+  /// product diagonal (see `diagonal`).
+  namespace kronecker
+  {
+    template <class>
+    constexpr inline bool is_delta_v = false;
+
+    template <TensorIndex<2> index, int N>
+    constexpr inline bool is_delta_v<Delta<index, N>> = true;
+
+    /// One elimination: the delta `p` is removed and `from` is renamed to
+    /// `to` in the operand `q`.
+    struct Step
+    {
+      int p = -1;
+      int q = -1;
+      char from = 0;
+      char to = 0;
+    };
+
+    /// Find a contracted delta, if there is one.
+    template <class... Ts>
+    constexpr auto step() -> Step
+    {
+      constexpr int M = sizeof...(Ts);
+      constexpr std::array<bool, M> deltas = { is_delta_v<Ts>... };
+      constexpr std::array<std::array<char, 2>, M> chars = { [] {
+        if constexpr (is_delta_v<Ts>) {
+          return std::array<char, 2>{ outer_v<Ts>[0], outer_v<Ts>[1] };
+        }
+        else {
+          return std::array<char, 2>{};
+        }
+      }()... };
+
+      auto count = [](char c) {
+        return (0 + ... + int(outer_v<Ts>.count(c)));
+      };
+
+      auto has = [](int q, char c) {
+        int k = 0;
+        bool found = false;
+        ((found |= (k++ == q and outer_v<Ts>.count(c) != 0)), ...);
+        return found;
+      };
+
+      // substitution is only valid in einstein notation
+      bool valid = true;
+      ([&] {
+        for (char c : outer_v<Ts>) {
+          valid &= (count(c) <= 2);
+        }
+      }(), ...);
+
+      if (not valid) {
+        return {};
+      }
+
+      for (int p = 0; p < M; ++p) {
+        if (not deltas[p] or chars[p][0] == chars[p][1]) {
+          continue;
+        }
+        for (int s = 0; s < 2; ++s) {
+          char from = chars[p][s];
+          char to = chars[p][1 - s];
+          if (count(from) != 2) {
+            continue;
+          }
+          for (int q = 0; q < M; ++q) {
+            if (q == p or not has(q, from)) {
+              continue;
+            }
+            // `δ(j,k) * δ(k,j)` is a trace, which is left alone
+            if (deltas[q] and (chars[q][0] == to or chars[q][1] == to)) {
+              continue;
+            }
+            return { p, q, from, to };
+          }
+        }
+      }
+
+      return {};
+    }
+
+    template <class... Ts>
+    constexpr inline Step step_v = step<Ts...>();
+
+    constexpr auto chars(char c) -> TensorIndex<1>
+    {
+      TensorIndex<1> out;
+      out.push(c);
+      return out;
+    }
+
+    /// The operand `k` after the step `s`.
+    template <Step s, int k, class... Ts, class T>
+    constexpr auto operand(T&& t)
+    {
+      using U = std::remove_cvref_t<T>;
+      constexpr TensorIndex<1> from = chars(s.from);
+      constexpr TensorIndex<1> to = chars(s.to);
+
+      if constexpr (k == s.p) {
+        return std::tuple<>();
+      }
+      else if constexpr (k != s.q) {
+        return std::tuple<U>(FWD(t));
+      }
+      else if constexpr (is_delta_v<U>) {
+        // the merged delta keeps any dimension carried by either delta
+        using P = std::tuple_element_t<s.p, std::tuple<Ts...>>;
+        constexpr TensorIndex<2> index = [] {
+          TensorIndex<2> out;
+          for (char c : outer_v<U>) {
+            out.push(c == s.from ? s.to : c);
+          }
+          return out;
+        }();
+        return std::tuple(Delta<index, max(dim_v<U>, dim_v<P>)>{});
+      }
+      else {
+        return std::tuple(detail::substitute<from, to>(FWD(t)));
+      }
+    }
+
+    template <class... Ts>
+    constexpr auto eliminate(std::tuple<Ts...>&& operands)
+    {
+      constexpr Step s = step_v<Ts...>;
+      if constexpr (s.p < 0) {
+        return std::move(operands);
+      }
+      else {
+        return eliminate([&]<int... k>(std::integer_sequence<int, k...>) {
+          return std::tuple_cat(operand<s, k, Ts...>(std::get<k>(std::move(operands)))...);
+        }(std::make_integer_sequence<int, sizeof...(Ts)>()));
+      }
+    }
+
+    /// Rebuild a left-associative product from its operands.
+    template <class T, class... Ts>
+    constexpr auto product(T&& t, Ts&&... ts)
+    {
+      if constexpr (sizeof...(Ts) == 0) {
+        return std::remove_cvref_t<T>(FWD(t));
+      }
+      else {
+        return []<class U, class... Us>(auto&& a, U&& b, Us&&... us) {
+          return product(Product { FWD(a), FWD(b) }, FWD(us)...);
+        }(FWD(t), FWD(ts)...);
+      }
+    }
+
+    template <class A, class B>
+    struct eliminator<Product<A, B>>
+    {
+      using Operands = decltype(contraction::operands(std::declval<Product<A, B>>()));
+
+      constexpr static bool changes = []<class... Ts>(std::tuple<Ts...>*) {
+        return step_v<Ts...>.p >= 0;
+      }(static_cast<Operands*>(nullptr));
+
+      constexpr static auto apply(auto&& product)
+      {
+        constexpr TensorIndex outer = outer_v<Product<A, B>>;
+        auto out = std::apply([](auto&&... ts) {
+          return kronecker::product(FWD(ts)...);
+        }, eliminate(contraction::operands(FWD(product))));
+
+        using R = decltype(out);
+        if constexpr (outer_v<R> == outer) {
+          return out;
+        }
+        else {
+          return Transpose<R, outer>(std::move(out));
+        }
+      }
+    };
+  }
+
+  /// A contraction with the Levi-Civita symbol, `ε(index) * b`.
+  ///
+  /// Only `N!` of the `N^N` elements of the symbol are nonzero, so rather than
+  /// visiting every value of the contracted indices this visits the nonzero
+  /// elements that agree with the free indices of the symbol, with their
+  /// precomputed signs, e.g., each element of the cross product `ε(i,j,k) *
+  /// a(j) * b(k)` is the sum of 2 terms rather than 9.
+  template <is_tensor_index auto index, is_expression B>
+  struct LeviCivitaProduct : Bindable<LeviCivitaProduct<index, B>>
+  {
+    using scalar_type = scalar_type_t<Product<LeviCivita<index>, B>>;
+
+    B b;
+
+    constexpr LeviCivitaProduct(B b)
+        : b(std::move(b))
+    {
+      static_assert(dim_v<B> == 0 || dim_v<B> == index.size());
+      static_assert(index.n_repeated() == 0);
+    }
+
+    constexpr static bool contains(auto&& tag)
+    {
+      return B::contains(FWD(tag));
+    }
+
+    constexpr static bool may_alias(auto&& tag)
+    {
+      return (B::may_alias(FWD(tag)) || ((index & outer_v<B>).size() and contains(FWD(tag))));
+    }
+
+    constexpr static auto order() -> int
+    {
+      return outer().size();
+    }
+
+    constexpr static auto dim() -> int
+    {
+      return index.size();
+    }
+
+    constexpr static auto outer() -> is_tensor_index auto
+    {
+      constexpr TensorIndex c = index ^ outer_v<B>;
+      return c;
+    }
+
+    /// The contracted indices.
+    constexpr static auto inner() -> is_tensor_index auto
+    {
+      constexpr TensorIndex c = index & outer_v<B>;
+      return c;
+    }
+
+    constexpr auto evaluate(ScalarIndex<order_v<LeviCivitaProduct>> const& i) const
+      -> scalar_type
+    {
+      constexpr TensorIndex outer = outer_v<LeviCivitaProduct>;
+      constexpr TensorIndex inner = inner_v<LeviCivitaProduct>;
+      constexpr TensorIndex   all = outer + inner;
+      constexpr TensorIndex     r = outer_v<B>;
+      constexpr int     N = index.size();
+      constexpr int     I = inner.size();
+
+      // Split each nonzero element of the symbol into the values of its free
+      // characters, which must match the outer index, and the values of its
+      // contracted characters.
+      constexpr int F = N - I;
+      constexpr auto const& permutations = levi_civita::permutations_v<N>;
+      constexpr auto split = [] {
+        std::array<std::array<int, F>, factorial(N)> free = {};
+        std::array<ScalarIndex<I>, factorial(N)> contracted = {};
+        for (int n = 0; n < factorial(N); ++n) {
+          for (int q = 0, f = 0; q < N; ++q) {
+            if (outer_v<LeviCivitaProduct>.count(index[q])) {
+              free[n][f++] = permutations[n].index[q];
+            }
+            else {
+              contracted[n][inner_v<LeviCivitaProduct>.index_of(index[q])] = permutations[n].index[q];
+            }
+          }
+        }
+        return std::tuple(free, contracted);
+      }();
+      constexpr auto free = std::get<0>(split);
+      constexpr auto contracted = std::get<1>(split);
+
+      // The positions of the free characters in the outer index.
+      constexpr std::array<int, F> positions = [] {
+        std::array<int, F> out = {};
+        for (int q = 0, f = 0; q < N; ++q) {
+          if (outer_v<LeviCivitaProduct>.count(index[q])) {
+            out[f++] = outer_v<LeviCivitaProduct>.index_of(index[q]);
+          }
+        }
+        return out;
+      }();
+
+      scalar_type temp{};
+      for (int n = 0; n < factorial(N); ++n) {
+        bool matches = true;
+        for (int f = 0; f < F; ++f) {
+          matches &= (i[positions[f]] == free[n][f]);
+        }
+        if (matches) {
+          if (permutations[n].sign > 0) {
+            temp += b.evaluate(select<all, r>(i + contracted[n]));
+          }
+          else {
+            temp -= b.evaluate(select<all, r>(i + contracted[n]));
+          }
+        }
+      }
+      return temp;
+    }
+  };
+
+  /// The product of the symbol with the other operands is evaluated as above,
+  /// and the other operands are materialized with the usual rules.
+  template <is_tensor_index auto index, is_expression B>
+  struct materializer<LeviCivitaProduct<index, B>>
+  {
+    using P = materializer<Product<LeviCivita<index>, B>>;
+
+    constexpr static bool changes = (materializer<B>::changes ||
+                                     P::template temporary<B, LeviCivita<index>>);
+
+    constexpr static auto apply(auto&& e)
+    {
+      auto b = P::template operand<B, LeviCivita<index>>(materialize(FWD(e).b));
+      return LeviCivitaProduct<index, decltype(b)>(std::move(b));
+    }
+  };
+
+  /// Contracted Levi-Civita symbols.
+  ///
+  /// Each maximal product tree is flattened into its operands, and the first
+  /// symbol that shares an index with another operand is pulled out of the
+  /// tree, `ε(i,j,k) * a(j) * b(k)` becomes `LeviCivitaProduct<ijk>(a(j) *
+  /// b(k))`, where the remaining operands keep their source order (and are
+  /// then re-associated as usual).
+  namespace levi_civita
+  {
+    template <class>
+    constexpr inline bool is_levi_civita_v = false;
+
+    template <auto index>
+    constexpr inline bool is_levi_civita_v<LeviCivita<index>> = true;
+
+    /// Find the first contracted symbol, if there is one.
+    template <class... Ts>
+    constexpr auto find() -> int
+    {
+      auto count = [](char c) {
+        return (0 + ... + int(outer_v<Ts>.count(c)));
+      };
+
+      // the symbol is only pulled out in einstein notation
+      bool valid = true;
+      ([&] {
+        for (char c : outer_v<Ts>) {
+          valid &= (count(c) <= 2);
+        }
+      }(), ...);
+
+      int p = 0;
+      int found = -1;
+      ([&] {
+        if (valid and found < 0 and is_levi_civita_v<Ts> and outer_v<Ts>.n_repeated() == 0) {
+          for (char c : outer_v<Ts>) {
+            if (count(c) == 2) {
+              found = p;
+            }
+          }
+        }
+        ++p;
+      }(), ...);
+      return found;
+    }
+
+    template <class... Ts>
+    constexpr inline int find_v = find<Ts...>();
+
+    template <int p, int k, class T>
+    constexpr auto operand(T&& t)
+    {
+      if constexpr (k == p) {
+        return std::tuple<>();
+      }
+      else {
+        return std::tuple<std::remove_cvref_t<T>>(FWD(t));
+      }
+    }
+
+    template <class A, class B>
+    struct grouper<Product<A, B>>
+    {
+      using Operands = decltype(contraction::operands(std::declval<Product<A, B>>()));
+
+      constexpr static int p = []<class... Ts>(std::tuple<Ts...>*) {
+        return find_v<Ts...>;
+      }(static_cast<Operands*>(nullptr));
+
+      constexpr static bool changes = p >= 0;
+
+      constexpr static auto apply(auto&& product)
+      {
+        constexpr TensorIndex outer = outer_v<Product<A, B>>;
+        constexpr TensorIndex index = outer_v<std::tuple_element_t<p, Operands>>;
+
+        auto operands = contraction::operands(FWD(product));
+        auto b = std::apply([](auto&&... ts) {
+          return kronecker::product(FWD(ts)...);
+        }, [&]<int... k>(std::integer_sequence<int, k...>) {
+          return std::tuple_cat(operand<p, k>(std::get<k>(std::move(operands)))...);
+        }(std::make_integer_sequence<int, std::tuple_size_v<Operands>>()));
+
+        using R = LeviCivitaProduct<index, decltype(b)>;
+        if constexpr (outer_v<R> == outer) {
+          return R(std::move(b));
+        }
+        else {
+          return Transpose<R, outer>(R(std::move(b)));
+        }
+      }
+    };
+  }
 }
 
 #endif // ALBERT_INCLUDE_EXPRESSIONS_HPP
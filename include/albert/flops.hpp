@@ -0,0 +1,128 @@
+#ifndef ALBERT_INCLUDE_FLOPS_HPP
+#define ALBERT_INCLUDE_FLOPS_HPP
+
+#include "albert/Bind.hpp"
+#include "albert/concepts.hpp"
+#include "albert/derivative.hpp"
+#include "albert/expressions.hpp"
+#include "albert/sparsity.hpp"
+#include "albert/utils.hpp"
+#include <type_traits>
+
+namespace albert
+{
+  /// Estimate the floating point operations needed to evaluate an expression.
+  ///
+  /// This is a static estimate that is only used to make scheduling decisions,
+  /// like choosing the grain size for parallel batches. Each elementwise node
+  /// costs one operation per element of its result, while contractions cost a
+  /// multiply and an add for every term in the sum. Nested contractions are
+  /// assumed to be materialized, so their cost is only counted once.
+  template <class E>
+  struct flop_counter
+  {
+    using T = std::remove_cvref_t<E>;
+
+    constexpr static long children = [] {
+      long n = 0;
+      if constexpr (requires (T t) { { t.a } -> is_tensor; }) {
+        n += flop_counter<decltype(std::declval<T>().a)>::value;
+      }
+      if constexpr (requires (T t) { { t.b } -> is_tensor; }) {
+        n += flop_counter<decltype(std::declval<T>().b)>::value;
+      }
+      return n;
+    }();
+
+    /// Interior nodes do one operation per element, leaves are free.
+    constexpr static long value = [] {
+      if constexpr (requires (T t) { { t.a } -> is_tensor; }) {
+        return children + pow(dim_v<T>, order_v<T>);
+      }
+      else {
+        return children;
+      }
+    }();
+  };
+
+  /// Diagonal products are only evaluated on their diagonal.
+  template <class A, class B>
+  struct flop_counter<Product<A, B>>
+  {
+    using T = Product<A, B>;
+
+    constexpr static int n = diagonal_of<T, order_v<T>>(outer_v<T>).n;
+
+    constexpr static long value = (flop_counter<A>::value +
+                                   flop_counter<B>::value +
+                                   2l * pow(dim_v<T>, n + inner_v<T>.size()));
+  };
+
+  /// Contractions with the Levi-Civita symbol only visit its `N!` nonzero
+  /// elements for each value of the other operand's free indices.
+  template <auto index, class B>
+  struct flop_counter<LeviCivitaProduct<index, B>>
+  {
+    using T = LeviCivitaProduct<index, B>;
+
+    constexpr static int free = (index - outer_v<B>).size();
+
+    constexpr static long value = (flop_counter<B>::value +
+                                   2l * factorial(index.size()) * pow(dim_v<T>, order_v<T> - free));
+  };
+
+  /// Transposes are free.
+  template <class A, auto index>
+  struct flop_counter<Transpose<A, index>> : flop_counter<A> {};
+
+  /// Binds of tensors are free, unless they contain a trace.
+  template <class A, auto index>
+  struct flop_counter<Bind<A, index>>
+  {
+    constexpr static long value = (flop_counter<A>::value +
+                                   (index.n_repeated() ? pow(dim_v<A>, index.exclusive().size() + index.n_repeated()) : 0));
+  };
+
+  /// Matrix inverses and determinants are computed once, at roughly the cost
+  /// of an LU factorization (and the solves, for the inverse).
+  template <class A>
+  requires (order_v<A> == 2)
+  struct flop_counter<Inverse<A>>
+  {
+    constexpr static long value = flop_counter<A>::value + 2l * pow(dim_v<A>, 3);
+  };
+
+  template <class A>
+  struct flop_counter<Determinant<A>>
+  {
+    constexpr static long value = flop_counter<A>::value + 2l * pow(dim_v<A>, 3) / 3;
+  };
+
+  /// Matrix functions are computed once, at the cost of roughly ten matrix
+  /// products.
+  template <class A, MatrixFunctionTag tag>
+  struct flop_counter<MatrixFunction<A, tag>>
+  {
+    constexpr static long value = flop_counter<A>::value + 20l * pow(dim_v<A>, 3);
+  };
+
+  /// Derivatives cost whatever their symbolic derivative costs.
+  template <class A, class X>
+  struct flop_counter<Partial<A, X>> : flop_counter<derivative_t<A, X>> {};
+
+  template <class E>
+  requires (not std::is_same_v<E, std::remove_cvref_t<E>>)
+  struct flop_counter<E> : flop_counter<std::remove_cvref_t<E>> {};
+
+  template <class E>
+  constexpr inline long flops_v = flop_counter<E>::value;
+
+  /// Estimate the floating point operations needed to evaluate `e`.
+  template <is_expression E>
+  constexpr auto flops(E&&) -> long
+  {
+    return flops_v<E>;
+  }
+}
+
+#endif // ALBERT_INCLUDE_FLOPS_HPP
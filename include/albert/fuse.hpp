@@ -0,0 +1,277 @@
+#ifndef ALBERT_INCLUDE_FUSE_HPP
+#define ALBERT_INCLUDE_FUSE_HPP
+
+#include "albert/Bind.hpp"
+#include "albert/ScalarIndex.hpp"
+#include "albert/TensorIndex.hpp"
+#include "albert/aliasing.hpp"
+#include "albert/concepts.hpp"
+#include "albert/evaluate.hpp"
+#include "albert/materialize.hpp"
+#include "albert/simd.hpp"
+#include "albert/utils.hpp"
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+namespace albert
+{
+  /// An assignment that is recorded rather than evaluated (see `fuse`).
+  ///
+  /// @param A The type of the left-hand-side bind.
+  /// @param B The type of the right-hand-side expression.
+  /// @param Op The assignment operator.
+  template <class A, class B, class Op>
+  struct Statement
+  {
+    A a;                                        //!< left-hand-side
+    B b;                                        //!< right-hand-side
+    [[no_unique_address]] Op op;                //!< assignment operator
+  };
+
+  /// A left-hand-side whose assignments are recorded as statements.
+  ///
+  /// The right-hand-side uses the same trick as the bind node, lvalue
+  /// expressions are captured by reference and rvalues are moved from.
+  template <class A>
+  struct Deferred
+  {
+    A a;
+
+    template <is_expression B>
+    constexpr auto operator=(B&& b) && -> Statement<A, B, ops::assign>
+    {
+      return { std::move(a), FWD(b), {} };
+    }
+
+    template <is_expression B>
+    constexpr auto operator+=(B&& b) && -> Statement<A, B, ops::add>
+    {
+      return { std::move(a), FWD(b), {} };
+    }
+
+    template <is_expression B>
+    constexpr auto operator-=(B&& b) && -> Statement<A, B, ops::subtract>
+    {
+      return { std::move(a), FWD(b), {} };
+    }
+  };
+
+  /// Record an assignment to `a` for `fuse`.
+  ///
+  ///     albert::defer(C(i,j)) = A(i,j) + B(i,j);
+  template <is_expression A>
+  constexpr auto defer(A&& a) -> Deferred<std::remove_cvref_t<A>>
+  {
+    return { FWD(a) };
+  }
+
+  namespace detail
+  {
+    /// Check if evaluating `b` for the element of `a` that is written in the
+    /// same iteration can read an element of `a` that is written in another.
+    ///
+    /// This is the analysis that `Bind::assign` uses for a single statement,
+    /// where `b` is evaluated at the element of `a` with the same outer index.
+    template <class A, class B>
+    constexpr bool hazard(A const& a, B const& b)
+    {
+      constexpr bool views = (is_view_tag_v<decltype(std::remove_cvref_t<A>::tag())> or
+                              std::remove_cvref_t<B>::contains(detail::view_probe));
+      if constexpr (albert::access_v<A, B> != Access::pointwise or views) {
+        return (std::is_constant_evaluated() or albert::access(a, b) != Access::pointwise);
+      }
+      else {
+        return false;
+      }
+    }
+
+    /// Check if statement `t` can't be evaluated in the same iteration as an
+    /// earlier statement `s`.
+    ///
+    /// The statements conflict if `t` reads an element that `s` wrote in an
+    /// earlier iteration (read after write), if `s` reads an element that `t`
+    /// wrote in an earlier iteration (write after read), or if they write the
+    /// same element in different iterations (write after write).
+    template <class S, class T>
+    constexpr bool conflicts(S const& s, T const& t)
+    {
+      return hazard(s.a, t.b) or hazard(t.a, s.b) or hazard(s.a, t.a);
+    }
+
+    /// Check if any statement conflicts with itself or with a later one.
+    constexpr bool any_conflicts()
+    {
+      return false;
+    }
+
+    constexpr bool any_conflicts(auto const& s, auto const&... ts)
+    {
+      return (hazard(s.a, s.b) or (conflicts(s, ts) or ...) or any_conflicts(ts...));
+    }
+
+    /// Packed left-hand-sides only visit their unique indices (see
+    /// `for_each_index_of`), so they can't share a dense loop nest.
+    template <class A>
+    constexpr inline bool is_packed_v = requires { std::remove_cvref_t<A>::storage_indices(); };
+
+    /// Evaluate one statement at iteration `i` of the loop over `outer`.
+    template <TensorIndex outer>
+    constexpr void step(auto& s, ScalarIndex<outer.size()> const& i)
+    {
+      constexpr TensorIndex l = outer_v<decltype(s.a)>;
+      constexpr TensorIndex r = outer_v<decltype(s.b)>;
+      if constexpr (l == outer and r == outer) {
+        s.op(s.a.evaluate(i), s.b.evaluate(i));
+      }
+      else {
+        s.op(s.a.evaluate(select<outer, l>(i)), s.b.evaluate(select<outer, r>(i)));
+      }
+    }
+
+    /// Evaluate materialized statements in a single loop nest.
+    constexpr void fused(auto&& s, auto&&... ts)
+    {
+      constexpr TensorIndex outer = outer_v<decltype(s.a)>;
+      constexpr int Order = outer.size();
+      constexpr int N = std::max({ dim_v<decltype(s.a)>, dim_v<decltype(s.b)>,
+                                   dim_v<decltype(ts.a)>..., dim_v<decltype(ts.b)>... });
+
+      for_each_index<Order, N, storage_order_v<decltype(s.a)>>([&](ScalarIndex<Order> const& i) {
+        step<outer>(s, i);
+        (step<outer>(ts, i), ...);
+      });
+    }
+  }
+
+  namespace detail
+  {
+    /// Can statement `S` be streamed over storage with the layout of `A`.
+    ///
+    /// This is the condition that `Bind::assign` uses for `evaluate_linear`,
+    /// and every left-hand-side must share one scalar type and layout, so that
+    /// element `n` of each statement is the same element of the loop.
+    template <class A, class S>
+    constexpr inline bool is_linear_v = [] {
+      using L = std::remove_cvref_t<decltype(std::declval<S>().a)>;
+      using R = std::remove_cvref_t<decltype(std::declval<S>().b)>;
+      if constexpr (is_vectorizable<A> and is_vectorizable<L> and is_vectorizable<R>) {
+        return (not std::is_void_v<vector_layout_t<A>> and
+                outer_v<A> == outer_v<L> and outer_v<L> == outer_v<R> and
+                std::is_same_v<scalar_type_t<A>, scalar_type_t<L>> and
+                std::is_same_v<scalar_type_t<L>, scalar_type_t<R>> and
+                std::is_same_v<vector_layout_t<A>, vector_layout_t<L>> and
+                same_vector_layout_v<L, R>);
+      }
+      else {
+        return false;
+      }
+    }();
+
+    /// Evaluate one statement for the vector, or scalar, at offset `n`.
+    template <class V, int align>
+    void linear_step(auto& s, int n)
+    {
+      auto* out = s.a.a.data();
+      if constexpr (std::is_same_v<V, scalar_type_t<decltype(s.a)>>) {
+        s.op(out[n], vectorize<V>(s.b, n));
+      }
+      else {
+        V lhs = simd_load<V, align>(out + n);
+        s.op(lhs, vectorize<V>(s.b, n));
+        simd_store<V, align>(out + n, lhs);
+      }
+    }
+
+    /// Stream elementwise statements over storage, like `evaluate_linear`.
+    void fused_linear(auto&& s, auto&&... ts)
+    {
+      using T = scalar_type_t<decltype(s.a)>;
+      using Layout = vector_layout_t<decltype(s.a)>;
+      constexpr int size = Layout::size;
+      constexpr int align = Layout::align;
+      constexpr int bytes = (int(sizeof(T)) < align and align < simd_bytes) ? align : simd_bytes;
+      using V = simd_t<T, bytes>;
+      constexpr int W = simd_width_v<T, bytes>;
+
+      int n = 0;
+      for (; n + W <= size; n += W) {
+        linear_step<V, align>(s, n);
+        (linear_step<V, align>(ts, n), ...);
+      }
+
+      for (; n < size; ++n) {
+        linear_step<T, align>(s, n);
+        (linear_step<T, align>(ts, n), ...);
+      }
+    }
+  }
+
+  /// Evaluate several assignments over the same index space in one loop nest.
+  ///
+  ///     albert::fuse(
+  ///       albert::defer(σ(i,j)) = 2 * μ * ε(i,j) + λ * ε(k,k) * δ(i,j),
+  ///       albert::defer(s(i,j)) = σ(i,j) - κ * ε(k,k) * δ(i,j),
+  ///       albert::defer(P(i,j)) += dt * s(i,j));
+  ///
+  /// Each iteration evaluates every statement in order, so a later statement
+  /// reads the element that an earlier statement just wrote while it's still
+  /// in a register, rather than on another pass over memory. Purely
+  /// elementwise statements stream over storage with explicit vectors, like
+  /// a single elementwise assignment.
+  ///
+  /// This is only valid when no statement reads or writes an element that
+  /// another statement writes in a different iteration. The check uses the
+  /// same dependence analysis as a single assignment (see `Access`), where
+  /// only pointwise reads are allowed (e.g., a statement that reads `σ(k,k)`
+  /// conflicts with the statement that writes `σ(i,j)`), refined at runtime
+  /// by the storage that the statements actually use. Conflicting statements,
+  /// and left-hand-sides with packed storage, are evaluated one at a time, in
+  /// order.
+  ///
+  /// Every left-hand-side must have the same outer index characters, the loop
+  /// nest visits the first left-hand-side in its storage order.
+  template <class S, class... T>
+  constexpr void fuse(S&& s, T&&... ts)
+  {
+    constexpr TensorIndex outer = outer_v<decltype(s.a)>;
+    static_assert((is_permutation(outer, outer_v<decltype(s.b)>) and ... and
+                   (is_permutation(outer, outer_v<decltype(ts.a)>) and
+                    is_permutation(outer, outer_v<decltype(ts.b)>))),
+                  "indices don't match in fused assignments");
+
+    constexpr bool packed = (detail::is_packed_v<decltype(s.a)> or ... or
+                             detail::is_packed_v<decltype(ts.a)>);
+
+    if constexpr (packed or sizeof...(T) == 0) {
+      s.a.assign(FWD(s).b, s.op);
+      (ts.a.assign(FWD(ts).b, ts.op), ...);
+    }
+    else {
+      // The dependence check is made on the original expressions, any
+      // temporaries introduced by materialization are computed before any
+      // left-hand-side is written.
+      if (detail::any_conflicts(s, ts...)) {
+        s.a.assign(FWD(s).b, s.op);
+        (ts.a.assign(FWD(ts).b, ts.op), ...);
+        return;
+      }
+
+      using A = decltype(s.a);
+      if constexpr (detail::is_linear_v<A, S> and (detail::is_linear_v<A, T> and ...)) {
+        if (not std::is_constant_evaluated()) {
+          return detail::fused_linear(s, ts...);
+        }
+      }
+
+      auto m = [](auto&& s) {
+        return Statement<decltype(s.a), decltype(materialize(FWD(s).b)), decltype(s.op)> {
+          s.a, materialize(FWD(s).b), s.op
+        };
+      };
+      detail::fused(m(FWD(s)), m(FWD(ts))...);
+    }
+  }
+}
+
+#endif // ALBERT_INCLUDE_FUSE_HPP
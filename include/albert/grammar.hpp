@@ -5,6 +5,7 @@
 #include "albert/Tensor.hpp"
 #include "albert/cmath.hpp"
 #include "albert/concepts.hpp"
+#include "albert/derivative.hpp"
 #include "albert/expressions.hpp"
 #include "albert/utils.hpp"
 #include <concepts>
@@ -36,39 +37,69 @@ namespace albert
       {
         return Literal(i);
       }
+
+      /// Matrix operations accept bound expressions (`det(F(i,j))`) or bind
+      /// unbound order 2 tensors themselves (`det(F)`).
+      /// @{
+      constexpr auto matrix(is_expression auto&& a)
+        -> decltype(auto)
+      {
+        return FWD(a);
+      }
+
+      template <is_tensor A>
+      requires (not is_expression<A>)
+      constexpr auto matrix(A&& a)
+      {
+        static_assert(order_v<A> == 2, "matrix operations require an order 2 tensor");
+        return FWD(a)(Index<'i'>{}, Index<'j'>{});
+      }
+      /// @}
     }
 
+    /// The grammar builds an expression when at least one operand is not a
+    /// scalar. Scalars, including the custom scalar types like `Dual`, use
+    /// their own operators and functions.
+    template <class... Ts>
+    concept any_tensor = (not is_scalar<std::remove_cvref_t<Ts>> or ...);
+
     template <is_tensor A>
+    requires any_tensor<A>
     constexpr auto operator+(A&& a)
     {
       return detail::promote(FWD(a));
     }
 
     template <is_tensor A, is_tensor B>
+    requires any_tensor<A, B>
     constexpr auto operator+(A&& a, B&& b)
     {
       return Sum { detail::promote(FWD(a)), detail::promote(FWD(b)) };
     }
 
     template <is_tensor A>
+    requires any_tensor<A>
     constexpr auto operator-(A&& a)
     {
       return Negate { detail::promote(FWD(a)) };
     }
 
     template <is_tensor A, is_tensor B>
+    requires any_tensor<A, B>
     constexpr auto operator-(A&& a, B&& b)
     {
       return Diff { detail::promote(FWD(a)), detail::promote(FWD(b)) };
     }
 
     template <is_tensor A, is_tensor B>
+    requires any_tensor<A, B>
     constexpr auto operator*(A&& a, B&& b)
     {
       return Product { detail::promote(FWD(a)), detail::promote(FWD(b)) };
     }
 
     template <is_tensor A, is_tensor B>
+    requires any_tensor<A, B>
     constexpr auto operator/(A&& a, B&& b)
     {
       if constexpr (std::integral<std::remove_cvref_t<B>>) {
@@ -79,13 +110,13 @@ namespace albert
       }
     }
 
-    // template <is_tensor A>
-    // constexpr auto D(A&& a, is_index auto i, is_index auto... is)
-    // {
-    //   constexpr Index index = (i + ... + is);
-    //   constexpr TensorIndex jindex(index);
-    //   return Partial<decltype(detail::promote(FWD(a))), jindex> { detail::promote(FWD(a)) };
-    // }
+    /// The partial derivative of `a` with respect to a bound tensor, e.g.,
+    /// `D(S(i,j), E(k,l))` (see derivative.hpp).
+    template <is_tensor A, is_expression X>
+    constexpr auto D(A&& a, X&& x)
+    {
+      return Partial { detail::promote(FWD(a)), FWD(x) };
+    }
 
     template <is_index i, is_index j>
     constexpr auto δ(i, j)
@@ -108,7 +139,13 @@ namespace albert
     {
       auto&& b = detail::promote(FWD(a));
       constexpr TensorIndex j = outer_v<decltype(b)>.reverse();
-      return detail::promote(1) / detail::promote(2) * (b + b.template rebind<j>());
+      return (b + b.template rebind<j>()) / 2;
+    }
+
+    template <is_tensor A>
+    constexpr auto lazy(A&& a)
+    {
+      return Lazy { detail::promote(FWD(a)) };
     }
 
     template <is_tensor A>
@@ -117,139 +154,200 @@ namespace albert
       return Inverse { detail::promote(FWD(a)) };
     }
 
-    template <is_tensor A, is_tensor B>
+    /// The determinant of a matrix, either bound (`det(F(i,j))`) or not
+    /// (`det(F)`).
+    template <is_tensor A>
+    constexpr auto det(A&& a)
+    {
+      return Determinant { detail::matrix(FWD(a)) };
+    }
+
+    /// The matrix exponential, logarithm, and square root, either bound
+    /// (`expm(A(i,j))`) or not (`expm(A)`).
+    /// @{
+    template <is_tensor A>
+    constexpr auto expm(A&& a)
+    {
+      return MatrixFunction(detail::matrix(FWD(a)), matrix_function_tag_v<EXPM>);
+    }
+
+    template <is_tensor A>
+    constexpr auto logm(A&& a)
+    {
+      return MatrixFunction(detail::matrix(FWD(a)), matrix_function_tag_v<LOGM>);
+    }
+
+    template <is_tensor A>
+    constexpr auto sqrtm(A&& a)
+    {
+      return MatrixFunction(detail::matrix(FWD(a)), matrix_function_tag_v<SQRTM>);
+    }
+    /// @}
+
+    /// The polar decomposition `F = R U`, evaluated once into the orthogonal
+    /// `R` and the symmetric `U`, and the code returned by `solver::polar`,
+    /// e.g., `auto [R, U, info] = polar(F)`.
+    template <is_tensor A>
+    constexpr auto polar(A&& a)
+    {
+      return Polar(materialize(detail::matrix(FWD(a))));
+    }
+
+    /// The cmath functions apply elementwise. Each takes an optional accuracy
+    /// policy, e.g., `exp<cmath_policy::fast>(A(i,j))`, which otherwise
+    /// defaults to `default_cmath_policy`.
+    template <cmath_policy P = default_cmath_policy, is_tensor A, is_tensor B>
+    requires any_tensor<A, B>
     constexpr auto fmin(A&& a, B&& b)
     {
-      assert(a.order() == 0);
-      return CMath2(detail::promote(FWD(a)), detail::promote(FWD(b)), cmath_tag_v<FMIN>);
+      return CMath2(detail::promote(FWD(a)), detail::promote(FWD(b)), cmath_tag_v<FMIN>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A, is_tensor B>
+    template <cmath_policy P = default_cmath_policy, is_tensor A, is_tensor B>
+    requires any_tensor<A, B>
     constexpr auto fmax(A&& a, B&& b)
     {
-      assert(a.order() == 0);
-      return CMath2(detail::promote(FWD(a)), detail::promote(FWD(b)), cmath_tag_v<FMAX>);
+      return CMath2(detail::promote(FWD(a)), detail::promote(FWD(b)), cmath_tag_v<FMAX>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A, is_tensor B>
+    template <cmath_policy P = default_cmath_policy, is_tensor A, is_tensor B>
+    requires any_tensor<A, B>
     constexpr auto pow(A&& a, B&& b)
     {
-      return CMath2(detail::promote(FWD(a)), detail::promote(FWD(b)), cmath_tag_v<POW>);
+      return CMath2(detail::promote(FWD(a)), detail::promote(FWD(b)), cmath_tag_v<POW>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto abs(A&& a)
     {
-      assert(a.order() == 0);
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<ABS>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<ABS>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto exp(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<EXP>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<EXP>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto log(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<LOG>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<LOG>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto sqrt(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<SQRT>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<SQRT>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto sin(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<SIN>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<SIN>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto cos(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<COS>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<COS>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto tan(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<TAN>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<TAN>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto asin(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<ASIN>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<ASIN>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto acos(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<ACOS>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<ACOS>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto atan(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<ATAN>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<ATAN>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
-    constexpr auto atan2(A&& a)
+    template <cmath_policy P = default_cmath_policy, is_tensor A, is_tensor B>
+    requires any_tensor<A, B>
+    constexpr auto atan2(A&& a, B&& b)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<ATAN2>);
+      return CMath2(detail::promote(FWD(a)), detail::promote(FWD(b)), cmath_tag_v<ATAN2>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto sinh(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<SINH>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<SINH>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto cosh(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<COSH>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<COSH>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto tanh(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<TANH>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<TANH>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto asinh(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<ASINH>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<ASINH>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto acosh(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<ACOSH>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<ACOSH>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto atanh(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<ATANH>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<ATANH>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto ceil(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<CEIL>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<CEIL>, cmath_policy_v<P>);
     }
 
-    template <is_tensor A>
+    template <cmath_policy P = default_cmath_policy, is_tensor A>
+    requires any_tensor<A>
     constexpr auto floor(A&& a)
     {
-      return CMath(detail::promote(FWD(a)), cmath_tag_v<FLOOR>);
+      return CMath(detail::promote(FWD(a)), cmath_tag_v<FLOOR>, cmath_policy_v<P>);
     }
   } // inline namespace grammar
 } // namespace albert
@@ -0,0 +1,106 @@
+#ifndef ALBERT_INCLUDE_MATERIALIZE_HPP
+#define ALBERT_INCLUDE_MATERIALIZE_HPP
+
+#include "albert/utils.hpp"
+#include <type_traits>
+#include <utility>
+
+namespace albert
+{
+  /// Rewrite an expression tree before it is evaluated.
+  ///
+  /// The materializer for a node type reports if its subtree `changes` during
+  /// materialization and, if so, knows how to `apply` the rewrite to an
+  /// instance. The primary template is used for leaves and any node that
+  /// doesn't need to be rewritten, and forwards the node unchanged.
+  ///
+  /// Node types that need to participate specialize this template. The main
+  /// client is the `Product` node, which evaluates nested contractions into
+  /// stack temporaries once, rather than recomputing them for every element of
+  /// the parent contraction.
+  template <class E>
+  struct materializer
+  {
+    constexpr static bool changes = false;
+  };
+
+  /// Materialize an expression.
+  ///
+  /// Returns a reference to the expression itself if it doesn't change, and a
+  /// new expression tree otherwise.
+  template <class E>
+  constexpr auto materialize(E&& e) -> decltype(auto)
+  {
+    if constexpr (materializer<std::remove_cvref_t<E>>::changes) {
+      return materializer<std::remove_cvref_t<E>>::apply(FWD(e));
+    }
+    else {
+      return FWD(e);
+    }
+  }
+
+  /// How common subexpression elimination visits a node (see cse.hpp).
+  ///
+  /// Interior nodes report their `arity`, i.e., whether their children are
+  /// `a` or `a` and `b`, whether they are `elementwise`, i.e., cheaper to
+  /// recompute than to store, whether two instances have the `same` state
+  /// other than their children, and how to `rebuild` an instance with new
+  /// children. The primary template is used for leaves and for nodes that hide
+  /// their subtree (like `lazy()`), which are only the same when they are
+  /// stateless.
+  template <class E>
+  struct subexpression
+  {
+    constexpr static int arity = 0;
+    constexpr static bool elementwise = true;
+
+    constexpr static bool same(E const&, E const&)
+    {
+      return std::is_empty_v<E>;
+    }
+  };
+
+  /// Interior nodes whose only state is their children.
+  template <int n, bool e = true>
+  struct stateless_subexpression
+  {
+    constexpr static int arity = n;
+    constexpr static bool elementwise = e;
+
+    constexpr static bool same(auto const&, auto const&)
+    {
+      return true;
+    }
+  };
+
+  namespace cse
+  {
+    /// Does the tree rooted at `E` have a repeated subtree to share.
+    ///
+    /// The primary template is used when there isn't one, and the partial
+    /// specialization that shares them is in cse.hpp.
+    template <class E>
+    struct sharing
+    {
+      constexpr static bool changes = false;
+    };
+  }
+
+  /// Share the repeated subtrees of an expression.
+  ///
+  /// The repeated subtrees are evaluated into temporaries that only live as
+  /// long as this call, so the rewritten expression is passed to `f` rather
+  /// than returned.
+  template <class E, class F>
+  constexpr auto share(E&& e, F&& f) -> decltype(auto)
+  {
+    if constexpr (cse::sharing<std::remove_cvref_t<E>>::changes) {
+      return cse::sharing<std::remove_cvref_t<E>>::apply(FWD(e), FWD(f));
+    }
+    else {
+      return FWD(f)(FWD(e));
+    }
+  }
+}
+
+#endif // ALBERT_INCLUDE_MATERIALIZE_HPP
@@ -0,0 +1,291 @@
+#ifndef ALBERT_INCLUDE_PARALLEL_HPP
+#define ALBERT_INCLUDE_PARALLEL_HPP
+
+#include "albert/utils.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// The target number of floating point operations in each task scheduled by
+/// `for_each_batch`. Tasks need to be large enough to amortize the cost of
+/// scheduling and stealing, and small enough to balance the load.
+#ifndef ALBERT_GRAIN_FLOPS
+#define ALBERT_GRAIN_FLOPS 32768
+#endif
+
+namespace albert
+{
+  constexpr inline long grain_flops = ALBERT_GRAIN_FLOPS;
+
+  /// A fixed-size pool of threads that runs parallel loops.
+  ///
+  /// Each loop is split into a contiguous range of chunks per thread. Threads
+  /// take chunks from the front of their own range and, once their range is
+  /// empty, steal the back half of another thread's range. The calling thread
+  /// participates as thread 0, so a pool of size 1 runs loops serially.
+  ///
+  /// Loops started concurrently from different threads run one at a time, and
+  /// a loop started from inside another loop's body runs serially on the
+  /// thread that started it.
+  class ThreadPool
+  {
+    /// The chunks remaining for one thread, padded to avoid false sharing.
+    struct alignas(64) Range
+    {
+      std::mutex lock;
+      long begin = 0;
+      long end = 0;
+    };
+
+    int _n;
+    std::unique_ptr<Range[]> _ranges;
+    std::vector<std::thread> _threads;
+
+    std::mutex _call;
+    std::mutex _lock;
+    std::condition_variable _start;
+    std::condition_variable _done;
+    long _generation = 0;
+    int _pending = 0;
+    bool _stop = false;
+
+    // The current loop.
+    long _grain = 1;
+    long _size = 0;
+    void* _body = nullptr;
+    void (*_run)(void*, long, long) = nullptr;
+    std::exception_ptr _error;
+
+    /// Set on threads that are running a loop body, for any pool.
+    inline static thread_local bool _in_pool = false;
+
+  public:
+    explicit ThreadPool(int n = std::thread::hardware_concurrency())
+        : _n(max(n, 1))
+        , _ranges(new Range[_n])
+    {
+      for (int w = 1; w < _n; ++w) {
+        _threads.emplace_back([this, w] { worker(w); });
+      }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    auto operator=(ThreadPool const&) -> ThreadPool& = delete;
+
+    ~ThreadPool()
+    {
+      {
+        std::scoped_lock _(_lock);
+        _stop = true;
+      }
+      _start.notify_all();
+      for (auto& thread : _threads) {
+        thread.join();
+      }
+    }
+
+    auto size() const -> int
+    {
+      return _n;
+    }
+
+    /// Call `f(begin, end)` for disjoint subranges that cover `[0, n)`.
+    ///
+    /// Each subrange has at most `grain` elements. The first exception thrown
+    /// by `f` is rethrown once the loop is complete.
+    template <class F>
+    void parallel_for(long n, long grain, F&& f)
+    {
+      if (n <= 0) {
+        return;
+      }
+
+      grain = std::max(grain, 1l);
+      if (_n == 1 or n <= grain or _in_pool) {
+        for (long i = 0; i < n; i += grain) {
+          f(i, std::min(i + grain, n));
+        }
+        return;
+      }
+
+      // The loop state is shared by the whole pool, so only one loop runs at
+      // a time.
+      std::scoped_lock call(_call);
+      {
+        std::scoped_lock _(_lock);
+        _grain = grain;
+        _size = n;
+        _body = std::addressof(f);
+        _run = [](void* body, long begin, long end) {
+          (*static_cast<std::remove_reference_t<F>*>(body))(begin, end);
+        };
+        _error = nullptr;
+
+        long chunks = (n + grain - 1) / grain;
+        for (int w = 0; w < _n; ++w) {
+          _ranges[w].begin = chunks * w / _n;
+          _ranges[w].end = chunks * (w + 1) / _n;
+        }
+
+        _pending = _n - 1;
+        _generation += 1;
+      }
+      _start.notify_all();
+
+      _in_pool = true;
+      work(0);
+      _in_pool = false;
+
+      std::unique_lock lock(_lock);
+      _done.wait(lock, [&] { return _pending == 0; });
+      if (_error) {
+        std::rethrow_exception(std::exchange(_error, nullptr));
+      }
+    }
+
+  private:
+    void worker(int w)
+    {
+      _in_pool = true;
+      long generation = 0;
+      while (true) {
+        {
+          std::unique_lock lock(_lock);
+          _start.wait(lock, [&] { return _stop or _generation != generation; });
+          if (_stop) {
+            return;
+          }
+          generation = _generation;
+        }
+
+        work(w);
+
+        {
+          std::scoped_lock _(_lock);
+          if (--_pending == 0) {
+            _done.notify_one();
+          }
+        }
+      }
+    }
+
+    /// Run chunks until there is no work left to take or steal.
+    void work(int w)
+    {
+      long chunk;
+      while (take(w, chunk) or steal(w, chunk)) {
+        long begin = chunk * _grain;
+        long end = std::min(begin + _grain, _size);
+        try {
+          _run(_body, begin, end);
+        }
+        catch (...) {
+          std::scoped_lock _(_lock);
+          if (not _error) {
+            _error = std::current_exception();
+          }
+        }
+      }
+    }
+
+    /// Take the next chunk from the front of this thread's range.
+    auto take(int w, long& chunk) -> bool
+    {
+      Range& range = _ranges[w];
+      std::scoped_lock _(range.lock);
+      if (range.begin == range.end) {
+        return false;
+      }
+      chunk = range.begin++;
+      return true;
+    }
+
+    /// Steal the back half of another thread's range.
+    auto steal(int w, long& chunk) -> bool
+    {
+      for (int i = 1; i < _n; ++i) {
+        Range& victim = _ranges[(w + i) % _n];
+        long begin, end;
+        {
+          std::scoped_lock _(victim.lock);
+          long n = victim.end - victim.begin;
+          if (n == 0) {
+            continue;
+          }
+          begin = victim.end - (n + 1) / 2;
+          end = victim.end;
+          victim.end = begin;
+        }
+
+        Range& range = _ranges[w];
+        std::scoped_lock _(range.lock);
+        chunk = begin;
+        range.begin = begin + 1;
+        range.end = end;
+        return true;
+      }
+      return false;
+    }
+  };
+
+  /// The pool used by `for_each_batch` when none is provided.
+  inline auto default_pool() -> ThreadPool&
+  {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  /// Choose the number of elements in each task of a parallel batch.
+  ///
+  /// Tasks target `grain_flops` operations, given the estimated `flops` for
+  /// each element, but are kept small enough that each thread starts with
+  /// several tasks so that there is something to steal.
+  constexpr auto grain_size(long n, long flops, int threads) -> long
+  {
+    long grain = grain_flops / std::max(flops, 1l);
+    long limit = n / (8l * threads);
+    return std::max(std::min(grain, limit), 1l);
+  }
+
+  /// Apply `f` to every element of a random access range in parallel.
+  ///
+  /// This is intended for evaluating the same expression over many tensors,
+  /// e.g., one material point or one `TensorBatch` per element.
+  ///
+  ///     for_each_batch(points, [&](Point& p) {
+  ///       p.sigma(i,j) = D(i,j,k,l) * p.epsilon(k,l);
+  ///     }, flops(D(i,j,k,l) * epsilon(k,l)));
+  ///
+  /// The optional `flops` is the estimated cost of each call to `f` (see
+  /// `albert::flops()`) and is used to choose the grain size.
+  template <std::ranges::random_access_range R, class F>
+  requires std::ranges::sized_range<R>
+  void for_each_batch(ThreadPool& pool, R&& range, F&& f, long flops = 1)
+  {
+    auto first = std::ranges::begin(range);
+    long n = std::ranges::size(range);
+    long grain = grain_size(n, flops, pool.size());
+    pool.parallel_for(n, grain, [&](long begin, long end) {
+      for (long i = begin; i < end; ++i) {
+        f(first[i]);
+      }
+    });
+  }
+
+  template <std::ranges::random_access_range R, class F>
+  requires std::ranges::sized_range<R>
+  void for_each_batch(R&& range, F&& f, long flops = 1)
+  {
+    for_each_batch(default_pool(), FWD(range), FWD(f), flops);
+  }
+}
+
+#endif // ALBERT_INCLUDE_PARALLEL_HPP
@@ -0,0 +1,179 @@
+#ifndef ALBERT_INCLUDE_SIMD_HPP
+#define ALBERT_INCLUDE_SIMD_HPP
+
+#include "albert/utils.hpp"
+#include <concepts>
+#include <type_traits>
+
+/// The width, in bytes, of the vector registers used for explicit SIMD
+/// kernels. This defaults to the widest vector unit enabled for the target, and
+/// 0 disables the explicit kernels.
+#ifndef ALBERT_SIMD_BYTES
+#  if defined(__AVX512F__)
+#    define ALBERT_SIMD_BYTES 64
+#  elif defined(__AVX__)
+#    define ALBERT_SIMD_BYTES 32
+#  else
+#    define ALBERT_SIMD_BYTES 16
+#  endif
+#endif
+
+namespace albert
+{
+  constexpr inline int simd_bytes = ALBERT_SIMD_BYTES;
+
+  /// A native vector of `T`, using the compiler's vector extensions.
+  ///
+  /// Vectors default to the full width, but narrower vectors are used to
+  /// stream small aligned tensors without a remainder.
+  template <std::floating_point T, int Bytes = simd_bytes>
+  struct simd_vector
+  {
+    typedef T type __attribute__((vector_size(Bytes)));
+  };
+
+  template <std::floating_point T, int Bytes = simd_bytes>
+  using simd_t = typename simd_vector<T, Bytes>::type;
+
+  template <std::floating_point T, int Bytes = simd_bytes>
+  constexpr inline int simd_width_v = Bytes / sizeof(T);
+
+  /// The element type of a vector, or the type itself for scalars.
+  template <class V>
+  struct simd_element
+  {
+    using type = V;
+  };
+
+  template <class V>
+  requires requires (V v) { v[0]; }
+  struct simd_element<V>
+  {
+    using type = std::remove_cvref_t<decltype(std::declval<V>()[0])>;
+  };
+
+  template <class V>
+  using simd_element_t = typename simd_element<V>::type;
+
+  /// Load a vector (or a scalar) from memory.
+  ///
+  /// The address is only assumed to be aligned to the width of the vector
+  /// when it is known to be aligned to `Align` bytes.
+  template <class V, int Align = 0>
+  auto simd_load(simd_element_t<V> const* p) -> V
+  {
+    V v;
+    if constexpr (Align >= int(sizeof(V))) {
+      __builtin_memcpy(&v, __builtin_assume_aligned(p, sizeof(V)), sizeof(V));
+    }
+    else {
+      __builtin_memcpy(&v, p, sizeof(V));
+    }
+    return v;
+  }
+
+  /// Store a vector (or a scalar) to memory.
+  template <class V, int Align = 0>
+  void simd_store(simd_element_t<V>* p, V const& v)
+  {
+    if constexpr (Align >= int(sizeof(V))) {
+      __builtin_memcpy(__builtin_assume_aligned(p, sizeof(V)), &v, sizeof(V));
+    }
+    else {
+      __builtin_memcpy(p, &v, sizeof(V));
+    }
+  }
+
+  /// Splat a scalar into every lane of a vector.
+  template <class V>
+  auto simd_broadcast(simd_element_t<V> x) -> V
+  {
+    if constexpr (std::is_same_v<V, simd_element_t<V>>) {
+      return x;
+    }
+    else {
+      V v;
+      for (int i = 0; i < int(sizeof(V) / sizeof(x)); ++i) {
+        v[i] = x;
+      }
+      return v;
+    }
+  }
+
+  /// Apply a scalar function to each lane of a vector (or to a scalar).
+  template <class V>
+  constexpr auto simd_map(V x, auto&& f) -> V
+  {
+    if constexpr (std::is_same_v<V, simd_element_t<V>>) {
+      return f(x);
+    }
+    else {
+      for (int i = 0; i < int(sizeof(V) / sizeof(x[0])); ++i) {
+        x[i] = f(x[i]);
+      }
+      return x;
+    }
+  }
+
+  /// Evaluate an expression tree directly over linear storage.
+  ///
+  /// A tree is vectorizable when it is purely elementwise, every tensor leaf
+  /// is bound in the same index order as the tree's outer index and stored in
+  /// the same layout, and all of its elements share a single floating point
+  /// type. Such a tree can be
+  /// evaluated with a flat streaming loop over the leaves' storage rather than
+  /// through per-element scalar index evaluation.
+  ///
+  /// Node types that can be vectorized specialize this template. Each
+  /// specialization reports if it is `enabled` and knows how to `apply` the
+  /// node to the linear offset `n`, producing either a single element or a
+  /// whole vector `V` of consecutive elements.
+  template <class E>
+  struct vectorizer
+  {
+    constexpr static bool enabled = false;
+  };
+
+  template <class E>
+  concept is_vectorizable = simd_bytes != 0 and vectorizer<std::remove_cvref_t<E>>::enabled;
+
+  template <class V, is_vectorizable E>
+  auto vectorize(E const& e, int n) -> V
+  {
+    return vectorizer<std::remove_cvref_t<E>>::template apply<V>(e, n);
+  }
+
+  /// The storage layout that a vectorizable tree streams over.
+  ///
+  /// Offset `n` only means the same element in two leaves when they share a
+  /// layout, so vectorizers that read storage report it as `layout`. Nodes
+  /// that broadcast a scalar don't have a layout (`void`) and are compatible
+  /// with any other node.
+  template <class E>
+  struct vector_layout
+  {
+    using type = void;
+  };
+
+  template <class E>
+  requires requires { typename vectorizer<std::remove_cvref_t<E>>::layout; }
+  struct vector_layout<E>
+  {
+    using type = typename vectorizer<std::remove_cvref_t<E>>::layout;
+  };
+
+  template <class E>
+  using vector_layout_t = typename vector_layout<E>::type;
+
+  template <class A, class B>
+  constexpr inline bool same_vector_layout_v = (std::is_void_v<vector_layout_t<A>> or
+                                                std::is_void_v<vector_layout_t<B>> or
+                                                std::is_same_v<vector_layout_t<A>, vector_layout_t<B>>);
+
+  template <class A, class B>
+  using common_vector_layout_t = std::conditional_t<std::is_void_v<vector_layout_t<A>>,
+                                                    vector_layout_t<B>,
+                                                    vector_layout_t<A>>;
+}
+
+#endif // ALBERT_INCLUDE_SIMD_HPP
@@ -0,0 +1,514 @@
+#ifndef ALBERT_INCLUDE_SIMD_MATH_HPP
+#define ALBERT_INCLUDE_SIMD_MATH_HPP
+
+#include "albert/simd.hpp"
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+/// Vector implementations of the elementary functions.
+///
+/// Vectorized cmath nodes evaluate a whole vector of consecutive elements at
+/// once. The exponential, logarithm, and power use range reduction and a
+/// polynomial in every lane, rather than a call to libm per element. They come
+/// in two accuracies, which the `cmath_policy` of a node chooses between.
+///
+/// - `simd_exp`, `simd_log`, and `simd_pow` are accurate to 4 ulp over their
+///   full domain, including the subnormals, infinities, and nans.
+/// - `simd_fast_exp` and `simd_fast_log` use shorter polynomials and skip the
+///   special cases. They are accurate to 2^13 ulp in double precision and 64
+///   ulp in single precision, and require finite arguments, and positive
+///   normal arguments for the logarithm. `simd_fast_pow` requires a positive
+///   normal base, and its error grows to 2^13 (1 + |b log(a)|) ulp in double
+///   precision. Single precision powers are computed in double precision,
+///   and are accurate to 1 ulp in both cases.
+///
+/// The square root, absolute value, and rounding functions are written
+/// lane-wise in a form that compiles to the native vector instructions. The
+/// remaining functions call libm once per lane.
+///
+/// Scalars are forwarded to the standard functions.
+namespace albert
+{
+  namespace detail
+  {
+    /// The integer vector with the same lane width as `V`.
+    template <class V>
+    using simd_int_t = decltype(std::declval<V>() < std::declval<V>());
+
+    /// The constants for the floating point type `T`.
+    template <class T>
+    struct simd_math_constants;
+
+    template <>
+    struct simd_math_constants<double>
+    {
+      constexpr static int mantissa = 52;
+      constexpr static int bias = 1023;
+      constexpr static int terms_exp = 13;      // |r| <= ln(2)/2
+      constexpr static int terms_log = 11;      // |s| <= 3 - 2 sqrt(2)
+      constexpr static int terms_log_dd = 13;
+      constexpr static int fast_terms_exp = 10;
+      constexpr static int fast_terms_log = 7;
+      constexpr static double max_exp = 709.782712893383996843;
+      constexpr static double min_exp = -745.133219101941108420;
+      constexpr static double subnormal_scale = 0x1p54;
+      constexpr static int subnormal_exponent = 54;
+    };
+
+    template <>
+    struct simd_math_constants<float>
+    {
+      constexpr static int mantissa = 23;
+      constexpr static int bias = 127;
+      constexpr static int terms_exp = 7;
+      constexpr static int terms_log = 5;
+      constexpr static int terms_log_dd = 7;
+      constexpr static int fast_terms_exp = 5;
+      constexpr static int fast_terms_log = 3;
+      constexpr static float max_exp = 88.7228391f;
+      constexpr static float min_exp = -103.972084f;
+      constexpr static float subnormal_scale = 0x1p25f;
+      constexpr static int subnormal_exponent = 25;
+    };
+
+    /// ln(2) split so that `n * ln2_hi` is exact for the `n` that we need.
+    template <class T>
+    constexpr inline T ln2_hi = T(0.693359375);
+
+    template <class T>
+    constexpr inline T ln2_lo = T(-2.12194440054690582768e-4);
+
+    /// Round to the nearest integer with the magic number trick, returning it
+    /// as both a floating point and an integer vector.
+    ///
+    /// Adding 1.5 * 2^p (p is the mantissa width) leaves the rounded integer in
+    /// the low bits of the mantissa, which is valid for |x| < 2^(p-1).
+    template <class V>
+    auto simd_round(V x, simd_int_t<V>& k) -> V
+    {
+      using T = simd_element_t<V>;
+      using I = simd_int_t<V>;
+      constexpr T magic = T(1.5) * T(1ll << simd_math_constants<T>::mantissa);
+      V const m = simd_broadcast<V>(magic);
+      V t = x + m;
+      k = (I)t - (I)m;
+      return t - m;
+    }
+
+    /// Convert a (small) integer vector to floating point with the same trick.
+    template <class V>
+    auto simd_convert(simd_int_t<V> k) -> V
+    {
+      using T = simd_element_t<V>;
+      using I = simd_int_t<V>;
+      constexpr T magic = T(1.5) * T(1ll << simd_math_constants<T>::mantissa);
+      V const m = simd_broadcast<V>(magic);
+      return (V)(k + (I)m) - m;
+    }
+
+    /// 2^k for integers k in the normal exponent range.
+    template <class V>
+    auto simd_exp2i(simd_int_t<V> k) -> V
+    {
+      using C = simd_math_constants<simd_element_t<V>>;
+      return (V)((k + C::bias) << C::mantissa);
+    }
+
+    /// Keep a rounded product from being contracted into a fused multiply-add
+    /// with the expression that uses it.
+    template <class V>
+    auto simd_fence(V x) -> V
+    {
+#if __has_builtin(__builtin_assoc_barrier)
+      return __builtin_assoc_barrier(x);
+#else
+      return x;
+#endif
+    }
+
+    /// The error free sum and product, `a + b = s + e` and `a * b = p + e`.
+    ///
+    /// The product splits its operands in halves (Veltkamp and Dekker), so it
+    /// does not depend on a fused multiply-add.
+    /// @{
+    template <class V>
+    auto simd_two_sum(V a, V b, V& e) -> V
+    {
+      V s = a + b;
+      V c = s - a;
+      e = (a - (s - c)) + (b - c);
+      return s;
+    }
+
+    template <class V>
+    void simd_split(V a, V& hi, V& lo)
+    {
+      using T = simd_element_t<V>;
+      constexpr T veltkamp = T((1ll << (simd_math_constants<T>::mantissa + 2) / 2) + 1);
+      V c = simd_fence(a * veltkamp);
+      hi = c - (c - a);
+      lo = a - hi;
+    }
+
+    template <class V>
+    auto simd_two_product(V a, V b, V& e) -> V
+    {
+      V p = simd_fence(a * b);
+      V ah, al, bh, bl;
+      simd_split(a, ah, al);
+      simd_split(b, bh, bl);
+      e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+      return p;
+    }
+    /// @}
+
+    /// Evaluate the polynomial `sum(c[i] x^i)` with Horner's rule, unrolled.
+    template <class V, class T, std::size_t N>
+    auto simd_polynomial(V x, std::array<T, N> const& c) -> V
+    {
+      return [&]<std::size_t... i>(std::index_sequence<i...>) {
+        V p = simd_broadcast<V>(c[N - 1]);
+        ((p = p * x + c[N - 2 - i]), ...);
+        return p;
+      }(std::make_index_sequence<N - 1>());
+    }
+
+    /// exp(y) for y in [min_exp, max_exp], with `Terms` terms of its Taylor
+    /// series after the reduction.
+    template <int Terms, class V>
+    auto simd_exp_kernel(V y) -> V
+    {
+      using T = simd_element_t<V>;
+      using I = simd_int_t<V>;
+
+      // y = k ln(2) + r, with |r| <= ln(2)/2
+      I k;
+      V n = simd_round(y * T(1.44269504088896340736), k);
+      V r = y - n * ln2_hi<T>;
+      r = r - n * ln2_lo<T>;
+
+      // exp(r) from its Taylor series
+      constexpr auto c = [] {
+        std::array<T, Terms + 1> c = { T(1) };
+        for (int i = 1; i <= Terms; ++i) {
+          c[i] = c[i - 1] / T(i);
+        }
+        return c;
+      }();
+      V p = simd_polynomial(r, c);
+
+      // scale by 2^k in two steps, so that the results near overflow and the
+      // subnormals are exact
+      I k1 = k >> 1;
+      return p * simd_exp2i<V>(k1) * simd_exp2i<V>(k - k1);
+    }
+
+    /// Clamp `x` to the domain of `simd_exp_kernel`.
+    template <class V>
+    auto simd_exp_clamp(V x) -> V
+    {
+      using C = simd_math_constants<simd_element_t<V>>;
+      V y = (x > C::max_exp) ? simd_broadcast<V>(C::max_exp) : x;
+      return (y < C::min_exp) ? simd_broadcast<V>(C::min_exp) : y;
+    }
+  }
+
+  template <class V>
+  auto simd_exp(V x) -> V
+  {
+    if constexpr (std::is_same_v<V, simd_element_t<V>>) {
+      return std::exp(x);
+    }
+    else {
+      using T = simd_element_t<V>;
+      using C = detail::simd_math_constants<T>;
+
+      // clamp so that the reduction stays in range, and patch the overflow,
+      // underflow, and nan lanes at the end
+      V e = detail::simd_exp_kernel<C::terms_exp>(detail::simd_exp_clamp(x));
+      e = (x > C::max_exp) ? simd_broadcast<V>(std::numeric_limits<T>::infinity()) : e;
+      e = (x < C::min_exp) ? V{} : e;
+      return (x != x) ? x : e;
+    }
+  }
+
+  template <class V>
+  auto simd_fast_exp(V x) -> V
+  {
+    if constexpr (std::is_same_v<V, simd_element_t<V>>) {
+      return std::exp(x);
+    }
+    else {
+      using C = detail::simd_math_constants<simd_element_t<V>>;
+      return detail::simd_exp_kernel<C::fast_terms_exp>(detail::simd_exp_clamp(x));
+    }
+  }
+
+  namespace detail
+  {
+    /// Reduce positive `x` to `2^n m`, with m in [sqrt(1/2), sqrt(2)).
+    ///
+    /// The subnormals are rescaled into the normal range unless `Fast`.
+    template <bool Fast, class V>
+    auto simd_log_reduce(V x, V& n) -> V
+    {
+      using T = simd_element_t<V>;
+      using I = simd_int_t<V>;
+      using C = simd_math_constants<T>;
+
+      I subnormal{};
+      V y = x;
+      if constexpr (not Fast) {
+        subnormal = x < std::numeric_limits<T>::min();
+        y = subnormal ? x * C::subnormal_scale : x;
+      }
+
+      I bits = (I)y;
+      I e = ((bits >> C::mantissa) & (2 * C::bias + 1)) - (C::bias - 1);
+      if constexpr (not Fast) {
+        e = subnormal ? e - C::subnormal_exponent : e;
+      }
+      V m = (V)((bits & (((I{} + 1) << C::mantissa) - 1)) | (I{} + (C::bias - 1)) << C::mantissa);
+      I small = m < T(0.707106781186547524401);
+      e = e + small;                            // (true is -1)
+      n = simd_convert<V>(e);
+      return small ? m + m : m;
+    }
+
+    /// The tail `2 sum(s^(2(i - First)) / (2i + 1))` of the series for
+    /// `2 atanh(s)`, for i in [First, Terms).
+    template <int Terms, int First, class V>
+    auto simd_atanh_series(V s) -> V
+    {
+      using T = simd_element_t<V>;
+      constexpr auto c = [] {
+        std::array<T, Terms - First> c;
+        for (int i = First; i < Terms; ++i) {
+          c[i - First] = T(2) / T(2 * i + 1);
+        }
+        return c;
+      }();
+      return simd_polynomial(s * s, c);
+    }
+
+    /// The logarithm of positive finite `x`, with `Terms` terms of the series.
+    template <int Terms, bool Fast, class V>
+    auto simd_log_kernel(V x) -> V
+    {
+      using T = simd_element_t<V>;
+      V n;
+      V f = simd_log_reduce<Fast>(x, n) - T(1);
+      V s = f / (f + T(2));
+      return n * ln2_hi<T> + (s * simd_atanh_series<Terms, 0>(s) + n * ln2_lo<T>);
+    }
+
+    /// The logarithm of positive finite `x` in twice the working precision,
+    /// as the unevaluated sum `hi + lo`.
+    ///
+    /// The quotient `s`, the leading terms `2 s + 2 s^3 / 3` of the series,
+    /// and `n ln(2)` are carried as pairs, which keeps the relative error near
+    /// 2^-62 in double precision.
+    template <class V>
+    void simd_log_dd(V x, V& hi, V& lo)
+    {
+      using T = simd_element_t<V>;
+      using C = simd_math_constants<T>;
+
+      constexpr T third_hi = T(2) / T(3);
+      constexpr T third_lo = T((long double)2 / 3 - third_hi);
+
+      V n;
+      V f = simd_log_reduce<false>(x, n) - T(1);
+
+      // s + sl = f / (f + 2)
+      V ul;
+      V u = simd_two_sum(f, simd_broadcast<V>(T(2)), ul);
+      V s = f / u;
+      V pe;
+      V p = simd_two_product(s, u, pe);
+      V sl = ((f - p) - pe - s * ul) / u;
+
+      // the series, 2 s + 2 s^3 / 3 + s^5 q
+      V s2e, s3e, be;
+      V s2 = simd_two_product(s, s, s2e);
+      V s3 = simd_two_product(s2, s, s3e);
+      V s3l = s3e + (s2e + T(2) * s * sl) * s + s2 * sl;
+      V b = simd_two_product(s3, simd_broadcast<V>(third_hi), be);
+      V bl = be + s3 * third_lo + s3l * third_hi;
+      V q = s3 * s2 * simd_atanh_series<C::terms_log_dd, 2>(s);
+
+      V e1, e2, e3, ne;
+      V l = simd_two_sum(T(2) * s, b, e1);
+      V h = simd_two_sum(n * ln2_hi<T>, l, e2);
+      h = simd_two_sum(h, simd_two_product(n, simd_broadcast<V>(ln2_lo<T>), ne), e3);
+      V r = ((e1 + e2) + (e3 + ne)) + (bl + q + T(2) * sl);
+
+      hi = h + r;
+      lo = r - (hi - h);
+    }
+  }
+
+  template <class V>
+  auto simd_log(V x) -> V
+  {
+    if constexpr (std::is_same_v<V, simd_element_t<V>>) {
+      return std::log(x);
+    }
+    else {
+      using T = simd_element_t<V>;
+      using C = detail::simd_math_constants<T>;
+      constexpr T inf = std::numeric_limits<T>::infinity();
+
+      V l = detail::simd_log_kernel<C::terms_log, false>(x);
+      l = (x == T(0)) ? simd_broadcast<V>(-inf) : l;
+      l = (x < T(0)) ? simd_broadcast<V>(std::numeric_limits<T>::quiet_NaN()) : l;
+      l = (x == inf) ? x : l;
+      return (x != x) ? x : l;
+    }
+  }
+
+  template <class V>
+  auto simd_fast_log(V x) -> V
+  {
+    if constexpr (std::is_same_v<V, simd_element_t<V>>) {
+      return std::log(x);
+    }
+    else {
+      using C = detail::simd_math_constants<simd_element_t<V>>;
+      return detail::simd_log_kernel<C::fast_terms_log, true>(x);
+    }
+  }
+
+  namespace detail
+  {
+    /// Evaluate a single precision power in double precision, a half of the
+    /// vector at a time so that the vectors keep their width.
+    template <class V>
+    auto simd_pow_promote(V a, V b, auto&& pow) -> V
+    {
+      using D = simd_t<double, sizeof(V)>;
+      constexpr int H = sizeof(D) / sizeof(double);
+      D a0, a1, b0, b1;
+      for (int i = 0; i < H; ++i) {
+        a0[i] = a[i], a1[i] = a[i + H];
+        b0[i] = b[i], b1[i] = b[i + H];
+      }
+      D p0 = pow(a0, b0), p1 = pow(a1, b1);
+      V p;
+      for (int i = 0; i < H; ++i) {
+        p[i] = p0[i], p[i + H] = p1[i];
+      }
+      return p;
+    }
+
+    /// Replace the lanes of `p` whose operands are not positive and finite
+    /// with `std::pow`, which handles the signs and special cases.
+    template <class V>
+    auto simd_pow_special(V a, V b, V p) -> V
+    {
+      using T = simd_element_t<V>;
+      constexpr T inf = std::numeric_limits<T>::infinity();
+      auto special = not ((a > T(0)) & (a < inf) & (b > T(-0x1p960)) & (b < T(0x1p960)));
+      for (int i = 0; i < int(sizeof(V) / sizeof(T)); ++i) {
+        if (special[i]) {
+          p[i] = std::pow(a[i], b[i]);
+        }
+      }
+      return p;
+    }
+  }
+
+  /// The power function, as `exp(b log(a))` for positive `a`.
+  ///
+  /// In double precision `b log(a)` is carried in twice the working precision,
+  /// and its low part corrects the exponential. Single precision is computed
+  /// in double precision, where the ordinary logarithm is accurate enough.
+  template <class V>
+  auto simd_pow(V a, V b) -> V
+  {
+    using T = simd_element_t<V>;
+
+    if constexpr (std::is_same_v<V, T>) {
+      return std::pow(a, b);
+    }
+    else if constexpr (std::is_same_v<T, float>) {
+      return detail::simd_pow_promote(a, b, [](auto a, auto b) {
+        using C = detail::simd_math_constants<double>;
+        auto p = simd_exp(b * detail::simd_log_kernel<C::terms_log, false>(a));
+        return detail::simd_pow_special(a, b, p);
+      });
+    }
+    else {
+      V h, l, e;
+      detail::simd_log_dd(a, h, l);
+      V y = detail::simd_two_product(b, h, e);
+      V z = e + b * l;
+      V w = y + z;
+      z = z - (w - y);
+
+      return detail::simd_pow_special(a, b, simd_exp(w) * (T(1) + z));
+    }
+  }
+
+  template <class V>
+  auto simd_fast_pow(V a, V b) -> V
+  {
+    using T = simd_element_t<V>;
+
+    if constexpr (std::is_same_v<V, T>) {
+      return std::pow(a, b);
+    }
+    else if constexpr (std::is_same_v<T, float>) {
+      return detail::simd_pow_promote(a, b, [](auto a, auto b) { return simd_fast_pow(a, b); });
+    }
+    else {
+      return simd_fast_exp(b * simd_fast_log(a));
+    }
+  }
+
+  template <class V>
+  auto simd_sqrt(V x) -> V
+  {
+    return simd_map(x, [](auto x) { return __builtin_sqrt(x); });
+  }
+
+  template <class V>
+  auto simd_abs(V x) -> V
+  {
+    return simd_map(x, [](auto x) { return __builtin_fabs(x); });
+  }
+
+  template <class V>
+  auto simd_ceil(V x) -> V
+  {
+    return simd_map(x, [](auto x) { return __builtin_ceil(x); });
+  }
+
+  template <class V>
+  auto simd_floor(V x) -> V
+  {
+    return simd_map(x, [](auto x) { return __builtin_floor(x); });
+  }
+
+  /// `fmin` and `fmax`, returning the other operand when one is a nan.
+  /// @{
+  template <class V>
+  auto simd_fmin(V a, V b) -> V
+  {
+    V m = (b < a) ? b : a;
+    return (a != a) ? b : m;
+  }
+
+  template <class V>
+  auto simd_fmax(V a, V b) -> V
+  {
+    V m = (b > a) ? b : a;
+    return (a != a) ? b : m;
+  }
+  /// @}
+}
+
+#endif // ALBERT_INCLUDE_SIMD_MATH_HPP
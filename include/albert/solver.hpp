@@ -37,8 +37,12 @@
 #ifndef ALBERT_INCLUDE_ALBERT_LINEAR_ALGEBRA_HPP
 #define ALBERT_INCLUDE_ALBERT_LINEAR_ALGEBRA_HPP
 
-#include <cmath>                                // std::abs
+#include "albert/simd.hpp"
+#include <cmath>                                // std::abs, std::sqrt, std::exp, std::log, ...
+#include <limits>                               // std::numeric_limits
 #include <numeric>                              // std::iota
+#include <type_traits>                          // std::remove_cvref_t
+#include <utility>                              // std::swap
 
 namespace albert::solver
 {
@@ -107,7 +111,7 @@ namespace albert::solver
     // in the loop to avoid an early loop exit and possible GPU divergence.
     int e = 0;
     for (int i = 0; i < M; ++i) {
-      e = (not e and A(i, i) == 0) ? i : e;
+      e = (not e and A(i, i) == 0) ? i + 1 : e;
     }
     return e;
   }
@@ -159,15 +163,173 @@ namespace albert::solver
     return 0;
   }
 
+  /// Compute the determinant of a small matrix.
+  ///
+  /// Matrices up to 4x4 use the closed-form cofactor expansion, which reads
+  /// `A` and has no branches. Larger matrices are copied and factored with
+  /// `lu_kij_pp`, and the determinant is the signed product of the pivots.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in]        A The order 2 tensor (or `A(i,j)` callable) to read.
+  ///
+  /// @returns            The determinant.
   template <int M>
-  constexpr auto inverse(auto&& A, auto&& inv) -> int
+  constexpr auto determinant(auto&& A)
   {
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+
+    if constexpr (M == 1) {
+      return T(A(0,0));
+    }
+    else if constexpr (M == 2) {
+      return T(A(0,0) * A(1,1) - A(0,1) * A(1,0));
+    }
+    else if constexpr (M == 3) {
+      return T(A(0,0) * (A(1,1) * A(2,2) - A(1,2) * A(2,1)) -
+               A(0,1) * (A(1,0) * A(2,2) - A(1,2) * A(2,0)) +
+               A(0,2) * (A(1,0) * A(2,1) - A(1,1) * A(2,0)));
+    }
+    else if constexpr (M == 4) {
+      // Laplace expansion over the 2x2 minors of the top and bottom rows.
+      T s0 = A(0,0) * A(1,1) - A(1,0) * A(0,1);
+      T s1 = A(0,0) * A(1,2) - A(1,0) * A(0,2);
+      T s2 = A(0,0) * A(1,3) - A(1,0) * A(0,3);
+      T s3 = A(0,1) * A(1,2) - A(1,1) * A(0,2);
+      T s4 = A(0,1) * A(1,3) - A(1,1) * A(0,3);
+      T s5 = A(0,2) * A(1,3) - A(1,2) * A(0,3);
+      T c5 = A(2,2) * A(3,3) - A(3,2) * A(2,3);
+      T c4 = A(2,1) * A(3,3) - A(3,1) * A(2,3);
+      T c3 = A(2,1) * A(3,2) - A(3,1) * A(2,2);
+      T c2 = A(2,0) * A(3,3) - A(3,0) * A(2,3);
+      T c1 = A(2,0) * A(3,2) - A(3,0) * A(2,2);
+      T c0 = A(2,0) * A(3,1) - A(3,0) * A(2,1);
+      return T(s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+    }
+    else {
+      T LU[M][M];
+      for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < M; ++j) {
+          LU[i][j] = A(i,j);
+        }
+      }
+
+      int data[M];
+      std::iota(std::begin(data), std::end(data), 0);
+      auto lu = [&](int i, int j) -> T& { return LU[i][j]; };
+      auto perm = [&](int i) -> int& { return data[i]; };
+      if (lu_kij_pp<M>(lu, perm)) {
+        return T(0);
+      }
+
+      // Each row swap flips the sign, a cycle of length n in the permutation
+      // is n - 1 swaps.
+      T det = T(1);
+      bool visited[M] = {};
+      for (int i = 0; i < M; ++i) {
+        det *= LU[i][i];
+        for (int j = data[i]; not visited[i] and j != i; j = data[j]) {
+          visited[j] = true;
+          det = -det;
+        }
+        visited[i] = true;
+      }
+      return det;
+    }
+  }
+
+  /// Compute the adjugate (the transposed cofactor matrix) of a small matrix.
+  ///
+  /// The adjugate satisfies `A * adj(A) = det(A) * I`. It is only provided in
+  /// closed form, for matrices up to 4x4.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in]        A The order 2 tensor (or `A(i,j)` callable) to read.
+  /// @param[out]     adj The order 2 tensor to write, must not alias `A`.
+  template <int M>
+  constexpr void adjugate(auto&& A, auto&& adj)
+  {
+    static_assert(0 < M and M <= 4, "adjugate is only available for 1x1 to 4x4 matrices");
+
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+
+    if constexpr (M == 1) {
+      adj(0,0) = T(1);
+    }
+    else if constexpr (M == 2) {
+      adj(0,0) =  A(1,1);
+      adj(0,1) = -A(0,1);
+      adj(1,0) = -A(1,0);
+      adj(1,1) =  A(0,0);
+    }
+    else if constexpr (M == 3) {
+      adj(0,0) = A(1,1) * A(2,2) - A(1,2) * A(2,1);
+      adj(0,1) = A(0,2) * A(2,1) - A(0,1) * A(2,2);
+      adj(0,2) = A(0,1) * A(1,2) - A(0,2) * A(1,1);
+      adj(1,0) = A(1,2) * A(2,0) - A(1,0) * A(2,2);
+      adj(1,1) = A(0,0) * A(2,2) - A(0,2) * A(2,0);
+      adj(1,2) = A(0,2) * A(1,0) - A(0,0) * A(1,2);
+      adj(2,0) = A(1,0) * A(2,1) - A(1,1) * A(2,0);
+      adj(2,1) = A(0,1) * A(2,0) - A(0,0) * A(2,1);
+      adj(2,2) = A(0,0) * A(1,1) - A(0,1) * A(1,0);
+    }
+    else {
+      T s0 = A(0,0) * A(1,1) - A(1,0) * A(0,1);
+      T s1 = A(0,0) * A(1,2) - A(1,0) * A(0,2);
+      T s2 = A(0,0) * A(1,3) - A(1,0) * A(0,3);
+      T s3 = A(0,1) * A(1,2) - A(1,1) * A(0,2);
+      T s4 = A(0,1) * A(1,3) - A(1,1) * A(0,3);
+      T s5 = A(0,2) * A(1,3) - A(1,2) * A(0,3);
+      T c5 = A(2,2) * A(3,3) - A(3,2) * A(2,3);
+      T c4 = A(2,1) * A(3,3) - A(3,1) * A(2,3);
+      T c3 = A(2,1) * A(3,2) - A(3,1) * A(2,2);
+      T c2 = A(2,0) * A(3,3) - A(3,0) * A(2,3);
+      T c1 = A(2,0) * A(3,2) - A(3,0) * A(2,2);
+      T c0 = A(2,0) * A(3,1) - A(3,0) * A(2,1);
+
+      adj(0,0) =  A(1,1) * c5 - A(1,2) * c4 + A(1,3) * c3;
+      adj(0,1) = -A(0,1) * c5 + A(0,2) * c4 - A(0,3) * c3;
+      adj(0,2) =  A(3,1) * s5 - A(3,2) * s4 + A(3,3) * s3;
+      adj(0,3) = -A(2,1) * s5 + A(2,2) * s4 - A(2,3) * s3;
+      adj(1,0) = -A(1,0) * c5 + A(1,2) * c2 - A(1,3) * c1;
+      adj(1,1) =  A(0,0) * c5 - A(0,2) * c2 + A(0,3) * c1;
+      adj(1,2) = -A(3,0) * s5 + A(3,2) * s2 - A(3,3) * s1;
+      adj(1,3) =  A(2,0) * s5 - A(2,2) * s2 + A(2,3) * s1;
+      adj(2,0) =  A(1,0) * c4 - A(1,1) * c2 + A(1,3) * c0;
+      adj(2,1) = -A(0,0) * c4 + A(0,1) * c2 - A(0,3) * c0;
+      adj(2,2) =  A(3,0) * s4 - A(3,1) * s2 + A(3,3) * s0;
+      adj(2,3) = -A(2,0) * s4 + A(2,1) * s2 - A(2,3) * s0;
+      adj(3,0) = -A(1,0) * c3 + A(1,1) * c1 - A(1,2) * c0;
+      adj(3,1) =  A(0,0) * c3 - A(0,1) * c1 + A(0,2) * c0;
+      adj(3,2) = -A(3,0) * s3 + A(3,1) * s1 - A(3,2) * s0;
+      adj(3,3) =  A(2,0) * s3 - A(2,1) * s1 + A(2,2) * s0;
+    }
+  }
+
+  /// Invert a matrix with pivoted LU.
+  ///
+  /// The matrix is factored in place with `lu_kij_pp` and the inverse is
+  /// solved column by column.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in/out]    A The matrix, will be factored and permuted into LUP.
+  /// @param[out]     inv The inverse, must not alias `A`.
+  ///
+  /// @returns          0 On success.
+  ///            non-zero The matrix is singular, as for `solve`.
+  template <int M>
+  constexpr auto lu_inverse(auto&& A, auto&& inv) -> int
+  {
+    using T = std::remove_reference_t<decltype(inv(0,0))>;
+
     // 1. Allocate a permutation.
     int data[M];
     std::iota(std::begin(data), std::end(data), 0);
 
     // 2. Perform LU factorization on the matrix, and test for failure.
-    int i = lu_kij_pp<M>(A, [&](int i)
+    int i = lu_kij_pp<M>(A, [&](int i) -> int&
     {
       return data[i];
     });
@@ -177,7 +339,11 @@ namespace albert::solver
     }
 
     // 3. Permute the Identity matrix.
-    using T = std::remove_reference_t<decltype(inv(0,0))>;
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < M; ++j) {
+        inv(i, j) = T{0};
+      }
+    }
     for (auto i = 0; i < M; ++i) {
       inv(i, data[i]) = T{1};
     }
@@ -203,6 +369,950 @@ namespace albert::solver
 
     return 0;
   }
+
+  /// Invert a matrix.
+  ///
+  /// Matrices up to 4x4 are inverted in closed form, as the adjugate scaled
+  /// by the reciprocal of the determinant. This reads `A` and doesn't branch,
+  /// a singular matrix produces non-finite values in `inv`. Larger matrices
+  /// use `lu_inverse`.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in/out]    A The matrix, factored in place when `M > 4`.
+  /// @param[out]     inv The inverse, must not alias `A`.
+  ///
+  /// @returns          0 On success.
+  ///            non-zero The matrix is singular.
+  template <int M>
+  constexpr auto inverse(auto&& A, auto&& inv) -> int
+  {
+    using T = std::remove_reference_t<decltype(inv(0,0))>;
+
+    if constexpr (M <= 4) {
+      T det = determinant<M>(A);
+      adjugate<M>(A, inv);
+      T r = T(1) / det;
+      for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < M; ++j) {
+          inv(i, j) *= r;
+        }
+      }
+      return det == T(0);
+    }
+    else {
+      return lu_inverse<M>(A, inv);
+    }
+  }
+
+  /// Select the Cholesky or LDLT factorization in `solve`.
+  struct cholesky_tag_t {};
+  struct ldlt_tag_t {};
+
+  constexpr inline cholesky_tag_t cholesky_tag = {};
+  constexpr inline ldlt_tag_t ldlt_tag = {};
+
+  /// Factor a symmetric positive-definite matrix, `A = L * L^T`.
+  ///
+  /// The factorization only reads and writes the lower triangle of `A`, so
+  /// it works in place on symmetric (packed) storage, and does about half of
+  /// the work of `lu_kij_pp`. No pivoting is needed.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in/out]    A The matrix, the lower triangle will be overwritten
+  ///                     with `L`.
+  ///
+  /// @returns          0 If the operation succeeded.
+  ///            positive The 1-based row of the first pivot that wasn't
+  ///                     positive, i.e., the matrix isn't positive-definite.
+  template <int M>
+  constexpr auto cholesky(auto&& A) -> int
+  {
+    // get sqrt via adl
+    using std::sqrt;
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+
+    for (int j = 0; j < M; ++j) {
+      T d = A(j, j);
+      for (int k = 0; k < j; ++k) {
+        d -= A(j, k) * A(j, k);
+      }
+
+      // Stop rather than take the square root of a negative, which isn't a
+      // constant expression.
+      if (not (d > T(0))) {
+        return j + 1;
+      }
+
+      d = sqrt(d);
+      A(j, j) = d;
+
+      T r = T(1) / d;
+      for (int i = j + 1; i < M; ++i) {
+        T z = A(i, j);
+        for (int k = 0; k < j; ++k) {
+          z -= A(i, k) * A(j, k);
+        }
+        A(i, j) = z * r;
+      }
+    }
+    return 0;
+  }
+
+  /// Factor a symmetric matrix, `A = L * D * L^T`.
+  ///
+  /// `L` is unit lower triangular and `D` is diagonal. Unlike `cholesky` this
+  /// doesn't need square roots, and it handles symmetric indefinite matrices
+  /// as long as no pivot is zero. Only the lower triangle is read and written.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in/out]    A The matrix, the strictly lower triangle will be
+  ///                     overwritten with `L` and the diagonal with `D`.
+  ///
+  /// @returns          0 If the operation succeeded.
+  ///            positive The 1-based row of the first zero pivot.
+  template <int M>
+  constexpr auto ldlt(auto&& A) -> int
+  {
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+
+    T w[M] = {};
+    for (int j = 0; j < M; ++j) {
+      // w(k) = L(j,k) * D(k)
+      T d = A(j, j);
+      for (int k = 0; k < j; ++k) {
+        w[k] = A(j, k) * A(k, k);
+        d -= A(j, k) * w[k];
+      }
+
+      if (d == T(0)) {
+        return j + 1;
+      }
+
+      A(j, j) = d;
+
+      T r = T(1) / d;
+      for (int i = j + 1; i < M; ++i) {
+        T z = A(i, j);
+        for (int k = 0; k < j; ++k) {
+          z -= A(i, k) * w[k];
+        }
+        A(i, j) = z * r;
+      }
+    }
+    return 0;
+  }
+
+  /// Solve a symmetric positive-definite system with `cholesky`.
+  ///
+  /// @tparam           M The size of the matrix and vector.
+  ///
+  /// @param[in/out]    A The matrix, will be factored.
+  /// @param[in/out]    b The vector, will be written with the solution.
+  ///
+  /// @returns            The result of the factorization, `A` and `b` are
+  ///                     invalid if it is non-zero.
+  template <int M>
+  constexpr auto solve(auto&& A, auto&& b, cholesky_tag_t) -> int
+  {
+    if (int i = cholesky<M>(A)) {
+      return i;
+    }
+
+    // 1. Lower triangular solve, L * y = b.
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < i; ++j) {
+        b(i) -= A(i, j) * b(j);
+      }
+      b(i) /= A(i, i);
+    }
+
+    // 2. Upper triangular solve, L^T * x = y.
+    for (int i = M - 1; i >= 0; --i) {
+      for (int j = i + 1; j < M; ++j) {
+        b(i) -= A(j, i) * b(j);
+      }
+      b(i) /= A(i, i);
+    }
+
+    return 0;
+  }
+
+  /// Solve a symmetric system with `ldlt`.
+  ///
+  /// @tparam           M The size of the matrix and vector.
+  ///
+  /// @param[in/out]    A The matrix, will be factored.
+  /// @param[in/out]    b The vector, will be written with the solution.
+  ///
+  /// @returns            The result of the factorization, `A` and `b` are
+  ///                     invalid if it is non-zero.
+  template <int M>
+  constexpr auto solve(auto&& A, auto&& b, ldlt_tag_t) -> int
+  {
+    if (int i = ldlt<M>(A)) {
+      return i;
+    }
+
+    // 1. Unit lower triangular solve, L * z = b.
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < i; ++j) {
+        b(i) -= A(i, j) * b(j);
+      }
+    }
+
+    // 2. Diagonal solve, D * y = z.
+    for (int i = 0; i < M; ++i) {
+      b(i) /= A(i, i);
+    }
+
+    // 3. Unit upper triangular solve, L^T * x = y.
+    for (int i = M - 1; i >= 0; --i) {
+      for (int j = i + 1; j < M; ++j) {
+        b(i) -= A(j, i) * b(j);
+      }
+    }
+
+    return 0;
+  }
+
+  /// Compute the eigenvalues and eigenvectors of a symmetric matrix with the
+  /// cyclic Jacobi method.
+  ///
+  /// Sweeps of plane rotations zero each off-diagonal element in turn until
+  /// the off-diagonal part is negligible relative to the whole matrix. This is
+  /// slower than the closed form used by `eigh<3>`, but accurate for any
+  /// spectrum, including repeated eigenvalues.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in]        A The symmetric matrix (or `A(i,j)` callable) to read.
+  /// @param[out]       w The eigenvalues, in ascending order.
+  /// @param[out]       V The orthonormal eigenvectors, as columns `V(i,k)`.
+  ///
+  /// @returns          0 If the iteration converged.
+  ///            non-zero It didn't converge within the maximum number of
+  ///                     sweeps, the results are still the best estimate.
+  template <int M>
+  constexpr auto jacobi_eigh(auto&& A, auto&& w, auto&& V) -> int
+  {
+    // get abs and sqrt via adl
+    using std::abs;
+    using std::sqrt;
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+
+    constexpr int max_sweeps = 32;
+    constexpr T eps = std::numeric_limits<T>::epsilon();
+
+    T a[M][M], v[M][M];
+    T norm = 0;
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < M; ++j) {
+        a[i][j] = A(i, j);
+        v[i][j] = T(i == j);
+        norm += a[i][j] * a[i][j];
+      }
+    }
+
+    int sweep = 0;
+    for (; sweep < max_sweeps; ++sweep) {
+      T off = 0;
+      for (int p = 0; p < M; ++p) {
+        for (int q = p + 1; q < M; ++q) {
+          off += a[p][q] * a[p][q];
+        }
+      }
+      if (off <= eps * eps * norm) {
+        break;
+      }
+
+      for (int p = 0; p < M; ++p) {
+        for (int q = p + 1; q < M; ++q) {
+          if (a[p][q] == T(0)) {
+            continue;
+          }
+
+          // The rotation angle that zeros a(p,q), using the smaller root for
+          // stability.
+          T theta = (a[q][q] - a[p][p]) / (T(2) * a[p][q]);
+          T t = T(1) / (abs(theta) + sqrt(theta * theta + T(1)));
+          t = (theta < T(0)) ? -t : t;
+          T c = T(1) / sqrt(t * t + T(1));
+          T s = t * c;
+
+          for (int k = 0; k < M; ++k) {
+            T kp = a[k][p], kq = a[k][q];
+            a[k][p] = c * kp - s * kq;
+            a[k][q] = s * kp + c * kq;
+          }
+          for (int k = 0; k < M; ++k) {
+            T pk = a[p][k], qk = a[q][k];
+            a[p][k] = c * pk - s * qk;
+            a[q][k] = s * pk + c * qk;
+          }
+          for (int k = 0; k < M; ++k) {
+            T kp = v[k][p], kq = v[k][q];
+            v[k][p] = c * kp - s * kq;
+            v[k][q] = s * kp + c * kq;
+          }
+        }
+      }
+    }
+
+    // Sort the eigenpairs in ascending order.
+    for (int i = 0; i < M; ++i) {
+      int min = i;
+      for (int j = i + 1; j < M; ++j) {
+        min = (a[j][j] < a[min][min]) ? j : min;
+      }
+      if (min != i) {
+        std::swap(a[i][i], a[min][min]);
+        for (int k = 0; k < M; ++k) {
+          std::swap(v[k][i], v[k][min]);
+        }
+      }
+    }
+
+    for (int i = 0; i < M; ++i) {
+      w(i) = a[i][i];
+      for (int j = 0; j < M; ++j) {
+        V(i, j) = v[i][j];
+      }
+    }
+
+    return sweep == max_sweeps;
+  }
+
+  namespace detail
+  {
+    /// A unit vector in the null space of the symmetric `A - λ I`, when λ is
+    /// a simple eigenvalue of `A`.
+    ///
+    /// Any two rows of `A - λ I` span the space orthogonal to the eigenvector,
+    /// so their cross product is parallel to it. The largest of the three
+    /// cross products is the best conditioned.
+    template <class T>
+    constexpr void null_vector(T const (&a)[3][3], T const& lambda, T (&v)[3])
+    {
+      using std::sqrt;
+
+      T r[3][3];
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          r[i][j] = (i == j) ? a[i][j] - lambda : a[i][j];
+        }
+      }
+
+      auto cross = [&](int m, int n, T (&c)[3]) {
+        c[0] = r[m][1] * r[n][2] - r[m][2] * r[n][1];
+        c[1] = r[m][2] * r[n][0] - r[m][0] * r[n][2];
+        c[2] = r[m][0] * r[n][1] - r[m][1] * r[n][0];
+        return c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+      };
+
+      T c01[3], c02[3], c12[3];
+      T n01 = cross(0, 1, c01);
+      T n02 = cross(0, 2, c02);
+      T n12 = cross(1, 2, c12);
+
+      T n = n01;
+      for (int i = 0; i < 3; ++i) {
+        v[i] = c01[i];
+      }
+      auto use02 = n02 > n;
+      n = use02 ? n02 : n;
+      for (int i = 0; i < 3; ++i) {
+        v[i] = use02 ? c02[i] : v[i];
+      }
+      auto use12 = n12 > n;
+      n = use12 ? n12 : n;
+      for (int i = 0; i < 3; ++i) {
+        v[i] = use12 ? c12[i] : v[i];
+      }
+
+      T r_n = simd_element_t<T>(1) / simd_map(n, [](auto x) { return sqrt(x); });
+      for (int i = 0; i < 3; ++i) {
+        v[i] *= r_n;
+      }
+    }
+
+    /// The closed-form eigen-decomposition of a symmetric 3x3 matrix.
+    ///
+    /// The eigenvalues are the roots of the characteristic cubic, computed
+    /// with the trigonometric method, and the eigenvectors of the smallest and
+    /// largest eigenvalues come from `null_vector`. The middle eigenvector is
+    /// their cross product, which keeps the basis orthonormal and
+    /// right-handed.
+    ///
+    /// The eigenvectors lose accuracy as eigenvalues approach each other. This
+    /// doesn't branch, so it works lane-wise for vectors of matrices, and
+    /// returns (a mask of) the cases whose relative eigenvalue gap is too small
+    /// for the result to be trusted.
+    template <class T>
+    constexpr auto eigh3(T const (&a)[3][3], T (&w)[3], T (&v)[3][3])
+    {
+      using std::acos;
+      using std::cbrt;
+      using std::cos;
+      using std::sqrt;
+      using S = simd_element_t<T>;
+
+      constexpr S pi = S(3.14159265358979323846);
+      // The eigenvector error grows like eps / gap, so a relative gap of
+      // eps^(1/3) keeps it below eps^(2/3).
+      S const tol = cbrt(std::numeric_limits<S>::epsilon());
+
+      T q = (a[0][0] + a[1][1] + a[2][2]) / S(3);
+      T p1 = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+      T b00 = a[0][0] - q, b11 = a[1][1] - q, b22 = a[2][2] - q;
+      T p2 = b00 * b00 + b11 * b11 + b22 * b22 + S(2) * p1;
+      T p = simd_map(p2 / S(6), [](auto x) { return sqrt(x); });
+
+      // r = det((A - q I) / p) / 2, clamped against roundoff, and guarded
+      // for multiples of the identity (which take the fallback).
+      T ps = (p > S(0)) ? p : T{} + S(1);
+      T det = (b00 * (b11 * b22 - a[1][2] * a[1][2]) -
+               a[0][1] * (a[0][1] * b22 - a[1][2] * a[0][2]) +
+               a[0][2] * (a[0][1] * a[1][2] - b11 * a[0][2]));
+      T r = det / (S(2) * ps * ps * ps);
+      r = (r < S(-1)) ? T{} + S(-1) : r;
+      r = (r > S(1)) ? T{} + S(1) : r;
+
+      T phi = simd_map(r, [](auto x) { return acos(x); }) / S(3);
+      T c0 = simd_map(phi, [](auto x) { return cos(x); });
+      T c2 = simd_map(phi, [&](auto x) { return cos(x + S(2) * pi / S(3)); });
+      w[2] = q + S(2) * p * c0;
+      w[0] = q + S(2) * p * c2;
+      w[1] = S(3) * q - w[0] - w[2];
+
+      T v0[3], v2[3];
+      null_vector(a, w[0], v0);
+      null_vector(a, w[2], v2);
+      for (int i = 0; i < 3; ++i) {
+        v[i][0] = v0[i];
+        v[i][2] = v2[i];
+      }
+      v[0][1] = v2[1] * v0[2] - v2[2] * v0[1];
+      v[1][1] = v2[2] * v0[0] - v2[0] * v0[2];
+      v[2][1] = v2[0] * v0[1] - v2[1] * v0[0];
+
+      // The gap is measured against the size of the matrix, not just the
+      // spread of its spectrum, so that a multiple of the identity plus
+      // roundoff (where both p and the gap are noise) takes the fallback.
+      T aq = (q < S(0)) ? -q : q;
+      T scale = (aq < p) ? p : aq;
+      T gap = w[1] - w[0];
+      gap = (w[2] - w[1] < gap) ? w[2] - w[1] : gap;
+      return (gap <= tol * scale) | (p <= tol * aq) | (p <= S(0));
+    }
+  }
+
+  /// Compute the eigenvalues and eigenvectors of a symmetric matrix.
+  ///
+  /// 3x3 matrices use the closed-form trigonometric method, and fall back to
+  /// `jacobi_eigh` when two eigenvalues are too close for the closed-form
+  /// eigenvectors to be accurate. Other sizes use `jacobi_eigh`.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in]        A The symmetric matrix (or `A(i,j)` callable) to read.
+  /// @param[out]       w The eigenvalues, in ascending order.
+  /// @param[out]       V The orthonormal eigenvectors, as columns `V(i,k)`.
+  ///
+  /// @returns            As for `jacobi_eigh`.
+  template <int M>
+  constexpr auto eigh(auto&& A, auto&& w, auto&& V) -> int
+  {
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+
+    if constexpr (M == 3) {
+      T a[3][3], e[3], v[3][3];
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          a[i][j] = A(i, j);
+        }
+      }
+
+      if (detail::eigh3(a, e, v)) {
+        return jacobi_eigh<3>(A, w, V);
+      }
+
+      for (int i = 0; i < 3; ++i) {
+        w(i) = e[i];
+        for (int j = 0; j < 3; ++j) {
+          V(i, j) = v[i][j];
+        }
+      }
+      return 0;
+    }
+    else {
+      return jacobi_eigh<M>(A, w, V);
+    }
+  }
+
+  namespace detail
+  {
+    /// A square matrix value used as a temporary by the matrix functions.
+    ///
+    /// It provides the `A(i,j)` accessor used by the rest of the solvers, and
+    /// just enough arithmetic for the iterations below.
+    template <class T, int M>
+    struct square
+    {
+      T a[M][M] = {};
+
+      constexpr static auto identity(T s = T(1)) -> square
+      {
+        square I;
+        for (int i = 0; i < M; ++i) {
+          I.a[i][i] = s;
+        }
+        return I;
+      }
+
+      constexpr static auto load(auto&& A) -> square
+      {
+        square B;
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            B.a[i][j] = A(i, j);
+          }
+        }
+        return B;
+      }
+
+      constexpr void store(auto&& A) const
+      {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            A(i, j) = a[i][j];
+          }
+        }
+      }
+
+      constexpr auto operator()(int i, int j) -> T&
+      {
+        return a[i][j];
+      }
+
+      constexpr auto operator()(int i, int j) const -> T const&
+      {
+        return a[i][j];
+      }
+
+      constexpr auto transpose() const -> square
+      {
+        square B;
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            B.a[i][j] = a[j][i];
+          }
+        }
+        return B;
+      }
+
+      constexpr auto inverse() const -> square
+      {
+        square A = *this, B;
+        solver::inverse<M>(A, B);
+        return B;
+      }
+
+      constexpr auto symmetric() const -> bool
+      {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < i; ++j) {
+            if (a[i][j] != a[j][i]) {
+              return false;
+            }
+          }
+        }
+        return true;
+      }
+
+      /// The maximum column sum norm.
+      constexpr auto norm1() const -> T
+      {
+        using std::abs;
+        T n = 0;
+        for (int j = 0; j < M; ++j) {
+          T s = 0;
+          for (int i = 0; i < M; ++i) {
+            s += abs(a[i][j]);
+          }
+          n = (s > n) ? s : n;
+        }
+        return n;
+      }
+
+      constexpr friend auto operator+(square A, square const& B) -> square
+      {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            A.a[i][j] += B.a[i][j];
+          }
+        }
+        return A;
+      }
+
+      constexpr friend auto operator-(square A, square const& B) -> square
+      {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            A.a[i][j] -= B.a[i][j];
+          }
+        }
+        return A;
+      }
+
+      constexpr friend auto operator*(T s, square A) -> square
+      {
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < M; ++j) {
+            A.a[i][j] *= s;
+          }
+        }
+        return A;
+      }
+
+      constexpr friend auto operator*(square const& A, square const& B) -> square
+      {
+        square C;
+        for (int i = 0; i < M; ++i) {
+          for (int k = 0; k < M; ++k) {
+            for (int j = 0; j < M; ++j) {
+              C.a[i][j] += A.a[i][k] * B.a[k][j];
+            }
+          }
+        }
+        return C;
+      }
+    };
+
+    /// Apply `f` to a symmetric 3x3 matrix through its eigen-decomposition,
+    /// `V f(w) V^T`.
+    template <class T>
+    constexpr auto spectral(square<T, 3> const& A, auto&& f) -> square<T, 3>
+    {
+      square<T, 3> V, B;
+      T w[3];
+      eigh<3>(A, [&](int i) -> T& { return w[i]; }, V);
+      for (int k = 0; k < 3; ++k) {
+        w[k] = f(w[k]);
+      }
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          for (int k = 0; k < 3; ++k) {
+            B(i, j) += V(i, k) * w[k] * V(j, k);
+          }
+        }
+      }
+      return B;
+    }
+
+    /// The trace-free part `B = A - t I` of a 2x2 matrix, with `t = tr(A)/2`
+    /// and `q` such that `B^2 = q I`.
+    ///
+    /// By Cayley-Hamilton every analytic function of a 2x2 matrix is
+    /// `f(A) = α I + β B`, with α and β from the eigenvalues `t ± sqrt(q)`.
+    template <class T>
+    struct traceless
+    {
+      T t, q;
+      square<T, 2> B;
+
+      constexpr traceless(square<T, 2> const& A)
+          : t((A(0,0) + A(1,1)) / T(2))
+          , q((A(0,0) - A(1,1)) * (A(0,0) - A(1,1)) / T(4) + A(0,1) * A(1,0))
+          , B(A - square<T, 2>::identity(t))
+      {
+      }
+
+      constexpr auto apply(T alpha, T beta) const -> square<T, 2>
+      {
+        return square<T, 2>::identity(alpha) + beta * B;
+      }
+    };
+  }
+
+  /// Compute the matrix exponential.
+  ///
+  /// 2x2 matrices use the closed form from Cayley-Hamilton, and symmetric 3x3
+  /// matrices use their eigen-decomposition. Everything else uses the [6/6]
+  /// Padé approximant with scaling and squaring, where `A` is scaled by `2^-s`
+  /// until its 1-norm is at most 1/2, which bounds the truncation error below
+  /// double precision roundoff.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in]        A The matrix (or `A(i,j)` callable) to read.
+  /// @param[out]       E The exponential.
+  ///
+  /// @returns          0 (the exponential always exists).
+  template <int M>
+  constexpr auto expm(auto&& A, auto&& E) -> int
+  {
+    using std::cos;
+    using std::cosh;
+    using std::exp;
+    using std::sin;
+    using std::sinh;
+    using std::sqrt;
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+    using S = detail::square<T, M>;
+
+    S a = S::load(A);
+
+    if constexpr (M == 2) {
+      detail::traceless f(a);
+      T s = sqrt((f.q < T(0)) ? -f.q : f.q);
+      T c = (f.q < T(0)) ? cos(s) : cosh(s);
+      T h = (s == T(0)) ? T(1) : ((f.q < T(0)) ? sin(s) : sinh(s)) / s;
+      T e = exp(f.t);
+      f.apply(e * c, e * h).store(E);
+      return 0;
+    }
+    else if constexpr (M == 3) {
+      if (a.symmetric()) {
+        detail::spectral(a, [](T x) { return exp(x); }).store(E);
+        return 0;
+      }
+    }
+
+    int s = 0;
+    for (T n = a.norm1(); n > T(0.5); n /= T(2)) {
+      ++s;
+    }
+    a = T(1) / T(1l << s) * a;
+
+    constexpr T c[7] = {
+      T(1), T(1) / T(2), T(5) / T(44), T(1) / T(66), T(1) / T(792),
+      T(1) / T(15840), T(1) / T(665280)
+    };
+
+    S a2 = a * a, a4 = a2 * a2, a6 = a4 * a2;
+    S u = a * (S::identity(c[1]) + c[3] * a2 + c[5] * a4);
+    S v = S::identity(c[0]) + c[2] * a2 + c[4] * a4 + c[6] * a6;
+    S e = (v - u).inverse() * (v + u);
+    for (int k = 0; k < s; ++k) {
+      e = e * e;
+    }
+    e.store(E);
+    return 0;
+  }
+
+  /// Compute the principal matrix square root.
+  ///
+  /// 2x2 matrices use the closed form `(A + sqrt(det A) I) / sqrt(tr A + 2
+  /// sqrt(det A))`, and symmetric 3x3 matrices use their eigen-decomposition.
+  /// Everything else uses the Denman-Beavers iteration.
+  ///
+  /// The matrix must not have eigenvalues on the closed negative real axis.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in]        A The matrix (or `A(i,j)` callable) to read.
+  /// @param[out]       X The square root.
+  ///
+  /// @returns          0 If the square root converged.
+  ///            non-zero It didn't converge.
+  template <int M>
+  constexpr auto sqrtm(auto&& A, auto&& X) -> int
+  {
+    using std::sqrt;
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+    using S = detail::square<T, M>;
+
+    S a = S::load(A);
+
+    if constexpr (M == 2) {
+      T delta = sqrt(a(0,0) * a(1,1) - a(0,1) * a(1,0));
+      T tau = sqrt(a(0,0) + a(1,1) + T(2) * delta);
+      (T(1) / tau * (a + S::identity(delta))).store(X);
+      return not (tau > T(0));
+    }
+    else if constexpr (M == 3) {
+      if (a.symmetric()) {
+        detail::spectral(a, [](T x) { return sqrt(x); }).store(X);
+        return 0;
+      }
+    }
+
+    constexpr int max_iterations = 64;
+    constexpr T eps = std::numeric_limits<T>::epsilon();
+
+    S y = a, z = S::identity();
+    for (int k = 0; k < max_iterations; ++k) {
+      S next = T(0.5) * (y + z.inverse());
+      z = T(0.5) * (z + y.inverse());
+      T delta = (next - y).norm1();
+      y = next;
+      if (delta <= M * eps * y.norm1()) {
+        y.store(X);
+        return 0;
+      }
+    }
+    y.store(X);
+    return 1;
+  }
+
+  /// Compute the principal matrix logarithm.
+  ///
+  /// 2x2 matrices use the closed form from Cayley-Hamilton, and symmetric 3x3
+  /// matrices use their eigen-decomposition. Everything else uses inverse
+  /// scaling and squaring, which takes square roots until `A` is close to the
+  /// identity, and then sums the series `log(A) = 2 atanh((A - I)(A + I)^-1)`.
+  ///
+  /// The matrix must not have eigenvalues on the closed negative real axis.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in]        A The matrix (or `A(i,j)` callable) to read.
+  /// @param[out]       L The logarithm.
+  ///
+  /// @returns          0 If the square roots converged.
+  ///            non-zero They didn't converge.
+  template <int M>
+  constexpr auto logm(auto&& A, auto&& L) -> int
+  {
+    using std::atan2;
+    using std::log;
+    using std::sqrt;
+    using T = std::remove_cvref_t<decltype(A(0,0))>;
+    using S = detail::square<T, M>;
+
+    S a = S::load(A);
+
+    if constexpr (M == 2) {
+      detail::traceless f(a);
+      if (f.q > T(0)) {
+        T s = sqrt(f.q);
+        T l1 = log(f.t + s), l2 = log(f.t - s);
+        f.apply((l1 + l2) / T(2), (l1 - l2) / (T(2) * s)).store(L);
+      }
+      else if (f.q < T(0)) {
+        T w = sqrt(-f.q);
+        T r = f.t * f.t + w * w;
+        f.apply(log(r) / T(2), atan2(w, f.t) / w).store(L);
+      }
+      else {
+        f.apply(log(f.t), T(1) / f.t).store(L);
+      }
+      return 0;
+    }
+    else if constexpr (M == 3) {
+      if (a.symmetric()) {
+        detail::spectral(a, [](T x) { return log(x); }).store(L);
+        return 0;
+      }
+    }
+
+    constexpr int max_roots = 64;
+    constexpr int terms = 12;
+
+    S const I = S::identity();
+    int info = 0, k = 0;
+    for (; k < max_roots and (a - I).norm1() > T(0.25); ++k) {
+      info |= sqrtm<M>(S(a), a);
+    }
+
+    S z = (a - I) * (a + I).inverse();
+    S z2 = z * z, p = z, l = z;
+    for (int j = 1; j < terms; ++j) {
+      p = p * z2;
+      l = l + T(1) / T(2 * j + 1) * p;
+    }
+    (T(2 * (1l << k)) * l).store(L);
+    return info;
+  }
+
+  /// Compute the polar decomposition `F = R U`.
+  ///
+  /// `R` is orthogonal and `U` is symmetric positive semi-definite. 2x2
+  /// matrices use the closed form for the rotation (or reflection), and 3x3
+  /// matrices compute `U = sqrt(F^T F)` with `eigh<3>`. Everything else uses
+  /// the Newton iteration `R = (R + R^-T) / 2`.
+  ///
+  /// @tparam           M The size of the matrix.
+  ///
+  /// @param[in]        F The matrix (or `F(i,j)` callable) to read.
+  /// @param[out]       R The orthogonal factor.
+  /// @param[out]       U The symmetric factor.
+  ///
+  /// @returns          0 If the decomposition succeeded.
+  ///            non-zero `F` was singular, or the iteration didn't converge.
+  template <int M>
+  constexpr auto polar(auto&& F, auto&& R, auto&& U) -> int
+  {
+    using std::sqrt;
+    using T = std::remove_cvref_t<decltype(F(0,0))>;
+    using S = detail::square<T, M>;
+
+    S f = S::load(F), r;
+
+    if constexpr (M == 2) {
+      // A rotation when det(F) > 0 and a reflection otherwise.
+      T d = f(0,0) * f(1,1) - f(0,1) * f(1,0);
+      T sign = (d < T(0)) ? T(-1) : T(1);
+      T c = f(0,0) + sign * f(1,1);
+      T s = f(1,0) - sign * f(0,1);
+      T n = sqrt(c * c + s * s);
+      r(0,0) = c / n;
+      r(0,1) = -sign * s / n;
+      r(1,0) = s / n;
+      r(1,1) = sign * c / n;
+      if (d == T(0)) {
+        return 1;
+      }
+    }
+    else if constexpr (M == 3) {
+      // R = F U^-1 with U^-1 = V w^-1/2 V^T from the eigen-decomposition of
+      // F^T F.
+      S V, inv;
+      T w[3];
+      eigh<3>(f.transpose() * f, [&](int i) -> T& { return w[i]; }, V);
+      // F is singular to working precision when the smallest eigenvalue of
+      // F^T F is roundoff relative to the largest.
+      if (not (w[0] > 3 * std::numeric_limits<T>::epsilon() * w[2])) {
+        return 1;
+      }
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          for (int k = 0; k < 3; ++k) {
+            inv(i, j) += V(i, k) * V(j, k) / sqrt(w[k]);
+          }
+        }
+      }
+      r = f * inv;
+    }
+    else {
+      constexpr int max_iterations = 64;
+      constexpr T eps = std::numeric_limits<T>::epsilon();
+
+      r = f;
+      int k = 0;
+      for (; k < max_iterations; ++k) {
+        S next = T(0.5) * (r + r.inverse().transpose());
+        T delta = (next - r).norm1();
+        r = next;
+        if (delta <= M * eps * r.norm1()) {
+          break;
+        }
+      }
+      if (k == max_iterations) {
+        return 1;
+      }
+    }
+
+    // U = R^T F, symmetrized against roundoff
+    S u = r.transpose() * f;
+    u = T(0.5) * (u + u.transpose());
+    r.store(R);
+    u.store(U);
+    return 0;
+  }
 } // namespace albert
 
 #endif // #define ALBERT_INCLUDE_ALBERT_LINEAR_ALGEBRA_HPP
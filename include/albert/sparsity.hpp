@@ -0,0 +1,97 @@
+#ifndef ALBERT_INCLUDE_SPARSITY_HPP
+#define ALBERT_INCLUDE_SPARSITY_HPP
+
+#include <array>
+#include <type_traits>
+
+namespace albert
+{
+  /// Diagonal sparsity of an expression.
+  ///
+  /// An expression is diagonal in a pair of its outer index characters when it
+  /// is zero unless the two indices are equal, e.g., `δ(i,j)`, or `λ * δ(i,j)
+  /// * δ(k,l)`, which is diagonal in `ij` and in `kl`. Products don't evaluate
+  /// their operands off of their diagonal, and assignments only evaluate the
+  /// right-hand-side on it.
+  ///
+  /// Node types that preserve or introduce diagonals specialize this template,
+  /// the default is dense.
+  template <class E>
+  struct diagonal
+  {
+    constexpr static bool apply(char, char)
+    {
+      return false;
+    }
+  };
+
+  template <class E>
+  constexpr bool is_diagonal_in(char a, char b)
+  {
+    return a != b and diagonal<std::remove_cvref_t<E>>::apply(a, b);
+  }
+
+  /// The diagonal of an order `Order` expression, over its `outer` index.
+  ///
+  /// Each position maps to the first position that it must be equal to
+  /// (possibly itself), and the `n` positions that map to themselves span the
+  /// diagonal.
+  template <int Order>
+  struct Diagonal
+  {
+    std::array<int, Order> first = {};
+    int n = Order;
+
+    constexpr auto is_dense() const -> bool
+    {
+      return n == Order;
+    }
+
+    /// The position of `p` in the `n`-dimensional diagonal.
+    constexpr auto axis(int p) const -> int
+    {
+      int k = 0;
+      for (int q = 0; q < first[p]; ++q) {
+        k += (first[q] == q);
+      }
+      return k;
+    }
+  };
+
+  /// Merge the characters of `outer` that `E` is diagonal in.
+  template <class E, int Order>
+  constexpr auto diagonal_of(auto const& outer) -> Diagonal<Order>
+  {
+    Diagonal<Order> out;
+    for (int p = 0; p < Order; ++p) {
+      out.first[p] = p;
+    }
+
+    // union the pairs, keeping the smallest position as the root
+    auto root = [&](int p) {
+      while (out.first[p] != p) {
+        p = out.first[p];
+      }
+      return p;
+    };
+
+    for (int p = 0; p < Order; ++p) {
+      for (int q = p + 1; q < Order; ++q) {
+        if (is_diagonal_in<E>(outer[p], outer[q])) {
+          int a = root(p), b = root(q);
+          if (a < b) out.first[b] = a;
+          if (b < a) out.first[a] = b;
+        }
+      }
+    }
+
+    out.n = 0;
+    for (int p = 0; p < Order; ++p) {
+      out.first[p] = root(p);
+      out.n += (out.first[p] == p);
+    }
+    return out;
+  }
+}
+
+#endif // ALBERT_INCLUDE_SPARSITY_HPP
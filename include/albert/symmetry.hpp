@@ -0,0 +1,33 @@
+#ifndef ALBERT_INCLUDE_SYMMETRY_HPP
+#define ALBERT_INCLUDE_SYMMETRY_HPP
+
+#include <type_traits>
+
+namespace albert
+{
+  /// Index symmetries of an expression.
+  ///
+  /// An expression is symmetric in a pair of its outer index characters when
+  /// swapping them doesn't change its value, e.g., `S(i,j)` for a tensor with
+  /// symmetric storage is symmetric in `i` and `j`. Contractions over a pair
+  /// in which both operands are symmetric only visit each unique pair once.
+  ///
+  /// Node types that preserve or introduce symmetries specialize this
+  /// template, the default is conservative.
+  template <class E>
+  struct symmetry
+  {
+    constexpr static bool apply(char, char)
+    {
+      return false;
+    }
+  };
+
+  template <class E>
+  constexpr bool is_symmetric_in(char a, char b)
+  {
+    return symmetry<std::remove_cvref_t<E>>::apply(a, b);
+  }
+}
+
+#endif // ALBERT_INCLUDE_SYMMETRY_HPP
@@ -14,6 +14,15 @@ namespace albert
     return out;
   }
 
+  constexpr int factorial(int n)
+  {
+    int out = 1;
+    for (int i = 2; i <= n; i++) {
+      out *= i;
+    }
+    return out;
+  }
+
   constexpr int max(int a, int b)
   {
     return (a < b) ? b : a;
@@ -0,0 +1,147 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <cmath>
+#include <limits>
+
+using albert::Tensor;
+using albert::ad::Tape;
+using albert::ad::Var;
+using albert::tests::type_args;
+using albert::tests::args;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+template <class T>
+static bool near(T a, T b)
+{
+  T tol = std::sqrt(std::numeric_limits<T>::epsilon());
+  return std::abs(a - b) <= tol * std::max(T(1), std::abs(b));
+}
+
+/// The adjoints of the arithmetic operators and the elementary functions,
+/// against the derivatives by hand.
+template <class T>
+static bool arithmetic(type_args<T> = {})
+{
+  bool passed = true;
+
+  static_assert(albert::is_scalar<Var<T>>);
+  static_assert(std::is_same_v<albert::scalar_type_t<Var<T>>, Var<T>>);
+
+  Tape<T> tape;
+  Var<T> x = tape.variable(T(0.5));
+  Var<T> y = tape.variable(T(2));
+  Var<T> z = tape.variable(T(3));
+
+  Var<T> f = x * y + z / y - T(2) * x + 1;
+  tape.backward(f);
+  passed &= ALBERT_CHECK( near(f.value(), T(0.5 * 2 + 1.5 - 1 + 1)) );
+  passed &= ALBERT_CHECK( near(tape.adjoint(x), T(2 - 2)) );
+  passed &= ALBERT_CHECK( near(tape.adjoint(y), T(0.5 - 3.0 / 4)) );
+  passed &= ALBERT_CHECK( near(tape.adjoint(z), T(0.5)) );
+
+  tape.reset();
+  x = tape.variable(T(0.5));
+  y = tape.variable(T(2));
+  z = tape.variable(T(3));
+
+  Var<T> g = exp(x) * sqrt(y) + log(z) * sin(x) + pow(y, z) + atan2(y, z);
+  tape.backward(g);
+  T r = 1 / T(4 + 9);
+  passed &= ALBERT_CHECK( near(tape.adjoint(x), std::exp(T(0.5)) * std::sqrt(T(2)) + std::log(T(3)) * std::cos(T(0.5))) );
+  passed &= ALBERT_CHECK( near(tape.adjoint(y), std::exp(T(0.5)) / (2 * std::sqrt(T(2))) + 3 * T(4) + 3 * r) );
+  passed &= ALBERT_CHECK( near(tape.adjoint(z), std::sin(T(0.5)) / 3 + T(8) * std::log(T(2)) - 2 * r) );
+
+  // constants, and adding constants, are not recorded
+  int size = tape.size();
+  Var<T> c = Var<T>(T(2)) * T(3) + T(1);
+  Var<T> w = x + T(1);
+  passed &= ALBERT_CHECK( tape.size() == size and c.tape == nullptr and w.n == x.n );
+
+  return passed;
+}
+
+/// Gradients of scalar energies against forward mode.
+template <class T>
+static bool gradients(type_args<T> = {})
+{
+  bool passed = true;
+
+  T const lambda = 2, mu = 3;
+
+  Tensor<T, 2, 3> E;
+  for (int e = 0; e < 9; ++e) {
+    E[e] = T(e + 1) / 10 + T(e % 4 == 0);
+  }
+
+  // Saint Venant-Kirchhoff, with the stress as its gradient
+  auto svk = [&](auto const& E) {
+    auto tr = E(k,k);
+    return T(lambda / 2) * tr * tr + T(mu) * E(i,j) * E(i,j);
+  };
+
+  Tape<T> tape;
+  Tensor<T, 2, 3> S = albert::ad::gradient(tape, svk, E);
+  T tr = E(k,k);
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      passed &= ALBERT_CHECK( near(S(a,b), lambda * tr * (a == b) + 2 * mu * E(a,b)) );
+    }
+  }
+
+  // the tape is reset for each evaluation, and keeps its memory
+  int size = tape.size();
+  S = albert::ad::gradient(tape, svk, E);
+  passed &= ALBERT_CHECK( tape.size() == size );
+
+  // the expression nodes, the elementary functions, and the solvers record
+  auto W = [](auto const& E) {
+    return albert::log(albert::det(E)) + albert::exp(E(i,j) * E(j,i) / 9) + albert::sqrt(E(i,i));
+  };
+  Tensor<T, 2, 3> G = albert::ad::gradient(W, E);
+  Tensor<T, 2, 3> J = albert::jacobian(W, E);
+  for (int e = 0; e < 9; ++e) {
+    passed &= ALBERT_CHECK( near(G[e], J[e]) );
+  }
+
+  // order 4 variables
+  Tensor<T, 4, 3> C;
+  for (int e = 0; e < 81; ++e) {
+    C[e] = T(e % 7) / 7;
+  }
+  auto V = [](auto const& C) {
+    return C(i,j,k,l) * C(i,j,k,l) + albert::sin(C(i,i,k,k));
+  };
+  Tensor<T, 4, 3> H = albert::ad::gradient(V, C);
+  T s = std::cos(T(C(i,i,k,k)));
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      for (int c = 0; c < 3; ++c) {
+        for (int d = 0; d < 3; ++d) {
+          T expected = 2 * C(a,b,c,d) + s * (a == b and c == d);
+          passed &= ALBERT_CHECK( near(H(a,b,c,d), expected) );
+        }
+      }
+    }
+  }
+
+  return passed;
+}
+
+template <class T>
+static bool tests(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= arithmetic(type);
+  passed &= gradients(type);
+  return passed;
+}
+
+int main()
+{
+  bool f = tests(args<float>);
+  bool d = tests(args<double>);
+}
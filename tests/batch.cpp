@@ -0,0 +1,109 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+
+using albert::Tensor;
+using albert::TensorBatch;
+using albert::tests::type_args;
+using albert::tests::args;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+
+template <class T>
+static bool lanes(type_args<T> = {})
+{
+  bool passed = true;
+
+  TensorBatch<T, 2, 3, 4> A;
+  static_assert(albert::is_scalar<albert::scalar_type_t<decltype(A)>>);
+  static_assert(albert::lanes_v<albert::scalar_type_t<decltype(A)>> == 4);
+
+  for (int l = 0; l < 4; ++l) {
+    Tensor<T, 2, 3> a;
+    for (int n = 0; n < a.size(); ++n) {
+      a[n] = 10 * l + n;
+    }
+    albert::set_lane(A, l, a);
+  }
+
+  // elements are outermost, lanes are contiguous
+  for (int n = 0; n < A.size(); ++n) {
+    for (int l = 0; l < 4; ++l) {
+      passed &= ALBERT_CHECK( A[n][l] == 10 * l + n );
+    }
+  }
+
+  for (int l = 0; l < 4; ++l) {
+    Tensor<T, 2, 3> a = albert::get_lane(A, l);
+    for (int n = 0; n < a.size(); ++n) {
+      passed &= ALBERT_CHECK( a[n] == 10 * l + n );
+    }
+  }
+
+  return passed;
+}
+
+template <class T>
+static bool expressions(type_args<T> = {})
+{
+  bool passed = true;
+
+  constexpr int L = albert::simd_width_v<T>;
+
+  TensorBatch<T, 2, 3> A, B, C;
+  TensorBatch<T, 1, 3> v, w;
+  Tensor<T, 2, 3> a[L], b[L];
+  Tensor<T, 1, 3> x[L];
+
+  for (int l = 0; l < L; ++l) {
+    for (int n = 0; n < 9; ++n) {
+      a[l][n] = n + l;
+      b[l][n] = (n * l) % 5;
+    }
+    for (int n = 0; n < 3; ++n) {
+      x[l][n] = n - l;
+    }
+    albert::set_lane(A, l, a[l]);
+    albert::set_lane(B, l, b[l]);
+    albert::set_lane(v, l, x[l]);
+  }
+
+  // every lane evaluates the same expression as the scalar tensors
+  C(i,j) = A(i,k) * B(k,j) + T(2) * A(j,i) - B(i,j) / T(2);
+  w(i) = A(i,j) * v(j) + -v(i);
+  albert::scalar_type_t<decltype(A)> trace = A(i,i);
+
+  for (int l = 0; l < L; ++l) {
+    Tensor<T, 2, 3> c = a[l](i,k) * b[l](k,j) + T(2) * a[l](j,i) - b[l](i,j) / T(2);
+    Tensor<T, 1, 3> y = a[l](i,j) * x[l](j) + -x[l](i);
+    T t = a[l](i,i);
+
+    Tensor<T, 2, 3> cl = albert::get_lane(C, l);
+    Tensor<T, 1, 3> yl = albert::get_lane(w, l);
+    for (int n = 0; n < 9; ++n) {
+      passed &= ALBERT_CHECK( cl[n] == c[n] );
+    }
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( yl[n] == y[n] );
+    }
+    passed &= ALBERT_CHECK( trace[l] == t );
+  }
+
+  return passed;
+}
+
+template <class T>
+static bool tests(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= lanes(type);
+  passed &= expressions(type);
+  return passed;
+}
+
+int main()
+{
+  bool f = tests(args<float>);
+  bool d = tests(args<double>);
+}
@@ -0,0 +1,186 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <cmath>
+#include <limits>
+
+using albert::Tensor;
+using albert::tests::type_args;
+using albert::tests::args;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+constexpr static albert::Index<'m'> m;
+constexpr static albert::Index<'n'> n;
+
+template <class T>
+static bool near(T a, T b)
+{
+  T tol = std::sqrt(std::numeric_limits<T>::epsilon());
+  return std::abs(a - b) <= tol * std::max(T(1), std::abs(b));
+}
+
+/// Compare an order 4 symbolic derivative with the jacobian computed with
+/// duals.
+static bool matches(auto const& a, auto const& b)
+{
+  bool passed = true;
+  for (int e = 0; e < a.size(); ++e) {
+    passed &= ALBERT_CHECK( near(a[e], b[e]) );
+  }
+  return passed;
+}
+
+template <class T>
+static bool variables(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 2, 3> E, C;
+  for (int e = 0; e < 9; ++e) {
+    E[e] = T(e + 1) / 10;
+    C[e] = T(e % 4);
+  }
+
+  // ∂E(i,j)/∂E(k,l) is a product of deltas
+  Tensor<T, 4, 3> I = albert::D(E(i,j), E(k,l));
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      for (int c = 0; c < 3; ++c) {
+        for (int d = 0; d < 3; ++d) {
+          passed &= ALBERT_CHECK( I(a,b,c,d) == T(a == c and b == d) );
+        }
+      }
+    }
+  }
+
+  // ∂E(j,i)/∂E(k,l) is the transpose, and ∂E(i,i)/∂E(k,l) is the identity
+  Tensor<T, 4, 3> Et;
+  Et(i,j,k,l) = albert::D(E(j,i), E(k,l));
+  Tensor<T, 2, 3> tr = albert::D(E(i,i), E(k,l));
+  passed &= ALBERT_CHECK( Et(0,1,1,0) == 1 and Et(0,1,0,1) == 0 );
+  passed &= ALBERT_CHECK( tr(0,0) == 1 and tr(1,1) == 1 and tr(0,1) == 0 );
+
+  // anything that doesn't depend on the variable is eliminated at compile
+  // time, including tensors of other types
+  Tensor<T, 1, 3> v = { 1, 2, 3 };
+  static_assert(albert::is_zero_v<decltype(albert::differentiate(C(i,j) * v(j), E(k,l)))>);
+  static_assert(albert::is_zero_v<decltype(albert::differentiate(albert::exp(v(i)), E(k,l)))>);
+
+  // C has the same type as E, so it is only recognized as a constant at
+  // runtime
+  Tensor<T, 4, 3> CE = albert::D(C(i,m) * E(m,j), E(k,l));
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      for (int c = 0; c < 3; ++c) {
+        for (int d = 0; d < 3; ++d) {
+          passed &= ALBERT_CHECK( CE(a,b,c,d) == C(a,c) * T(b == d) );
+        }
+      }
+    }
+  }
+
+  return passed;
+}
+
+/// The tangent of Saint Venant-Kirchhoff, `λ δ(i,j) δ(k,l) + 2 μ δ(i,k) δ(j,l)`.
+template <class T>
+static bool tangent(type_args<T> = {})
+{
+  bool passed = true;
+
+  T const lambda = 2, mu = 3;
+
+  Tensor<T, 2, 3> E;
+  for (int e = 0; e < 9; ++e) {
+    E[e] = T(e) / 10;
+  }
+
+  auto S = T(lambda) * E(m,m) * albert::δ(i,j) + T(2 * mu) * E(i,j);
+  Tensor<T, 4, 3> C = albert::D(S, E(k,l));
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      for (int c = 0; c < 3; ++c) {
+        for (int d = 0; d < 3; ++d) {
+          T expected = lambda * (a == b) * (c == d) + 2 * mu * (a == c) * (b == d);
+          passed &= ALBERT_CHECK( near(C(a,b,c,d), expected) );
+        }
+      }
+    }
+  }
+
+  // second derivatives
+  Tensor<T, 4, 3> H = albert::D(albert::D(E(i,j) * E(i,j), E(k,l)), E(m,n));
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      for (int c = 0; c < 3; ++c) {
+        for (int d = 0; d < 3; ++d) {
+          passed &= ALBERT_CHECK( H(a,b,c,d) == 2 * T(a == c and b == d) );
+        }
+      }
+    }
+  }
+
+  return passed;
+}
+
+/// The product rule, the chain rule, inverses, and determinants against the
+/// jacobians computed with duals.
+template <class T>
+static bool rules(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 2, 3> E;
+  for (int e = 0; e < 9; ++e) {
+    E[e] = T(e + 1) / 10 + T(e % 4 == 0);
+  }
+
+  auto product = [](auto const& E) { return E(i,m) * E(j,m) + E(i,j) * E(m,m); };
+  auto chain = [](auto const& E) {
+    return albert::exp(E(i,j)) - albert::pow(E(j,i), T(3)) + albert::sin(E(i,m) * E(m,j)) / 2;
+  };
+  auto binary = [](auto const& E) { return albert::pow(E(i,j), E(j,i)) + albert::atan2(E(i,j), E(i,i)); };
+  auto inverse = [](auto const& E) { return albert::inv(E(i,j)) + E(i,j) / E(m,m); };
+  auto det = [](auto const& E) { return albert::det(E) * E(i,j); };
+
+  Tensor<T, 4, 3> P = albert::D(product(E), E(k,l));
+  Tensor<T, 4, 3> C = albert::D(chain(E), E(k,l));
+  Tensor<T, 4, 3> B = albert::D(binary(E), E(k,l));
+  Tensor<T, 4, 3> I = albert::D(inverse(E), E(k,l));
+  Tensor<T, 4, 3> J = albert::D(det(E), E(k,l));
+
+  passed &= matches(P, albert::jacobian(product, E));
+  passed &= matches(C, albert::jacobian(chain, E));
+  passed &= matches(B, albert::jacobian(binary, E));
+  passed &= matches(I, albert::jacobian(inverse, E));
+  passed &= matches(J, albert::jacobian(det, E));
+
+  // gradients of scalars
+  Tensor<T, 2, 3> g = albert::D(albert::log(E(i,j) * E(i,j)), E(k,l));
+  T s = T(E(i,j) * E(i,j));
+  passed &= ALBERT_CHECK( near(g(1,2), 2 * E(1,2) / s) );
+
+  // derivatives inside of larger expressions
+  T d = albert::D(E(i,j) * E(i,j), E(k,l)) * albert::δ(k,l);
+  passed &= ALBERT_CHECK( near(d, 2 * T(E(i,i))) );
+
+  return passed;
+}
+
+template <class T>
+static bool tests(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= variables(type);
+  passed &= tangent(type);
+  passed &= rules(type);
+  return passed;
+}
+
+int main()
+{
+  bool f = tests(args<float>);
+  bool d = tests(args<double>);
+}
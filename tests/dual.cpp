@@ -0,0 +1,193 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <cmath>
+#include <limits>
+
+using albert::Dual;
+using albert::Tensor;
+using albert::tests::type_args;
+using albert::tests::args;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+template <class T>
+static bool near(T a, T b)
+{
+  T tol = std::sqrt(std::numeric_limits<T>::epsilon());
+  return std::abs(a - b) <= tol * std::max(T(1), std::abs(b));
+}
+
+/// The chain rule through the arithmetic operators and the elementary
+/// functions, against the derivatives by hand.
+template <class T>
+static bool arithmetic(type_args<T> = {})
+{
+  bool passed = true;
+
+  using D = Dual<T, 3>;
+  static_assert(albert::is_scalar<D>);
+  static_assert(std::is_same_v<albert::scalar_type_t<D>, D>);
+
+  D x = D::variable(T(0.5), 0);
+  D y = D::variable(T(2), 1);
+  D z = D::variable(T(3), 2);
+
+  D f = x * y + z / y - T(2) * x + 1;
+  passed &= ALBERT_CHECK( near(f.value(), T(0.5 * 2 + 1.5 - 1 + 1)) );
+  passed &= ALBERT_CHECK( near(f.derivative(0), T(2 - 2)) );
+  passed &= ALBERT_CHECK( near(f.derivative(1), T(0.5 - 3.0 / 4)) );
+  passed &= ALBERT_CHECK( near(f.derivative(2), T(0.5)) );
+
+  D g = exp(x) * sqrt(y) + log(z) * sin(x) + pow(y, z) + atan2(y, z);
+  T r = 1 / T(4 + 9);
+  passed &= ALBERT_CHECK( near(g.derivative(0), std::exp(T(0.5)) * std::sqrt(T(2)) + std::log(T(3)) * std::cos(T(0.5))) );
+  passed &= ALBERT_CHECK( near(g.derivative(1), std::exp(T(0.5)) / (2 * std::sqrt(T(2))) + 3 * T(4) + 3 * r) );
+  passed &= ALBERT_CHECK( near(g.derivative(2), std::sin(T(0.5)) / 3 + T(8) * std::log(T(2)) - 2 * r) );
+
+  // comparisons use the values
+  passed &= ALBERT_CHECK( x < y and y <= z and z > T(1) and not (x == y) );
+  passed &= ALBERT_CHECK( abs(-x).derivative(0) == T(1) );
+
+  return passed;
+}
+
+/// Dual tensors through the expression nodes and the solvers.
+template <class T>
+static bool expressions(type_args<T> = {})
+{
+  bool passed = true;
+
+  using D = Dual<T, 9>;
+
+  Tensor<D, 2, 3> A, B;
+  for (int n = 0; n < 9; ++n) {
+    A[n] = D::variable(T(n + 1) / 4 + T(n % 4 == 0), n);
+  }
+
+  // tr(A A) has the gradient 2 A^T
+  D t = A(i,j) * A(j,i);
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( near(t.derivative(3 * m + n), 2 * A(n,m).value()) );
+    }
+  }
+
+  // elementwise functions and contractions
+  B(i,j) = albert::exp(A(i,j)) + A(i,k) * A(k,j) - T(2) * A(j,i);
+  passed &= ALBERT_CHECK( near(B(1,2).derivative(5), std::exp(A(1,2).value()) + A(1,1).value() + A(2,2).value()) );
+  passed &= ALBERT_CHECK( near(B(1,2).derivative(7), -T(2)) );
+
+  // d det(A) / dA = det(A) A^-T
+  D d = albert::det(A);
+  Tensor<T, 2, 3> a, inv;
+  for (int n = 0; n < 9; ++n) {
+    a[n] = A[n].value();
+  }
+  albert::solver::inverse<3>(a, inv);
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( near(d.derivative(3 * m + n), d.value() * inv(n,m)) );
+    }
+  }
+
+  // x = A^-1 b, so dx/db = A^-1
+  using E = Dual<T, 3>;
+  Tensor<E, 2, 3> LU;
+  Tensor<E, 1, 3> x;
+  for (int n = 0; n < 9; ++n) {
+    LU[n] = a[n];
+  }
+  for (int n = 0; n < 3; ++n) {
+    x[n] = E::variable(T(n + 1), n);
+  }
+  passed &= ALBERT_CHECK( albert::solver::solve<3>(LU, x) == 0 );
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( near(x(m).derivative(n), inv(m,n)) );
+    }
+  }
+
+  return passed;
+}
+
+/// The material tangent of Saint Venant-Kirchhoff and of a nonlinear law.
+template <class T>
+static bool jacobian(type_args<T> = {})
+{
+  bool passed = true;
+
+  T const lambda = 2, mu = 3;
+
+  Tensor<T, 2, 3> E;
+  for (int n = 0; n < 9; ++n) {
+    E[n] = T(n) / 10;
+  }
+
+  // S = lambda tr(E) I + 2 mu E, so J = lambda δ(i,j) δ(k,l) + 2 mu δ(i,k) δ(j,l)
+  auto svk = [&](auto const& E) {
+    using D = albert::scalar_type_t<decltype(E)>;
+    Tensor<D, 2, 3> S;
+    S(i,j) = D(2 * mu) * E(i,j);
+    D tr = E(k,k);
+    for (int n = 0; n < 3; ++n) {
+      S(n,n) += lambda * tr;
+    }
+    return S;
+  };
+
+  auto J = albert::jacobian(svk, E);
+  static_assert(albert::order_v<decltype(J)> == 4);
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      for (int c = 0; c < 3; ++c) {
+        for (int d = 0; d < 3; ++d) {
+          T expected = lambda * (a == b) * (c == d) + 2 * mu * (a == c) * (b == d);
+          passed &= ALBERT_CHECK( near(J(a,b,c,d), expected) );
+        }
+      }
+    }
+  }
+
+  // an expression of the variables, S = E E^T + exp(E), against finite
+  // differences
+  auto f = [](auto const& E) { return E(i,k) * E(j,k) + albert::exp(E(i,j)); };
+  auto K = albert::jacobian(f, E);
+  T h = std::sqrt(std::numeric_limits<T>::epsilon());
+  for (int n = 0; n < 9; ++n) {
+    Tensor<T, 2, 3> Ep(E), Em(E);
+    Ep[n] += h;
+    Em[n] -= h;
+    Tensor<T, 2, 3> Sp = f(Ep), Sm = f(Em);
+    for (int m = 0; m < 9; ++m) {
+      T fd = (Sp[m] - Sm[m]) / (2 * h);
+      passed &= ALBERT_CHECK( std::abs(K[9 * m + n] - fd) <= std::sqrt(h) );
+    }
+  }
+
+  // scalar functions have gradients
+  auto g = [](auto const& E) { return albert::det(E); };
+  auto G = albert::jacobian(g, E);
+  static_assert(albert::order_v<decltype(G)> == 2);
+  passed &= ALBERT_CHECK( near(G(0,0), E(1,1) * E(2,2) - E(1,2) * E(2,1)) );
+
+  return passed;
+}
+
+template <class T>
+static bool tests(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= arithmetic(type);
+  passed &= expressions(type);
+  passed &= jacobian(type);
+  return passed;
+}
+
+int main()
+{
+  bool f = tests(args<float>);
+  bool d = tests(args<double>);
+}
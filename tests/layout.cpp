@@ -0,0 +1,214 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <cstdint>
+
+using albert::Tensor;
+using albert::Aligned;
+using albert::ColumnMajor;
+using albert::Padded;
+using albert::Permuted;
+using albert::RowMajor;
+using albert::tests::type_args;
+using albert::tests::args;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+
+template <class T>
+constexpr static bool strides(type_args<T> = {})
+{
+  bool passed = true;
+
+  static_assert(RowMajor<2, 3>::stride == std::array{ 3, 1 });
+  static_assert(ColumnMajor<2, 3>::stride == std::array{ 1, 3 });
+  static_assert(ColumnMajor<3, 2>::stride == std::array{ 1, 2, 4 });
+  static_assert(Permuted<3, 2, std::array{ 1, 2, 0 }>::stride == std::array{ 1, 4, 2 });
+  static_assert(Padded<2, 3, 4>::stride == std::array{ 4, 1 });
+  static_assert(Padded<2, 3, 4>::size == 12 and not Padded<2, 3, 4>::dense);
+
+  // values are always initialized in row-major order
+  Tensor<T, 2, 3, ColumnMajor<2, 3>> A = { 1, 2, 3,
+                                           4, 5, 6,
+                                           7, 8, 9 };
+  passed &= ALBERT_CHECK( A(0,1) == 2 and A(1,0) == 4 );
+  passed &= ALBERT_CHECK( A[1] == 4 and A[3] == 2 );
+
+  Tensor<T, 2, 3, Padded<2, 3, 4>> B = { 1, 2, 3,
+                                         4, 5, 6,
+                                         7, 8, 9 };
+  passed &= ALBERT_CHECK( B.size() == 9 and B.span() == 12 );
+  passed &= ALBERT_CHECK( B[4] == 4 and B(2,2) == 9 );
+
+  return passed;
+}
+
+template <class T>
+constexpr static bool assignment(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 2, 3> A = { 1, 2, 3,
+                        4, 5, 6,
+                        7, 8, 9 };
+
+  // row-major to column-major is a copy of the values, and a transpose of
+  // the storage
+  Tensor<T, 2, 3, ColumnMajor<2, 3>> B = A(i,j);
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( B(m,n) == A(m,n) );
+      passed &= ALBERT_CHECK( B[3 * n + m] == A[3 * m + n] );
+    }
+  }
+
+  // mixed layouts on the right-hand-side, and a transpose in place
+  Tensor<T, 2, 3, ColumnMajor<2, 3>> C;
+  C(i,j) = A(i,j) + B(j,i);
+  C(i,j) = C(j,i);
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( C(m,n) == A(n,m) + A(m,n) );
+    }
+  }
+
+  // padded storage only writes the elements of the tensor
+  Tensor<T, 2, 3, Padded<2, 3, 4>> D;
+  D[3] = D[7] = D[11] = 42;
+  D(i,j) = 2 * A(j,i);
+  passed &= ALBERT_CHECK( D(1,2) == 2 * A(2,1) );
+  passed &= ALBERT_CHECK( D[3] == 42 and D[7] == 42 and D[11] == 42 );
+
+  // a large permuted iteration space uses the odometer in storage order
+  using P = Permuted<3, 5, std::array{ 2, 0, 1 }>;
+  Tensor<T, 3, 5> E;
+  for (int n = 0; n < E.size(); ++n) {
+    E[n] = n;
+  }
+
+  Tensor<T, 3, 5, P> F = E(i,j,k);
+  Tensor<T, 3, 5> G;
+  G(i,j,k) = F(k,j,i);
+  for (int a = 0; a < 5; ++a) {
+    for (int b = 0; b < 5; ++b) {
+      for (int c = 0; c < 5; ++c) {
+        passed &= ALBERT_CHECK( F(a,b,c) == E(a,b,c) );
+        passed &= ALBERT_CHECK( G(a,b,c) == E(c,b,a) );
+      }
+    }
+  }
+
+  return passed;
+}
+
+template <class T>
+constexpr static bool storage_order(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 3, 2, ColumnMajor<3, 2>> A;
+  static_assert(albert::storage_order_v<decltype(A(i,j,k))> == std::array{ 2, 1, 0 });
+  static_assert(albert::storage_order_v<decltype(A(k,i,j))> == std::array{ 2, 1, 0 });
+  static_assert(albert::storage_order_v<decltype(A(i,1,j))> == std::array{ 1, 0 });
+
+  Tensor<T, 3, 2, Permuted<3, 2, std::array{ 1, 2, 0 }>> B;
+  static_assert(albert::storage_order_v<decltype(B(i,j,k))> == std::array{ 1, 2, 0 });
+  static_assert(albert::storage_order_v<decltype(B(0,j,k))> == std::array{ 0, 1 });
+
+  albert::tests::unused(&A, &B);
+  return passed;
+}
+
+/// Streaming assignment must not mix layouts.
+template <class T>
+static bool vectorization(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 2, 4> A;
+  Tensor<T, 2, 4, ColumnMajor<2, 4>> B;
+  for (int n = 0; n < A.size(); ++n) {
+    A[n] = T(n);
+    B[n] = T(2 * n);
+  }
+
+  if constexpr (albert::simd_bytes != 0) {
+    static_assert(albert::is_vectorizable<decltype(A(i,j))>);
+    static_assert(albert::is_vectorizable<decltype(B(i,j))>);
+    static_assert(not albert::is_vectorizable<decltype(A(i,j) + B(i,j))>);
+    static_assert(albert::is_vectorizable<decltype(B(i,j) + T(2) * B(i,j))>);
+  }
+
+  Tensor<T, 2, 4> C;
+  C(i,j) = A(i,j) + B(i,j);
+  Tensor<T, 2, 4, ColumnMajor<2, 4>> D;
+  D(i,j) = B(i,j) + T(2) * B(i,j);
+  for (int m = 0; m < 4; ++m) {
+    for (int n = 0; n < 4; ++n) {
+      passed &= ALBERT_CHECK( C(m,n) == A(m,n) + B(m,n) );
+      passed &= ALBERT_CHECK( D(m,n) == 3 * B(m,n) );
+    }
+  }
+
+  return passed;
+}
+
+/// Aligned layouts stream whole, aligned vectors over their padding.
+template <class T>
+static bool alignment(type_args<T> = {})
+{
+  bool passed = true;
+
+  using L3 = Aligned<T, 2, 3>;
+  using L6 = Aligned<T, 2, 6>;
+  static_assert(L3::stride[0] >= 3 and L6::stride[0] >= 6);
+  if constexpr (albert::simd_bytes != 0) {
+    static_assert(L3::stride[0] == 4 and L3::align == albert::min(albert::simd_bytes, 4 * sizeof(T)));
+    static_assert(L3::size * sizeof(T) % L3::align == 0);
+    static_assert(L6::size * sizeof(T) % L6::align == 0);
+  }
+
+  Tensor<T, 2, 3, L3> A = { 1, 2, 3,
+                            4, 5, 6,
+                            7, 8, 9 };
+  Tensor<T, 2, 3, L3> B = T(2) * A(i,j);
+  static_assert(alignof(decltype(A)) >= L3::align);
+  static_assert(albert::simd_bytes == 0 or albert::is_vectorizable<decltype(A(i,j) + B(i,j))>);
+  passed &= ALBERT_CHECK( reinterpret_cast<std::uintptr_t>(A.data()) % alignof(decltype(A)) == 0 );
+
+  B(i,j) += A(i,j) / 2;
+  Tensor<T, 2, 3, L3> C;
+  C(i,j) = B(i,j) - A(i,j);
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( B(m,n) == T(2.5) * A(m,n) );
+      passed &= ALBERT_CHECK( C(m,n) == T(1.5) * A(m,n) );
+    }
+  }
+
+  // the padding is zeroed, and stays finite
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 3; n < L3::stride[0]; ++n) {
+      passed &= ALBERT_CHECK( C[m * L3::stride[0] + n] == 0 );
+    }
+  }
+
+  return passed;
+}
+
+template <class T>
+constexpr static bool tests(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= strides(type);
+  passed &= assignment(type);
+  passed &= storage_order(type);
+  return passed;
+}
+
+int main()
+{
+  constexpr bool i = tests(args<int>);
+  bool f = tests(args<float>) and vectorization(args<float>) and alignment(args<float>);
+  bool d = tests(args<double>) and vectorization(args<double>) and alignment(args<double>);
+}
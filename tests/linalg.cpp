@@ -0,0 +1,637 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+using albert::Tensor;
+using albert::TensorBatch;
+using albert::tests::type_args;
+using albert::tests::args;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+
+/// Integral tests are exact, floating point tests allow some roundoff.
+template <class T>
+constexpr static bool near(T a, T b)
+{
+  T d = (a < b) ? b - a : a - b;
+  return d <= (std::is_integral_v<T> ? T(0) : T(1e-4));
+}
+
+/// A unimodular test matrix, `L * U` for unit triangular `L` and `U`.
+///
+/// The determinant is 1, and the inverse has integral values.
+template <class T, int M>
+constexpr static auto unimodular()
+{
+  Tensor<T, 2, M> L, U;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      L(m,n) = (m == n) ? 1 : (m > n) ? (m + n) % 3 - 1 : 0;
+      U(m,n) = (m == n) ? 1 : (m < n) ? (m * n) % 2 + 1 : 0;
+    }
+  }
+  Tensor<T, 2, M> A = L(i,k) * U(k,j);
+  return A;
+}
+
+template <class T, int M>
+constexpr static bool inverse()
+{
+  bool passed = true;
+
+  auto A = unimodular<T, M>();
+  Tensor<T, 2, M> B = albert::inv(A(i,j));
+  Tensor<T, 2, M> I = A(i,k) * B(k,j);
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      passed &= ALBERT_CHECK( near(I(m,n), T(m == n)) );
+    }
+  }
+
+  // the inverse of the transpose is the transpose of the inverse
+  Tensor<T, 2, M> C;
+  C(i,j) = albert::inv(A(j,i));
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      passed &= ALBERT_CHECK( near(C(m,n), B(n,m)) );
+    }
+  }
+
+  // inverses of expressions, and inverses in place
+  Tensor<T, 2, M> D = albert::inv(A(i,k) * A(k,j)) - B(i,k) * B(k,j);
+  A(i,j) = albert::inv(A(i,j));
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      passed &= ALBERT_CHECK( near(D(m,n), T(0)) );
+      passed &= ALBERT_CHECK( near(A(m,n), B(m,n)) );
+    }
+  }
+
+  return passed;
+}
+
+template <class T, int M>
+constexpr static bool determinant()
+{
+  bool passed = true;
+
+  auto A = unimodular<T, M>();
+  passed &= ALBERT_CHECK( near(T(albert::det(A)), T(1)) );
+  passed &= ALBERT_CHECK( near(T(albert::det(A(j,i))), T(1)) );
+
+  // swapping a pair of rows flips the sign, scaling a row scales it
+  Tensor<T, 2, M> P = A;
+  for (int n = 0; n < M; ++n) {
+    T t = P(0,n);
+    P(0,n) = 3 * P(M - 1,n);
+    P(M - 1,n) = t;
+  }
+  passed &= ALBERT_CHECK( near(T(albert::det(P)), T(-3)) );
+
+  // the determinant is a scalar in the grammar
+  Tensor<T, 2, M> B = albert::det(P) * A(i,j) + albert::det(A) * A(i,j);
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      passed &= ALBERT_CHECK( near(B(m,n), T(-2) * A(m,n)) );
+    }
+  }
+
+  return passed;
+}
+
+template <class T, int M>
+constexpr static bool adjugate()
+{
+  bool passed = true;
+
+  Tensor<T, 2, M> A, adj;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      A(m,n) = (m == n) ? M + 1 : (m * M + n) % 5 - 2;
+    }
+  }
+
+  albert::solver::adjugate<M>(A, adj);
+  T det = albert::det(A);
+  Tensor<T, 2, M> B = A(i,k) * adj(k,j);
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      passed &= ALBERT_CHECK( near(B(m,n), (m == n) ? det : T(0)) );
+    }
+  }
+
+  return passed;
+}
+
+template <class T>
+constexpr static bool materialization(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 2, 3> A = unimodular<T, 3>();
+  Tensor<T, 1, 3> x = { 1, 2, 3 };
+
+  // inverses are computed once, and determinants are folded into literals
+  static_assert(albert::materializer<decltype(albert::inv(A(i,j)) * x(j))>::changes);
+  static_assert(albert::materializer<decltype(albert::det(A) * x(i))>::changes);
+  static_assert(albert::materializer<decltype(albert::inv(albert::det(A)))>::changes);
+
+  // ... unless they are lazy
+  Tensor<T, 1, 3> y = albert::inv(A(i,j)) * x(j);
+  Tensor<T, 1, 3> z = albert::lazy(albert::inv(A(i,j))) * x(j);
+  Tensor<T, 1, 3> w = A(i,j) * y(j);
+  for (int n = 0; n < 3; ++n) {
+    passed &= ALBERT_CHECK( near(y(n), z(n)) );
+    passed &= ALBERT_CHECK( near(w(n), x(n)) );
+  }
+
+  return passed;
+}
+
+template <class T>
+constexpr static bool tests(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= inverse<T, 1>();
+  passed &= inverse<T, 2>();
+  passed &= inverse<T, 3>();
+  passed &= inverse<T, 4>();
+  passed &= determinant<T, 2>();
+  passed &= determinant<T, 3>();
+  passed &= determinant<T, 4>();
+  passed &= adjugate<T, 2>();
+  passed &= adjugate<T, 3>();
+  passed &= adjugate<T, 4>();
+  passed &= materialization(type);
+  return passed;
+}
+
+/// Symmetric positive-definite systems, in dense and packed storage.
+template <class T, int M, class Layout>
+constexpr static bool symmetric()
+{
+  bool passed = true;
+
+  // A = B * B^T + M * I
+  Tensor<T, 2, M> B;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      B(m,n) = (m * 3 + n * 5) % 7 - 3;
+    }
+  }
+  Tensor<T, 2, M> I;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      I(m,n) = (m == n) ? M : 0;
+    }
+  }
+  Tensor<T, 2, M> A = B(i,k) * B(j,k) + I(i,j);
+
+  Tensor<T, 1, M> x, b;
+  for (int m = 0; m < M; ++m) {
+    x(m) = m + 1;
+  }
+  b(i) = A(i,j) * x(j);
+
+  Tensor<T, 2, M, Layout> C, D;
+  C(i,j) = A(i,j);
+  D(i,j) = A(i,j);
+  Tensor<T, 1, M> y = b, z = b;
+  passed &= ALBERT_CHECK( albert::solver::solve<M>(C, y, albert::solver::cholesky_tag) == 0 );
+  passed &= ALBERT_CHECK( albert::solver::solve<M>(D, z, albert::solver::ldlt_tag) == 0 );
+  for (int m = 0; m < M; ++m) {
+    passed &= ALBERT_CHECK( near(y(m), x(m)) );
+    passed &= ALBERT_CHECK( near(z(m), x(m)) );
+  }
+
+  // the factors reproduce the matrix
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n <= m; ++n) {
+      T llt = 0, ldlt = 0;
+      for (int p = 0; p <= n; ++p) {
+        llt += C(m,p) * C(n,p);
+        ldlt += ((m == p) ? 1 : D(m,p)) * D(p,p) * ((n == p) ? 1 : D(n,p));
+      }
+      passed &= ALBERT_CHECK( near(llt, A(m,n)) );
+      passed &= ALBERT_CHECK( near(ldlt, A(m,n)) );
+    }
+  }
+
+  return passed;
+}
+
+/// Matrices that aren't positive-definite are reported.
+template <class T>
+constexpr static bool indefinite(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 2, 3> A = { 2, 1, 0,
+                        1, -1, 0,
+                        0, 0, 1 };
+  Tensor<T, 2, 3> B = A;
+  Tensor<T, 1, 3> x = { 1, 2, 3 }, b;
+  b(i) = A(i,j) * x(j);
+
+  passed &= ALBERT_CHECK( albert::solver::cholesky<3>(A) == 2 );
+
+  // LDLT handles indefinite matrices
+  passed &= ALBERT_CHECK( albert::solver::solve<3>(B, b, albert::solver::ldlt_tag) == 0 );
+  for (int m = 0; m < 3; ++m) {
+    passed &= ALBERT_CHECK( near(b(m), x(m)) );
+  }
+
+  // ... but not zero pivots
+  Tensor<T, 2, 2> C = { 0, 1,
+                        1, 0 };
+  passed &= ALBERT_CHECK( albert::solver::ldlt<2>(C) == 1 );
+
+  return passed;
+}
+
+template <class T>
+constexpr static bool spd(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= symmetric<T, 3, albert::RowMajor<2, 3>>();
+  passed &= symmetric<T, 6, albert::RowMajor<2, 6>>();
+  passed &= symmetric<T, 3, albert::Symmetric<2, 3>>();
+  passed &= symmetric<T, 6, albert::Symmetric<2, 6>>();
+  passed &= indefinite(type);
+  return passed;
+}
+
+/// Larger matrices use the pivoted LU path.
+template <class T>
+static bool factored(type_args<T> = {})
+{
+  bool passed = true;
+  passed &= inverse<T, 5>();
+  passed &= inverse<T, 6>();
+  passed &= determinant<T, 5>();
+  passed &= determinant<T, 6>();
+  return passed;
+}
+
+/// A test system for lane `l`.
+///
+/// The matrices are diagonally dominant with their first two rows swapped in
+/// odd lanes, so those lanes need pivoting, and lane 5 has a repeated row.
+constexpr static void system(auto& A, auto& b, int l)
+{
+  for (int m = 0; m < 3; ++m) {
+    int r = (l % 2 and m < 2) ? 1 - m : m;
+    for (int n = 0; n < 3; ++n) {
+      A(r,n) = (m == n) ? 8 + l % 3 : (m + 2 * n + l) % 4 - 1;
+    }
+    b(m) = m + l;
+  }
+  if (l == 5) {
+    for (int n = 0; n < 3; ++n) {
+      A(2,n) = A(0,n);
+    }
+  }
+}
+
+/// Batches of systems factor and pivot each lane independently.
+template <class T>
+static bool batched(type_args<T> = {})
+{
+  bool passed = true;
+
+  constexpr int L = albert::simd_width_v<T>;
+
+  TensorBatch<T, 2, 3> A;
+  TensorBatch<T, 1, 3> b;
+  Tensor<T, 2, 3> a[L], lu[L];
+  Tensor<T, 1, 3> x[L];
+  int info[L];
+
+  for (int l = 0; l < L; ++l) {
+    system(a[l], x[l], l);
+    albert::set_lane(A, l, a[l]);
+    albert::set_lane(b, l, x[l]);
+    lu[l](i,j) = a[l](i,j);
+    info[l] = albert::solver::solve<3>(lu[l], x[l]);
+  }
+
+  auto e = albert::solver::batch_solve<3>(A, b);
+  for (int l = 0; l < L; ++l) {
+    passed &= ALBERT_CHECK( e[l] == info[l] );
+    passed &= ALBERT_CHECK( (e[l] != 0) == (l == 5) );
+    if (e[l] == 0) {
+      for (int m = 0; m < 3; ++m) {
+        passed &= ALBERT_CHECK( near(b(m)[l], x[l](m)) );
+      }
+    }
+  }
+
+  // interleaved storage with a remainder
+  constexpr int K = 2 * L + 3;
+  T As[9 * K], bs[3 * K];
+  int codes[K];
+  for (int s = 0; s < K; ++s) {
+    Tensor<T, 2, 3> c;
+    Tensor<T, 1, 3> y;
+    system(c, y, s);
+    for (int n = 0; n < 9; ++n) {
+      As[n * K + s] = c[n];
+    }
+    for (int n = 0; n < 3; ++n) {
+      bs[n * K + s] = y[n];
+    }
+  }
+
+  int singular = albert::solver::solve_interleaved<3>(As, bs, codes, K);
+  passed &= ALBERT_CHECK( singular == (K > 5) );
+  for (int s = 0; s < K; ++s) {
+    Tensor<T, 2, 3> c;
+    Tensor<T, 1, 3> y;
+    system(c, y, s);
+    passed &= ALBERT_CHECK( (codes[s] != 0) == (s == 5) );
+    if (codes[s] == 0) {
+      for (int m = 0; m < 3; ++m) {
+        T r = -y(m);
+        for (int n = 0; n < 3; ++n) {
+          r += c(m,n) * bs[n * K + s];
+        }
+        passed &= ALBERT_CHECK( near(r, T(0)) );
+      }
+    }
+  }
+
+  return passed;
+}
+
+/// A symmetric test matrix for case `l`.
+///
+/// The cases cycle through a generic spectrum, a repeated eigenvalue (a rank
+/// one update of a multiple of the identity), a multiple of the identity, and
+/// a diagonal matrix.
+constexpr static void symmetric(auto& A, int l)
+{
+  constexpr int u[3] = { 1, 2, 2 };
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      switch (l % 4) {
+       case 0: A(m,n) = (m * 3 + n + l) % 5 + (n * 3 + m + l) % 5 - 4; break;
+       case 1: A(m,n) = (m == n) * (l + 1) + u[m] * u[n] / 9.0; break;
+       case 2: A(m,n) = (m == n) * (l - 3); break;
+       case 3: A(m,n) = (m == n) * (m - l); break;
+      }
+    }
+  }
+}
+
+/// Check that `w` and `V` are an ascending, orthonormal eigen-decomposition of
+/// the symmetric `A`.
+template <class T, int M>
+static bool eigenpairs(auto const& A, auto const& w, auto const& V)
+{
+  bool passed = true;
+
+  T scale = 1;
+  for (int m = 0; m < M; ++m) {
+    scale = std::max(scale, std::abs(w(m)));
+  }
+  T tol = (std::is_same_v<T, float> ? T(1e-5) : T(1e-12)) * M * scale;
+
+  for (int m = 0; m + 1 < M; ++m) {
+    passed &= ALBERT_CHECK( w(m) <= w(m + 1) );
+  }
+
+  for (int a = 0; a < M; ++a) {
+    for (int m = 0; m < M; ++m) {
+      T r = -w(a) * V(m,a);
+      for (int n = 0; n < M; ++n) {
+        r += A(m,n) * V(n,a);
+      }
+      passed &= ALBERT_CHECK( std::abs(r) <= tol );
+    }
+    for (int b = 0; b < M; ++b) {
+      T d = -T(a == b);
+      for (int m = 0; m < M; ++m) {
+        d += V(m,a) * V(m,b);
+      }
+      passed &= ALBERT_CHECK( std::abs(d) <= tol / scale );
+    }
+  }
+
+  return passed;
+}
+
+/// The closed-form, Jacobi, and batched eigensolvers agree on generic and
+/// degenerate spectra.
+template <class T>
+static bool eigen(type_args<T> = {})
+{
+  bool passed = true;
+
+  for (int l = 0; l < 8; ++l) {
+    Tensor<T, 2, 3> A, V;
+    Tensor<T, 1, 3> w;
+    symmetric(A, l);
+    passed &= ALBERT_CHECK( albert::solver::eigh<3>(A, w, V) == 0 );
+    passed &= eigenpairs<T, 3>(A, w, V);
+    passed &= ALBERT_CHECK( albert::solver::jacobi_eigh<3>(A, w, V) == 0 );
+    passed &= eigenpairs<T, 3>(A, w, V);
+  }
+
+  // a multiple of the identity rotated in floating point, where roundoff
+  // leaves a spread too small for the closed form to resolve
+  for (int l = 0; l < 64; ++l) {
+    T Q[3][3];
+    for (int m = 0; m < 3; ++m) {
+      for (int n = 0; n < 3; ++n) {
+        Q[m][n] = std::sin(T(0.37) * (9 * l + 3 * m + n + 1) * (3 * m + n + 1));
+      }
+    }
+    for (int n = 0; n < 3; ++n) {
+      for (int k = 0; k < n; ++k) {
+        T d = 0;
+        for (int m = 0; m < 3; ++m) {
+          d += Q[m][n] * Q[m][k];
+        }
+        for (int m = 0; m < 3; ++m) {
+          Q[m][n] -= d * Q[m][k];
+        }
+      }
+      T d = 0;
+      for (int m = 0; m < 3; ++m) {
+        d += Q[m][n] * Q[m][n];
+      }
+      for (int m = 0; m < 3; ++m) {
+        Q[m][n] /= std::sqrt(d);
+      }
+    }
+
+    Tensor<T, 2, 3> A, V;
+    Tensor<T, 1, 3> w;
+    for (int m = 0; m < 3; ++m) {
+      for (int n = 0; n < 3; ++n) {
+        A(m,n) = 0;
+        for (int k = 0; k < 3; ++k) {
+          A(m,n) += Q[m][k] * T(2) * Q[n][k];
+        }
+      }
+    }
+    passed &= ALBERT_CHECK( albert::solver::eigh<3>(A, w, V) == 0 );
+    passed &= eigenpairs<T, 3>(A, w, V);
+  }
+
+  // a generic size goes through jacobi_eigh, and a repeated eigenvalue
+  {
+    Tensor<T, 2, 6> A, V;
+    Tensor<T, 1, 6> w;
+    for (int m = 0; m < 6; ++m) {
+      for (int n = 0; n < 6; ++n) {
+        A(m,n) = (m == n) * 2 + (m < 3 and n < 3) - (m + n) % 3 * (m > 2 and n > 2);
+      }
+    }
+    passed &= ALBERT_CHECK( albert::solver::eigh<6>(A, w, V) == 0 );
+    passed &= eigenpairs<T, 6>(A, w, V);
+  }
+
+  constexpr int L = albert::simd_width_v<T>;
+  TensorBatch<T, 2, 3> A, V;
+  TensorBatch<T, 1, 3> w;
+  Tensor<T, 2, 3> a[L];
+  for (int l = 0; l < L; ++l) {
+    symmetric(a[l], l);
+    albert::set_lane(A, l, a[l]);
+  }
+
+  auto e = albert::solver::batch_eigh<3>(A, w, V);
+  for (int l = 0; l < L; ++l) {
+    passed &= ALBERT_CHECK( e[l] == 0 );
+    passed &= eigenpairs<T, 3>(a[l],
+                               [&](int m) { return w(m)[l]; },
+                               [&](int m, int n) { return V(m,n)[l]; });
+  }
+
+  return passed;
+}
+
+/// The largest difference between two square matrices.
+template <int M>
+static auto distance(auto const& A, auto const& B)
+{
+  decltype(A(0,0) - B(0,0)) d = 0;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      d = std::max(d, std::abs(A(m,n) - B(m,n)));
+    }
+  }
+  return d;
+}
+
+/// Matrix functions round trip and agree with known closed forms.
+template <class T, int M>
+static bool functions(bool symmetric)
+{
+  bool passed = true;
+
+  T tol = std::is_same_v<T, float> ? T(1e-4) : T(1e-10);
+
+  // a small matrix so that logm(expm(A)) is the principal branch
+  Tensor<T, 2, M> A, E, L, S, R, U, X, I;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < M; ++n) {
+      A(m,n) = T((m * 3 + n * 5 + 1) % 7 - 3) / T(8);
+      I(m,n) = (m == n);
+    }
+  }
+  if (symmetric) {
+    X(i,j) = A(i,j) + A(j,i);
+    A(i,j) = X(i,j);
+  }
+
+  passed &= ALBERT_CHECK( albert::solver::expm<M>(A, E) == 0 );
+  passed &= ALBERT_CHECK( albert::solver::logm<M>(E, L) == 0 );
+  passed &= ALBERT_CHECK( distance<M>(L, A) <= tol );
+
+  // exp(A) exp(-A) = I
+  X(i,j) = -A(i,j);
+  albert::solver::expm<M>(X, S);
+  X(i,j) = E(i,k) * S(k,j);
+  passed &= ALBERT_CHECK( distance<M>(X, I) <= tol );
+
+  passed &= ALBERT_CHECK( albert::solver::sqrtm<M>(E, S) == 0 );
+  X(i,j) = S(i,k) * S(k,j);
+  passed &= ALBERT_CHECK( distance<M>(X, E) <= tol );
+
+  // polar decomposition of a deformation gradient, I + A
+  X(i,j) = I(i,j) + A(i,j);
+  passed &= ALBERT_CHECK( albert::solver::polar<M>(X, R, U) == 0 );
+  S(i,j) = R(i,k) * U(k,j);
+  passed &= ALBERT_CHECK( distance<M>(S, X) <= tol );
+  S(i,j) = R(k,i) * R(k,j);
+  passed &= ALBERT_CHECK( distance<M>(S, I) <= tol );
+  S(i,j) = U(j,i);
+  passed &= ALBERT_CHECK( distance<M>(S, U) <= tol );
+
+  return passed;
+}
+
+/// Matrix functions in expressions are computed once per assignment.
+template <class T>
+static bool grammar(type_args<T> = {})
+{
+  bool passed = true;
+
+  T tol = std::is_same_v<T, float> ? T(1e-5) : T(1e-12);
+
+  // a rotation generator exponentiates to a rotation
+  T theta = T(0.5);
+  Tensor<T, 2, 2> W = { T(0), -theta, theta, T(0) };
+  Tensor<T, 2, 2> Q = albert::expm(W);
+  passed &= ALBERT_CHECK( std::abs(Q(0,0) - std::cos(theta)) <= tol );
+  passed &= ALBERT_CHECK( std::abs(Q(1,0) - std::sin(theta)) <= tol );
+
+  Tensor<T, 2, 3> F = { 2, 1, 0, 0, 1, 0, 0, 0, 3 };
+  static_assert(albert::materializer<decltype(albert::expm(F(i,j)) * F(j,k))>::changes);
+
+  auto [R, U, info] = albert::polar(F);
+  passed &= ALBERT_CHECK( info == 0 );
+  Tensor<T, 2, 3> X = R(i,j) * U(j,k);
+  Tensor<T, 2, 3> C = albert::sqrtm(F(k,i) * F(k,j));
+  Tensor<T, 2, 3> D = albert::logm(albert::expm(F));
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( std::abs(X(m,n) - F(m,n)) <= tol * 10 );
+      passed &= ALBERT_CHECK( std::abs(C(m,n) - U(m,n)) <= tol * 10 );
+      passed &= ALBERT_CHECK( std::abs(D(m,n) - F(m,n)) <= tol * 100 );
+    }
+  }
+
+  // the decomposition of a singular matrix reports its failure
+  Tensor<T, 2, 3> Z = { 1, 2, 3, 2, 4, 6, 0, 0, 1 };
+  passed &= ALBERT_CHECK( albert::polar(Z).info != 0 );
+
+  return passed;
+}
+
+template <class T>
+static bool functions(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= functions<T, 2>(false);
+  passed &= functions<T, 2>(true);
+  passed &= functions<T, 3>(false);
+  passed &= functions<T, 3>(true);
+  passed &= functions<T, 4>(false);
+  passed &= grammar(type);
+  return passed;
+}
+
+int main()
+{
+  constexpr bool i = tests(args<int>);
+  constexpr bool s = spd(args<double>);
+  bool f = tests(args<float>) and factored(args<float>) and batched(args<float>) and spd(args<float>) and eigen(args<float>) and functions(args<float>);
+  bool d = tests(args<double>) and factored(args<double>) and batched(args<double>) and eigen(args<double>) and functions(args<double>);
+}
@@ -0,0 +1,168 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using albert::Tensor;
+using albert::ThreadPool;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+static bool flops()
+{
+  bool passed = true;
+
+  Tensor<double, 2, 3> A, B;
+  Tensor<double, 4, 3> D;
+  Tensor<double, 1, 3> v;
+
+  static_assert(albert::flops_v<decltype(A(i,j))> == 0);
+  static_assert(albert::flops_v<decltype(A(i,j) + B(j,i))> == 9);
+  static_assert(albert::flops_v<decltype(A(i,i))> == 3);
+  static_assert(albert::flops_v<decltype(A(i,j) * v(j))> == 18);
+  static_assert(albert::flops_v<decltype(D(i,j,k,l) * A(k,l))> == 162);
+  static_assert(albert::flops_v<decltype(-(A(i,j) * B(j,k)) / 2)> == 54 + 9 + 9);
+
+  passed &= ALBERT_CHECK( albert::flops(A(i,j) * B(j,k) + A(i,k)) == 63 );
+  return passed;
+}
+
+static bool parallel_for()
+{
+  bool passed = true;
+
+  for (int n : { 1, 2, 3, 8, 64 }) {
+    ThreadPool pool(n);
+    passed &= ALBERT_CHECK( pool.size() == n );
+
+    // every element is visited exactly once, whatever the grain
+    for (long grain : { 1l, 7l, 1000l, 100000l }) {
+      std::vector<std::atomic<int>> visits(10'001);
+      std::atomic<long> largest = 0;
+      pool.parallel_for(visits.size(), grain, [&](long begin, long end) {
+        for (long e = largest; e < end - begin;) {
+          largest.compare_exchange_weak(e, end - begin);
+        }
+        for (long i = begin; i < end; ++i) {
+          visits[i] += 1;
+        }
+      });
+      passed &= ALBERT_CHECK( largest <= grain );
+      for (auto& v : visits) {
+        passed &= ALBERT_CHECK( v == 1 );
+      }
+    }
+
+    // loops started from several threads at once don't interfere
+    {
+      std::vector<std::atomic<int>> visits(4 * 1000);
+      std::vector<std::thread> callers;
+      for (int c = 0; c < 4; ++c) {
+        callers.emplace_back([&, c] {
+          for (int r = 0; r < 25; ++r) {
+            pool.parallel_for(1000, 3, [&](long begin, long end) {
+              for (long i = begin; i < end; ++i) {
+                visits[c * 1000 + i] += 1;
+              }
+            });
+          }
+        });
+      }
+      for (auto& caller : callers) {
+        caller.join();
+      }
+      for (auto& v : visits) {
+        passed &= ALBERT_CHECK( v == 25 );
+      }
+    }
+
+    // loops started from inside a loop body run serially
+    {
+      std::vector<std::atomic<int>> visits(100 * 100);
+      pool.parallel_for(100, 1, [&](long outer, long) {
+        pool.parallel_for(100, 7, [&](long begin, long end) {
+          for (long i = begin; i < end; ++i) {
+            visits[outer * 100 + i] += 1;
+          }
+        });
+      });
+      for (auto& v : visits) {
+        passed &= ALBERT_CHECK( v == 1 );
+      }
+    }
+
+    // exceptions are rethrown on the calling thread
+    bool caught = false;
+    try {
+      pool.parallel_for(1000, 1, [](long begin, long) {
+        if (begin == 500) {
+          throw std::runtime_error("expected");
+        }
+      });
+    }
+    catch (std::runtime_error const&) {
+      caught = true;
+    }
+    passed &= ALBERT_CHECK( caught );
+  }
+
+  return passed;
+}
+
+static bool for_each_batch()
+{
+  bool passed = true;
+
+  struct Point
+  {
+    Tensor<double, 2, 3> epsilon;
+    Tensor<double, 2, 3> sigma;
+  };
+
+  Tensor<double, 4, 3> D;
+  for (int n = 0; n < D.size(); ++n) {
+    D[n] = n % 7;
+  }
+
+  std::vector<Point> points(5000);
+  for (int p = 0; p < int(points.size()); ++p) {
+    for (int n = 0; n < 9; ++n) {
+      points[p].epsilon[n] = p + n;
+    }
+  }
+
+  ThreadPool pool(4);
+  albert::for_each_batch(pool, points, [&](Point& p) {
+    p.sigma(i,j) = D(i,j,k,l) * p.epsilon(k,l);
+  }, albert::flops(D(i,j,k,l) * points[0].epsilon(k,l)));
+
+  for (auto& p : points) {
+    Tensor<double, 2, 3> sigma = D(i,j,k,l) * p.epsilon(k,l);
+    for (int n = 0; n < 9; ++n) {
+      passed &= ALBERT_CHECK( p.sigma[n] == sigma[n] );
+    }
+  }
+
+  // the default pool
+  std::vector<Tensor<double, 1, 3>> vs(1000);
+  albert::for_each_batch(vs, [&](auto& v) {
+    v(i) = D(i,0,0,0) + D(0,i,0,0);
+  });
+  for (auto& v : vs) {
+    passed &= ALBERT_CHECK( v(1) == D(1,0,0,0) + D(0,1,0,0) );
+  }
+
+  return passed;
+}
+
+int main()
+{
+  bool f = flops();
+  bool p = parallel_for();
+  bool b = for_each_batch();
+}
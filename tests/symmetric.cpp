@@ -0,0 +1,197 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+
+using albert::Tensor;
+using albert::MinorSymmetric;
+using albert::Symmetric;
+using albert::tests::type_args;
+using albert::tests::args;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+constexpr static albert::Index<'l'> l;
+
+template <class T>
+constexpr static bool layouts(type_args<T> = {})
+{
+  bool passed = true;
+
+  static_assert(Symmetric<2, 3>::size == 6);
+  static_assert(Symmetric<4, 3>::size == 21);
+  static_assert(MinorSymmetric<3>::size == 36);
+  static_assert(Symmetric<2, 2>::size == 3);
+
+  // Voigt order: 00 11 22 12 02 01
+  constexpr Symmetric<2, 3> voigt;
+  static_assert(voigt({0, 0}) == 0 and voigt({1, 1}) == 1 and voigt({2, 2}) == 2);
+  static_assert(voigt({1, 2}) == 3 and voigt({2, 1}) == 3);
+  static_assert(voigt({0, 2}) == 4 and voigt({0, 1}) == 5);
+
+  constexpr Symmetric<4, 3> major;
+  static_assert(major({0, 1, 2, 2}) == major({1, 0, 2, 2}));
+  static_assert(major({0, 1, 2, 2}) == major({2, 2, 0, 1}));
+  static_assert(major({0, 1, 2, 2}) != major({0, 2, 1, 2}));
+
+  constexpr MinorSymmetric<3> minor;
+  static_assert(minor({0, 1, 2, 2}) == minor({1, 0, 2, 2}));
+  static_assert(minor({0, 1, 2, 2}) != minor({2, 2, 0, 1}));
+
+  // every unique index maps back to its own offset
+  for (int n = 0; n < major.size; ++n) {
+    passed &= ALBERT_CHECK( major(major.unique[n]) == n );
+  }
+  for (int n = 0; n < minor.size; ++n) {
+    passed &= ALBERT_CHECK( minor(minor.unique[n]) == n );
+  }
+
+  return passed;
+}
+
+template <class T>
+constexpr static bool order2(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 2, 3, Symmetric<2, 3>> S = { 1, 6, 5,
+                                         6, 2, 4,
+                                         5, 4, 3 };
+  passed &= ALBERT_CHECK( S.span() == 6 );
+  for (int n = 0; n < 6; ++n) {
+    passed &= ALBERT_CHECK( S[n] == n + 1 );
+  }
+  passed &= ALBERT_CHECK( S(0,1) == 6 and S(1,0) == 6 );
+
+  // the symmetric part of a full tensor
+  Tensor<T, 2, 3> A = { 1, 2, 3,
+                        4, 5, 6,
+                        7, 8, 9 };
+  Tensor<T, 2, 3, Symmetric<2, 3>> B = A(i,j) + A(j,i);
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( B(m,n) == A(m,n) + A(n,m) );
+    }
+  }
+
+  // elementwise operations between packed tensors, and with full tensors
+  Tensor<T, 2, 3, Symmetric<2, 3>> C = S(i,j) - 2 * B(j,i);
+  Tensor<T, 2, 3> D = C(i,j) + A(i,j);
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( C(m,n) == S(m,n) - 2 * B(m,n) );
+      passed &= ALBERT_CHECK( D(m,n) == C(m,n) + A(m,n) );
+    }
+  }
+
+  // contractions over symmetric pairs
+  static_assert(albert::is_symmetric_in<decltype(S(i,j))>('i', 'j'));
+  static_assert(albert::is_symmetric_in<decltype(S(i,j) + B(j,i))>('j', 'i'));
+  static_assert(not albert::is_symmetric_in<decltype(S(i,j) + A(i,j))>('i', 'j'));
+
+  T s = S(i,j) * B(i,j);
+  T a = S(i,j) * A(i,j);
+  T sum_s = 0, sum_a = 0;
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      sum_s += S(m,n) * B(m,n);
+      sum_a += S(m,n) * A(m,n);
+    }
+  }
+  passed &= ALBERT_CHECK( s == sum_s );
+  passed &= ALBERT_CHECK( a == sum_a );
+
+  return passed;
+}
+
+/// An isotropic stiffness, `C_ijkl = λ δ_ij δ_kl + μ (δ_ik δ_jl + δ_il δ_jk)`
+/// plus a term with only the minor symmetries.
+template <class T>
+constexpr static T stiffness(int i, int j, int k, int l, bool major)
+{
+  auto d = [](int a, int b) { return T(a == b); };
+  T c = 3 * d(i,j) * d(k,l) + 2 * (d(i,k) * d(j,l) + d(i,l) * d(j,k));
+  if (not major) {
+    c += (i + j) * (k + l + 1) + i * j;
+  }
+  return c;
+}
+
+template <class T, class Layout>
+constexpr static bool order4(bool major)
+{
+  bool passed = true;
+
+  Tensor<T, 4, 3> D;
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      for (int c = 0; c < 3; ++c) {
+        for (int d = 0; d < 3; ++d) {
+          D(a,b,c,d) = stiffness<T>(a, b, c, d, major);
+        }
+      }
+    }
+  }
+
+  Tensor<T, 4, 3, Layout> C = D(i,j,k,l);
+  passed &= ALBERT_CHECK( C.span() == Layout::size );
+
+  Tensor<T, 2, 3, Symmetric<2, 3>> e = { 1, 6, 5,
+                                         6, 2, 4,
+                                         5, 4, 3 };
+
+  // the minor symmetric pair `kl` is contracted once per unique pair
+  Tensor<T, 2, 3, Symmetric<2, 3>> s = C(i,j,k,l) * e(k,l);
+  Tensor<T, 2, 3> t = D(i,j,k,l) * e(k,l);
+  for (int m = 0; m < 3; ++m) {
+    for (int n = 0; n < 3; ++n) {
+      passed &= ALBERT_CHECK( s(m,n) == t(m,n) );
+    }
+  }
+
+  // the quadruple contraction has two symmetric pairs
+  T c = C(i,j,k,l) * C(i,j,k,l);
+  T d = D(i,j,k,l) * D(i,j,k,l);
+  passed &= ALBERT_CHECK( c == d );
+
+  return passed;
+}
+
+/// Elementwise operations over matching packed storage are streamed.
+template <class T>
+static bool vectorization(type_args<T> = {})
+{
+  bool passed = true;
+
+  Tensor<T, 4, 3, Symmetric<4, 3>> A, B;
+  for (int n = 0; n < A.span(); ++n) {
+    A[n] = T(n);
+    B[n] = T(2 * n);
+  }
+
+  static_assert(albert::simd_bytes == 0 or albert::is_vectorizable<decltype(A(i,j,k,l) + B(i,j,k,l))>);
+
+  Tensor<T, 4, 3, Symmetric<4, 3>> C = A(i,j,k,l) + T(2) * B(i,j,k,l);
+  for (int n = 0; n < C.span(); ++n) {
+    passed &= ALBERT_CHECK( C[n] == T(5 * n) );
+  }
+
+  return passed;
+}
+
+template <class T>
+constexpr static bool tests(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= layouts(type);
+  passed &= order2(type);
+  passed &= order4<T, Symmetric<4, 3>>(true);
+  passed &= order4<T, MinorSymmetric<3>>(false);
+  return passed;
+}
+
+int main()
+{
+  constexpr bool i = tests(args<int>);
+  bool f = tests(args<float>) and vectorization(args<float>);
+  bool d = tests(args<double>) and vectorization(args<double>);
+}
@@ -0,0 +1,158 @@
+#include "albert/albert.hpp"
+#include "common.hpp"
+
+using albert::Tensor;
+using albert::TensorView;
+using albert::tests::type_args;
+using albert::tests::args;
+
+constexpr static albert::Index<'i'> i;
+constexpr static albert::Index<'j'> j;
+constexpr static albert::Index<'k'> k;
+
+template <class T>
+static bool external(type_args<T> = {})
+{
+  bool passed = true;
+
+  // row-major views of raw arrays
+  T a[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  T b[9] = { 9, 8, 7, 6, 5, 4, 3, 2, 1 };
+  T c[9] = {};
+
+  TensorView<T, 2, 3> A(a), B(b), C(c);
+  C(i,j) = A(i,j) + B(j,i);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      passed &= ALBERT_CHECK( c[3 * i + j] == a[3 * i + j] + b[3 * j + i] );
+    }
+  }
+
+  // strided views, e.g., one component of an array of structures
+  T xyz[12] = { 1, 10, 100, 0, 2, 20, 200, 0, 3, 30, 300, 0 };
+  TensorView<T, 1, 3> x(xyz, { 4 }), y(xyz + 1, { 4 });
+  passed &= ALBERT_CHECK( x.span() == 9 );
+
+  T dot = x(i) * y(i);
+  passed &= ALBERT_CHECK( dot == 1 * 10 + 2 * 20 + 3 * 30 );
+
+  y(i) = A(i,j) * x(j);
+  passed &= ALBERT_CHECK( xyz[1] == 14 && xyz[5] == 32 && xyz[9] == 50 );
+  passed &= ALBERT_CHECK( xyz[0] == 1 && xyz[2] == 100 && xyz[3] == 0 );
+
+  // column-major data with explicit strides
+  T f[9] = { 1, 4, 7, 2, 5, 8, 3, 6, 9 };
+  TensorView<T const, 2, 3> F(f, { 1, 3 });
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      passed &= ALBERT_CHECK( F(i,j) == A(i,j) );
+    }
+  }
+
+  // views of tensors
+  Tensor<T, 2, 3> D = A(i,j);
+  TensorView E(D);
+  E(i,j) = 2 * D(i,j);
+  passed &= ALBERT_CHECK( D(1,2) == 12 );
+
+  TensorView G = std::as_const(D);
+  static_assert(std::is_same_v<decltype(G), TensorView<T const, 2, 3>>);
+  passed &= ALBERT_CHECK( G(2,2) == 18 );
+
+  // assignment to an unbound view
+  TensorView<T, 1, 3> z(c);
+  z = x(i) + x(i);
+  passed &= ALBERT_CHECK( c[0] == 2 && c[1] == 4 && c[2] == 6 );
+
+  return passed;
+}
+
+template <class T>
+static bool aliasing(type_args<T> = {})
+{
+  bool passed = true;
+
+  T a[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  T b[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+  // views alias statically with everything, but only by address at runtime
+  TensorView<T, 2, 3> A(a), B(b);
+  static_assert(decltype(A(i,j))::contains(B.tag()));
+  passed &= ALBERT_CHECK( albert::overlaps(A(i,j), A(j,i)) );
+  passed &= ALBERT_CHECK( not albert::overlaps(A(i,j), B(j,i)) );
+
+  // in-place transpose goes through a temporary
+  A(i,j) = A(j,i);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      passed &= ALBERT_CHECK( a[3 * i + j] == b[3 * j + i] );
+    }
+  }
+
+  // in-place contraction through two views of the same memory
+  TensorView<T, 2, 3> C(a);
+  T expected[9] = {};
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      for (int k = 0; k < 3; ++k) {
+        expected[3 * i + j] += a[3 * i + k] * b[3 * k + j];
+      }
+    }
+  }
+  C(i,j) = A(i,k) * B(k,j);
+  for (int n = 0; n < 9; ++n) {
+    passed &= ALBERT_CHECK( a[n] == expected[n] );
+  }
+
+  // views of a tensor alias the tensor
+  Tensor<T, 2, 3> D = B(i,j);
+  TensorView E(D);
+  E(i,j) = D(j,i);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      passed &= ALBERT_CHECK( D(i,j) == b[3 * j + i] );
+    }
+  }
+
+  D(i,j) = E(j,i);
+  for (int n = 0; n < 9; ++n) {
+    passed &= ALBERT_CHECK( D[n] == b[n] );
+  }
+
+  // overlapping windows into one array
+  T v[4] = { 1, 2, 3, 4 };
+  TensorView<T, 1, 3> lo(v), hi(v + 1);
+  hi(i) = lo(i) + lo(i);
+  passed &= ALBERT_CHECK( v[0] == 1 && v[1] == 2 && v[2] == 4 && v[3] == 6 );
+  lo(i) = hi(i) + hi(i);
+  passed &= ALBERT_CHECK( v[0] == 4 && v[1] == 8 && v[2] == 12 && v[3] == 6 );
+
+  // ... while the same storage is updated in place
+  passed &= ALBERT_CHECK( albert::overlaps_shifted(lo(i), hi(i)) );
+  passed &= ALBERT_CHECK( not albert::overlaps_shifted(lo(i), lo(i) + lo(i)) );
+
+  // reads of the same storage are classified by the elements they read
+  using albert::Access;
+  passed &= ALBERT_CHECK( albert::access(lo(i), lo(i) + lo(i)) == Access::pointwise );
+  passed &= ALBERT_CHECK( albert::access(hi(i), lo(i) + lo(i)) == Access::shifted );
+  passed &= ALBERT_CHECK( albert::access(C(i,j), A(i,k) * B(k,j)) == Access::row );
+  passed &= ALBERT_CHECK( albert::access(C(i,j), B(i,k) * A(k,j)) == Access::shifted );
+  passed &= ALBERT_CHECK( albert::access(C(i,j), B(i,k) * B(k,j)) == Access::pointwise );
+
+  return passed;
+}
+
+template <class T>
+static bool tests(type_args<T> type = {})
+{
+  bool passed = true;
+  passed &= external(type);
+  passed &= aliasing(type);
+  return passed;
+}
+
+int main()
+{
+  bool i = tests(args<int>);
+  bool d = tests(args<double>);
+}